@@ -0,0 +1,271 @@
+//+--------------------------------------------------------------------------
+//
+// File:        assetfiles.h
+//
+// NightDriverStrip - (c) 2018 Plummer's Software LLC.  All Rights Reserved.
+//
+// This file is part of the NightDriver software project.
+//
+//    NightDriver is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    NightDriver is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with Nightdriver.  It is normally found in copying.txt
+//    If not, see <https://www.gnu.org/licenses/>.
+//
+//
+// Description:
+//
+//    Assets (GIFs and other sprites) that are uploaded through the web
+//    server live in their own directory on SPIFFS. This file has the
+//    helpers for naming them, and a reader that pulls a file in through
+//    a small read-ahead buffer so it can be streamed rather than loaded.
+//
+//
+// History:     Oct-19-2026                     Created for NightDriverStrip
+//
+//---------------------------------------------------------------------------
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <vector>
+#include <FS.h>
+#include <SPIFFS.h>
+#include "globals.h"
+
+#define ASSET_DIRECTORY         "/assets"
+#define ASSET_INDEX_SUFFIX      ".idx"          // Sidecar with what we learned about an asset when it was uploaded
+#define ASSET_UPLOAD_SUFFIX     ".tmp"          // An asset that's still on its way in
+
+// SPIFFS names are at most 31 characters including the directory, and we need room for a suffix
+
+#define MAX_ASSET_NAME_LENGTH   (31 - (sizeof(ASSET_DIRECTORY "/") - 1) - (sizeof(ASSET_INDEX_SUFFIX) - 1))
+
+namespace Assets
+{
+    // Names are plain file names; we don't let them wander outside the asset directory or clash with our suffixes
+    inline bool IsValidName(const String & name)
+    {
+        if (name.isEmpty() || name.length() > MAX_ASSET_NAME_LENGTH || name[0] == '.')
+            return false;
+
+        if (name.endsWith(ASSET_INDEX_SUFFIX) || name.endsWith(ASSET_UPLOAD_SUFFIX))
+            return false;
+
+        for (auto c : name)
+            if (!isalnum(c) && c != '.' && c != '_' && c != '-')
+                return false;
+
+        return true;
+    }
+
+    inline String Path(const String & name)
+    {
+        return ASSET_DIRECTORY "/" + name;
+    }
+
+    // Depending on the version of the core, File::name() has the directory in front or not
+    inline String NameFromPath(const String & path)
+    {
+        return path.substring(path.lastIndexOf('/') + 1);
+    }
+
+    inline String IndexPath(const String & name)
+    {
+        return Path(name) + ASSET_INDEX_SUFFIX;
+    }
+
+    inline String UploadPath(const String & name)
+    {
+        return Path(name) + ASSET_UPLOAD_SUFFIX;
+    }
+
+    inline bool IsGIF(const String & name)
+    {
+        String lowerName = name;
+        lowerName.toLowerCase();
+        return lowerName.endsWith(".gif");
+    }
+
+    // Held while an uploaded asset is being read for display, and while one is replaced or removed, so a file
+    // doesn't go away in the middle of a read
+    inline std::mutex & FileMutex()
+    {
+        static std::mutex fileMutex;
+        return fileMutex;
+    }
+
+    // Removes uploads that never completed, which are left behind if we restart while one is on its way in
+    inline void RemoveAbandonedUploads()
+    {
+        std::vector<String> uploads;
+
+        File directory = SPIFFS.open(ASSET_DIRECTORY);
+        for (File file = directory.openNextFile(); file; file = directory.openNextFile())
+        {
+            String name = NameFromPath(file.name());
+            file.close();
+
+            if (name.endsWith(ASSET_UPLOAD_SUFFIX))
+                uploads.push_back(Path(name));
+        }
+
+        for (auto& path : uploads)
+        {
+            debugW("Removing incomplete upload %s", path.c_str());
+            SPIFFS.remove(path);
+        }
+    }
+}
+
+// BufferedFileReader
+//
+// Reads a file through a buffer of FILE_READ_AHEAD_BYTES, so byte-at-a-time readers like the GIF decoder
+// don't turn into a flash access per byte. Seeks only move our position; the buffer is refilled when a
+// read falls outside it, so skipping around within the buffered window costs nothing.
+
+class BufferedFileReader
+{
+    File   _file;
+    std::vector<uint8_t> _buffer;
+    size_t _bufferStart  = 0;                   // File offset of the first byte in the buffer
+    size_t _bufferLength = 0;
+    size_t _position     = 0;
+    size_t _size         = 0;
+
+    bool IsBuffered(size_t position) const
+    {
+        return position >= _bufferStart && position < _bufferStart + _bufferLength;
+    }
+
+    bool Fill()
+    {
+        if (IsBuffered(_position))
+            return true;
+
+        if (_position >= _size || !_file.seek(_position))
+            return false;
+
+        _bufferStart = _position;
+        _bufferLength = _file.read(_buffer.data(), _buffer.size());
+        return _bufferLength > 0;
+    }
+
+  public:
+
+    ~BufferedFileReader()
+    {
+        Close();
+    }
+
+    bool Open(const String & path)
+    {
+        Close();
+
+        _file = SPIFFS.open(path, FILE_READ);
+        if (!_file || _file.isDirectory())
+        {
+            debugW("Unable to open %s for reading", path.c_str());
+            _file.close();
+            return false;
+        }
+
+        // Allocated here rather than up front, so readers that never open a file don't cost anything
+        _buffer.resize(FILE_READ_AHEAD_BYTES);
+        _size = _file.size();
+        return true;
+    }
+
+    void Close()
+    {
+        if (_file)
+            _file.close();
+
+        _bufferStart = _bufferLength = _position = _size = 0;
+    }
+
+    bool IsOpen() const
+    {
+        return _size > 0;
+    }
+
+    size_t Size() const
+    {
+        return _size;
+    }
+
+    size_t Position() const
+    {
+        return _position;
+    }
+
+    bool Seek(size_t position)
+    {
+        if (position > _size)
+            return false;
+
+        _position = position;
+        return true;
+    }
+
+    bool Skip(size_t count)
+    {
+        return Seek(_position + count);
+    }
+
+    // Returns the next byte, or -1 at the end of the file
+    int Read()
+    {
+        if (!Fill())
+            return -1;
+
+        return _buffer[_position++ - _bufferStart];
+    }
+
+    // Reads up to count bytes and returns how many we got
+    size_t Read(void * destination, size_t count)
+    {
+        auto bytes = static_cast<uint8_t *>(destination);
+        size_t total = 0;
+
+        while (count > 0 && _position < _size)
+        {
+            // Big reads that start past the buffer go straight to the file rather than through the buffer
+            if (!IsBuffered(_position) && count >= _buffer.size())
+            {
+                if (!_file.seek(_position))
+                    break;
+
+                size_t read = _file.read(bytes, std::min(count, _size - _position));
+                if (read == 0)
+                    break;
+
+                _position += read;
+                total += read;
+                break;
+            }
+
+            if (!Fill())
+                break;
+
+            size_t available = std::min(count, _bufferStart + _bufferLength - _position);
+            memcpy(bytes, &_buffer[_position - _bufferStart], available);
+            _position += available;
+            bytes += available;
+            total += available;
+            count -= available;
+        }
+
+        return total;
+    }
+};
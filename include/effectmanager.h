@@ -54,6 +54,42 @@ void InitEffectsManager();
 void SaveEffectManagerConfig();
 void RemoveEffectManagerConfig();
 
+// LayerBlendMode
+//
+// The ways in which an effect layer can be combined with the frame underneath it. The numeric values
+// are persisted in the effects JSON, so existing values should not be changed.
+
+enum class LayerBlendMode : int
+{
+    Add     = 0,                // Saturating add of the layer onto the frame
+    Alpha   = 1,                // Layer replaces the frame at the layer's opacity; black layer pixels are transparent
+    Screen  = 2,                // Inverse multiply, brightens without clipping as hard as Add does
+    Max     = 3                 // Per-channel maximum of the frame and the layer
+};
+
+// EffectLayer
+//
+// An effect that is drawn on top of the current effect, into its own buffer(s), and then blended onto
+// the frame. Layers are not part of the effect rotation; they're configured in the "lyr" array in the
+// effects JSON and are drawn over whatever effect is current.
+
+struct EffectLayer
+{
+    std::shared_ptr<LEDStripEffect> Effect;
+    LayerBlendMode BlendMode = LayerBlendMode::Alpha;
+    uint8_t Opacity = 255;
+
+    std::vector<psram_unique_ptr<CRGB[]>> Buffers;              // One layer buffer per channel
+    bool Started = false;
+    unsigned long LastDrawTime = 0;
+
+    EffectLayer(std::shared_ptr<LEDStripEffect> effect, LayerBlendMode blendMode, uint8_t opacity)
+      : Effect(effect),
+        BlendMode(blendMode),
+        Opacity(opacity)
+    {}
+};
+
 // EffectManager
 //
 // Handles keeping track of the effects, which one is active, asking it to draw, etc.
@@ -70,9 +106,16 @@ class  EffectManager : public IJSONSerializable
     bool _clearTempEffectWhenExpired = false;
     bool _newFrameAvailable = false;
     int _effectSetVersion = 1;
+    size_t _warmEffectCount = WARM_EFFECT_COUNT;
 
     std::vector<std::shared_ptr<GFXBase>> _gfx;
     std::shared_ptr<LEDStripEffect> _tempEffect;
+    std::shared_ptr<LEDStripEffect> _startedEffect;
+    std::shared_ptr<LEDStripEffect> _effectToPrepare;              // Handed to the effect preparation task with atomic loads/stores
+    std::shared_ptr<LEDStripEffect> _queuedEffect;                 // Last effect we queued for preparation, until it starts or is skipped
+    std::vector<EffectLayer> _vLayers;
+    std::vector<CRGB, psram_allocator<CRGB>> _coverageScratch;     // Previous frame, kept while an effect's coverage is sampled
+    std::vector<CRGB, psram_allocator<CRGB>> _coverageSample;      // What the effect drew over the inverted previous frame
 
     void construct(bool clearTempEffect)
     {
@@ -98,6 +141,11 @@ class  EffectManager : public IJSONSerializable
         {
             // Effects in the default list are core effects. These can be disabled but not deleted.
             pEffect->MarkAsCoreEffect();
+
+            #if USE_LAZY_EFFECTS
+                pEffect = LoadOnDemand(pEffect);
+            #endif
+
             _vEffects.push_back(pEffect);
         }
     }
@@ -108,9 +156,20 @@ class  EffectManager : public IJSONSerializable
     void SaveCurrentEffectIndex();
     bool ReadCurrentEffectIndex(size_t& index);
 
+    // Implementation is in effectmanager.cpp
+    void LoadJSONLayers(const JsonArrayConst& layersArray);
+    void DrawEffect(LEDStripEffect& effect);
+    void DrawLayers();
+    void BlendLayers();
+    void PrepareNextEffectIfDue();
+    void AbandonQueuedEffect(const std::shared_ptr<LEDStripEffect>& effectToKeep);
+    std::shared_ptr<LEDStripEffect> LoadOnDemand(const std::shared_ptr<LEDStripEffect>& effect);
+    void ReleaseUnusedEffects();
+
     void ClearEffects()
     {
         _vEffects.clear();
+        _vLayers.clear();
     }
 
 public:
@@ -185,12 +244,16 @@ public:
     // If the index exceeds the "eef" array's size, the effect is enabled by default.
     //
     // The function also sets the effect interval from the "ivl" field in the JSON object, defaulting
-    // to a pre-defined value if the field isn't present.
+    // to a pre-defined value if the field isn't present. Likewise, "wec" sets how many recently used
+    // effects are kept loaded when effects are loaded on demand.
     //
     // If the JSON object includes a "cei" field, the function sets the current effect index to this
     // value. If the value is greater than or equal to the number of effects, it defaults to the last
     // effect in the vector.
     //
+    // If the JSON object includes a "lyr" array, the effect layers it describes are created, to be
+    // drawn over the current effect on every frame.
+    //
     // Lastly, the function calls the construct() method, indicating successful deserialization.
 
     bool DeserializeFromJSON(const JsonObjectConst& jsonObject) override
@@ -213,6 +276,11 @@ public:
 
         LoadJSONAndMissingEffects(effectsArray);
 
+        // "lyr" is the optional array of effect layers that are drawn on top of the current effect
+        JsonArrayConst layersArray = jsonObject["lyr"].as<JsonArrayConst>();
+        if (!layersArray.isNull())
+            LoadJSONLayers(layersArray);
+
         // "eef" was the array of effect enabled flags. They have now been integrated in the effects themselves;
         //   this code is there to "migrate" users who already had a serialized effect config on their device
         if (jsonObject.containsKey("eef"))
@@ -233,6 +301,9 @@ public:
         // "ivl" contains the effect interval in ms
         SetInterval(jsonObject.containsKey("ivl") ? jsonObject["ivl"] : DEFAULT_EFFECT_INTERVAL, true);
 
+        // "wec" is the number of recently used effects that are kept loaded
+        _warmEffectCount = jsonObject.containsKey("wec") ? jsonObject["wec"] : WARM_EFFECT_COUNT;
+
         // Try to read the effectindex from its own file. If that fails, "cei" may contain the current effect index instead
         if (!ReadCurrentEffectIndex(_iCurrentEffect) && jsonObject.containsKey("cei"))
             _iCurrentEffect = jsonObject["cei"];
@@ -264,6 +335,9 @@ public:
     // and attempts to serialize the effect into this object. If serialization of any effect fails, the function
     // immediately returns false.
     //
+    // If any effect layers are configured, they are serialized to a "lyr" array in the same way, together
+    // with their blend mode and opacity.
+    //
     // If all effects are successfully serialized, the function returns true, indicating successful serialization.
 
     bool SerializeToJSON(JsonObject& jsonObject) override
@@ -273,6 +347,7 @@ public:
         jsonObject["ivl"] = _effectInterval;
         jsonObject[PTY_PROJECT] = PROJECT_NAME;
         jsonObject[PTY_EFFECTSETVER] = _effectSetVersion;
+        jsonObject["wec"] = _warmEffectCount;
 
         JsonArray effectsArray = jsonObject.createNestedArray("efs");
 
@@ -283,6 +358,22 @@ public:
                 return false;
         }
 
+        if (!_vLayers.empty())
+        {
+            JsonArray layersArray = jsonObject.createNestedArray("lyr");
+
+            for (auto & layer : _vLayers)
+            {
+                JsonObject layerObject = layersArray.createNestedObject();
+                layerObject[PTY_BLEND]   = to_value(layer.BlendMode);
+                layerObject[PTY_OPACITY] = layer.Opacity;
+
+                JsonObject effectObject = layerObject.createNestedObject(PTY_EFFECT);
+                if (!(layer.Effect->SerializeToJSON(effectObject)))
+                    return false;
+            }
+        }
+
         return true;
     }
 
@@ -318,8 +409,51 @@ public:
             pMatrix->SetCaption(effect->FriendlyName(), CAPTION_TIME);
         #endif
 
-        effect->Start();
+        // The effect we're leaving will have to be prepared again before it next starts. The one we're starting
+        //   has normally been prepared in the background already, in which case this costs next to nothing.
+        //   If something else was prepared in the meantime, it isn't going to start now, so we undo that.
+
+        if (_startedEffect)
+        {
+            _startedEffect->ResetPreparation();
+            _startedEffect->Stop();
+        }
+        _startedEffect = effect;
+
+        AbandonQueuedEffect(effect);
+        _queuedEffect.reset();
+
+        {
+            MemoryAccountScope memoryScope(effect->GetMemoryAccount());
+            effect->EnsurePrepared();
+            effect->Start();
+        }
         _effectStartTime = millis();
+
+        #if USE_LAZY_EFFECTS
+            ReleaseUnusedEffects();
+        #endif
+    }
+
+    // PrepareQueuedEffect
+    //
+    // Called on the effect preparation task to prepare the effect that PrepareNextEffectIfDue() queued, if any
+
+    void PrepareQueuedEffect()
+    {
+        auto effect = std::atomic_exchange(&_effectToPrepare, std::shared_ptr<LEDStripEffect>());
+
+        if (effect)
+        {
+            debugV("Preparing effect %s ahead of its start", effect->FriendlyName().c_str());
+            MemoryAccountScope memoryScope(effect->GetMemoryAccount());
+            effect->EnsurePrepared();
+
+            // Preparing runs effect constructors, JSON and file system code, so we keep an eye on the stack
+            auto stackLeft = uxTaskGetStackHighWaterMark(nullptr);
+            if (stackLeft < PREPARE_STACK_MARGIN)
+                debugW("Effect prepare task has only %u bytes of stack left after preparing %s", stackLeft, effect->FriendlyName().c_str());
+        }
     }
 
     void EnableEffect(size_t i, bool skipSave = false)
@@ -418,6 +552,7 @@ public:
     //   is undefined but potentially messy.
     bool AppendEffect(std::shared_ptr<LEDStripEffect>& effect)
     {
+        MemoryAccountScope memoryScope(effect->GetMemoryAccount());
         if (!effect->Init(_gfx))
             return false;
 
@@ -429,6 +564,35 @@ public:
         return true;
     }
 
+    // Adds an effect layer that is drawn on top of whatever effect is current. The effect is initialized here
+    //   and started when it's first drawn.
+    bool AddLayer(std::shared_ptr<LEDStripEffect>& effect, LayerBlendMode blendMode = LayerBlendMode::Alpha, uint8_t opacity = 255, bool skipSave = false)
+    {
+        MemoryAccountScope memoryScope(effect->GetMemoryAccount());
+        if (!effect->Init(_gfx))
+            return false;
+
+        _vLayers.emplace_back(effect, blendMode, opacity);
+
+        if (!skipSave)
+            SaveEffectManagerConfig();
+
+        return true;
+    }
+
+    void ClearLayers(bool skipSave = false)
+    {
+        _vLayers.clear();
+
+        if (!skipSave)
+            SaveEffectManagerConfig();
+    }
+
+    size_t LayerCount() const
+    {
+        return _vLayers.size();
+    }
+
     bool DeleteEffect(size_t index)
     {
         if (index >= _vEffects.size())
@@ -590,16 +754,26 @@ public:
     }
     // Update to the next effect and abort the current effect.
 
-    void NextEffect(bool skipSave = false)
+    // Returns the index of the effect that NextEffect() would move to
+
+    size_t GetNextEffectIndex() const
     {
         auto enabled = AreEffectsEnabled();
+        size_t index = _iCurrentEffect;
 
         do
         {
-            _iCurrentEffect++; //   ... if so advance to next effect
-            _iCurrentEffect %= EffectCount();
-            _effectStartTime = millis();
-        } while (enabled && false == _bPlayAll && false == IsEffectEnabled(_iCurrentEffect));
+            index++;
+            index %= EffectCount();
+        } while (enabled && false == _bPlayAll && false == IsEffectEnabled(index));
+
+        return index;
+    }
+
+    void NextEffect(bool skipSave = false)
+    {
+        _iCurrentEffect = GetNextEffectIndex(); //   ... if so advance to next effect
+        _effectStartTime = millis();
 
         StartEffect();
         SaveCurrentEffectIndex();
@@ -638,13 +812,28 @@ public:
         constexpr auto msFadeTime = EFFECT_CROSS_FADE_TIME;
 
         CheckEffectTimerExpired();
+        PrepareNextEffectIfDue();
 
         // If a remote control effect is set, we draw that, otherwise we draw the regular effect
 
-        if (_tempEffect)
-            _tempEffect->Draw();
-        else
-            _vEffects[_iCurrentEffect]->Draw(); // Draw the currently active effect
+        auto& effect = _tempEffect ? _tempEffect : _vEffects[_iCurrentEffect];
+        {
+            MemoryAccountScope memoryScope(effect->GetMemoryAccount());
+            DrawEffect(*effect);
+        }
+
+        // Draw any effect layers and blend them over the frame. We don't do this over temporary effects like the
+        // splash screen or a global color that was set by the remote.
+
+        const bool drawLayers = !_tempEffect && !_vLayers.empty();
+        if (drawLayers)
+            DrawLayers();
+
+        // Unless the effect keeps track of what it draws, we have to assume it changed everything
+
+        if (drawLayers || !effect->TracksDirtyRegion())
+            for (auto& device : _gfx)
+                device->MarkAllDirty();
 
         // If we do indeed have multiple effects (BUGBUG what if only a single enabled?) then we
         // fade in and out at the appropriate time based on the time remaining/used by the effect
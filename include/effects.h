@@ -204,9 +204,11 @@
 #define PTY_EFFECTSETVER    "esv"
 #define PTY_PROJECT         "prj"
 #define PTY_GIFINDEX        "gij"
+#define PTY_GIFFILE         "gif"
 #define PTY_BKCOLOR         "bkg"
 #define PTY_FPS             "fps"
 #define PTY_PRECLEAR        "prc"
 #define PTY_IGNOREGLOBALCOLOR   "igc"
+#define PTY_OPACITY         "opa"
 
 #define EFFECTS_CONFIG_FILE "/effects.cfg"
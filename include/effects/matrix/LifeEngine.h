@@ -0,0 +1,294 @@
+//+--------------------------------------------------------------------------
+//
+// File:        LifeEngine.h
+//
+// NightDriverStrip - (c) 2018 Plummer's Software LLC.  All Rights Reserved.
+//
+// This file is part of the NightDriver software project.
+//
+//    NightDriver is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    NightDriver is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with Nightdriver.  It is normally found in copying.txt
+//    If not, see <https://www.gnu.org/licenses/>.
+//
+//
+// Description:
+//
+//    A bit-packed Game of Life world. Each row is stored 32 cells to a
+//    word, and the neighbour counts for a whole word are worked out at
+//    once with full adders built from bitwise operations. The world wraps
+//    around at the edges. LifeCycleDetector spots a world that has
+//    started repeating itself by keeping recent generation hashes in a
+//    ring with a small hash index over it.
+//
+//
+// History:     Oct-19-2026                     Created for NightDriverStrip
+//
+//---------------------------------------------------------------------------
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+// LifeWorld
+
+class LifeWorld
+{
+    size_t _width;
+    size_t _height;
+    size_t _wordsPerRow;
+    uint32_t _tailMask;                                 // The bits of a row's last word that hold cells
+
+    psram_unique_ptr<uint32_t[]> _cells;
+    psram_unique_ptr<uint32_t[]> _previous;             // The generation before the current one
+    psram_unique_ptr<uint32_t[]> _west;                 // Scratch: each row shifted so bit x holds cell x - 1
+    psram_unique_ptr<uint32_t[]> _east;                 // Scratch: each row shifted so bit x holds cell x + 1
+
+    static psram_unique_ptr<uint32_t[]> AllocateRows(size_t words)
+    {
+        auto rows = make_unique_psram_array<uint32_t>(words);
+        memset(rows.get(), 0, words * sizeof(uint32_t));
+        return rows;
+    }
+
+    // Shifts a row one cell both ways, wrapping the cells that fall off one end around to the other. Only the last
+    // word of a row can be partly used, so every other word can take its carry from its full neighbour.
+
+    void ShiftRow(const uint32_t * row, uint32_t * west, uint32_t * east) const
+    {
+        const size_t last = _wordsPerRow - 1;
+        const unsigned lastBit = (_width - 1) % 32;
+
+        for (size_t k = 0; k <= last; k++)
+        {
+            const uint32_t carryWest = k > 0 ? row[k - 1] >> 31 : (row[last] >> lastBit) & 1;
+            const uint32_t carryEast = k < last ? row[k + 1] << 31 : 0;
+
+            west[k] = (row[k] << 1) | carryWest;
+            east[k] = (row[k] >> 1) | carryEast;
+        }
+
+        west[last] &= _tailMask;
+        east[last] |= (row[0] & 1) << lastBit;
+    }
+
+    static void FullAdd(uint32_t a, uint32_t b, uint32_t c, uint32_t & sum, uint32_t & carry)
+    {
+        const uint32_t ab = a ^ b;
+        sum = ab ^ c;
+        carry = (a & b) | (ab & c);
+    }
+
+  public:
+
+    LifeWorld(size_t width, size_t height)
+        : _width(width),
+          _height(height),
+          _wordsPerRow((width + 31) / 32),
+          _tailMask(width % 32 ? (1u << (width % 32)) - 1 : UINT32_MAX),
+          _cells(AllocateRows(_wordsPerRow * height)),
+          _previous(AllocateRows(_wordsPerRow * height)),
+          _west(AllocateRows(_wordsPerRow * height)),
+          _east(AllocateRows(_wordsPerRow * height))
+    {
+    }
+
+    size_t Width() const
+    {
+        return _width;
+    }
+
+    size_t Height() const
+    {
+        return _height;
+    }
+
+    size_t WordsPerRow() const
+    {
+        return _wordsPerRow;
+    }
+
+    const uint32_t * Row(size_t y) const
+    {
+        return &_cells[y * _wordsPerRow];
+    }
+
+    const uint32_t * PreviousRow(size_t y) const
+    {
+        return &_previous[y * _wordsPerRow];
+    }
+
+    bool Get(size_t x, size_t y) const
+    {
+        return (Row(y)[x / 32] >> (x % 32)) & 1;
+    }
+
+    void Set(size_t x, size_t y, bool alive)
+    {
+        uint32_t & word = _cells[y * _wordsPerRow + x / 32];
+        const uint32_t bit = 1u << (x % 32);
+        word = alive ? (word | bit) : (word & ~bit);
+    }
+
+    // Clears both generations
+    void Clear()
+    {
+        memset(_cells.get(), 0, _wordsPerRow * _height * sizeof(uint32_t));
+        memset(_previous.get(), 0, _wordsPerRow * _height * sizeof(uint32_t));
+    }
+
+    // Step
+    //
+    // Advances the world by one generation. For each word, the eight neighbour bits are added with a tree of full
+    // adders into a three bit count per cell; a count of eight wraps to zero, which gives the same answer as
+    // eight would. A cell is alive next time if its count is three, or two and it's alive now.
+
+    void Step()
+    {
+        for (size_t y = 0; y < _height; y++)
+            ShiftRow(Row(y), &_west[y * _wordsPerRow], &_east[y * _wordsPerRow]);
+
+        std::swap(_cells, _previous);
+
+        for (size_t y = 0; y < _height; y++)
+        {
+            const size_t up   = (y == 0 ? _height : y) - 1;
+            const size_t down = y + 1 == _height ? 0 : y + 1;
+
+            const uint32_t * above = &_previous[up * _wordsPerRow];
+            const uint32_t * row   = &_previous[y * _wordsPerRow];
+            const uint32_t * below = &_previous[down * _wordsPerRow];
+            uint32_t * next        = &_cells[y * _wordsPerRow];
+
+            for (size_t k = 0; k < _wordsPerRow; k++)
+            {
+                uint32_t sumAbove, carryAbove, sumBelow, carryBelow;
+                FullAdd(_west[up * _wordsPerRow + k], above[k], _east[up * _wordsPerRow + k], sumAbove, carryAbove);
+                FullAdd(_west[down * _wordsPerRow + k], below[k], _east[down * _wordsPerRow + k], sumBelow, carryBelow);
+
+                const uint32_t sumSide   = _west[y * _wordsPerRow + k] ^ _east[y * _wordsPerRow + k];
+                const uint32_t carrySide = _west[y * _wordsPerRow + k] & _east[y * _wordsPerRow + k];
+
+                uint32_t ones, carryOnes;
+                FullAdd(sumAbove, sumBelow, sumSide, ones, carryOnes);
+
+                uint32_t twosPartial, foursPartial;
+                FullAdd(carryAbove, carryBelow, carrySide, twosPartial, foursPartial);
+
+                const uint32_t twos  = twosPartial ^ carryOnes;
+                const uint32_t fours = foursPartial ^ (twosPartial & carryOnes);
+
+                next[k] = ~fours & twos & (ones | row[k]);
+            }
+            next[_wordsPerRow - 1] &= _tailMask;
+        }
+    }
+
+    // A hash of the live cells, for spotting repeats
+    uint32_t Hash() const
+    {
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < _wordsPerRow * _height; i++)
+            hash = (hash ^ _cells[i]) * 16777619u;
+        return hash ^ (hash >> 15);
+    }
+};
+
+// LifeCycleDetector
+//
+// Remembers the hashes of the last N generations. Each slot of the ring is also on a chain hanging off one of
+// the buckets of a small hash table, so looking a hash up and retiring the oldest one are both constant time,
+// and nothing is allocated once we're constructed.
+
+class LifeCycleDetector
+{
+    static constexpr int16_t kNone = -1;
+
+    size_t _length;
+    size_t _bucketMask;
+    size_t _oldest = 0;
+    size_t _count = 0;
+
+    std::unique_ptr<uint32_t[]> _hashes;
+    std::unique_ptr<int16_t[]> _next;                   // The next slot on the same bucket's chain
+    std::unique_ptr<int16_t[]> _buckets;                // The first slot on each bucket's chain
+
+    size_t BucketOf(uint32_t hash) const
+    {
+        return (hash * 2654435761u) >> 16 & _bucketMask;
+    }
+
+    void Unlink(size_t slot)
+    {
+        int16_t * link = &_buckets[BucketOf(_hashes[slot])];
+        while (*link != (int16_t)slot)
+            link = &_next[*link];
+        *link = _next[slot];
+    }
+
+  public:
+
+    explicit LifeCycleDetector(size_t length)
+        : _length(length),
+          _hashes(std::make_unique<uint32_t[]>(length)),
+          _next(std::make_unique<int16_t[]>(length))
+    {
+        size_t buckets = 1;
+        while (buckets < length * 2)
+            buckets <<= 1;
+
+        _bucketMask = buckets - 1;
+        _buckets = std::make_unique<int16_t[]>(buckets);
+        Reset();
+    }
+
+    void Reset()
+    {
+        std::fill(&_buckets[0], &_buckets[_bucketMask + 1], kNone);
+        _oldest = 0;
+        _count = 0;
+    }
+
+    bool Contains(uint32_t hash) const
+    {
+        for (int16_t slot = _buckets[BucketOf(hash)]; slot != kNone; slot = _next[slot])
+            if (_hashes[slot] == hash)
+                return true;
+
+        return false;
+    }
+
+    // Adds a hash, pushing the oldest one out if the ring is full
+    void Add(uint32_t hash)
+    {
+        size_t slot;
+        if (_count == _length)
+        {
+            slot = _oldest;
+            Unlink(slot);
+            _oldest = (_oldest + 1) % _length;
+        }
+        else
+        {
+            slot = (_oldest + _count++) % _length;
+        }
+
+        _hashes[slot] = hash;
+        int16_t & head = _buckets[BucketOf(hash)];
+        _next[slot] = head;
+        head = slot;
+    }
+};
@@ -23,14 +23,19 @@
 //
 // Description:
 //
-//   Displays embedded GIF animations on the LED matrix.  GIF files
-//   are embedded in the flash image and are decoded on the fly.  The
+//   Displays GIF animations on the LED matrix.  GIF files are either
+//   embedded in the flash image or uploaded to SPIFFS through the web
+//   server, and are decoded on the fly.  Uploaded GIFs are streamed
+//   from the file a buffer at a time rather than loaded whole.  The
 //   GIF decoder is from Louis Beaudoin's GifDecoder library.  We use
 //   that to extract frames from the GIF and then plot them on the
 //   LED matrix.  We do that by supplying callbacks to the GIF decoder
 //   that it calls to fetch the GIF data and to plot the pixels on the
 //   LED matrix.
 //
+//   The first time through a GIF we keep a copy of each frame in the
+//   GIFFrameCache, and after that we play it back from there.
+//
 // History:     Nov-21-2023         Davepl      Created
 //
 //---------------------------------------------------------------------------
@@ -47,6 +52,8 @@
 #include "systemcontainer.h"
 #include <map>
 #include "effects.h"
+#include "gifframecache.h"
+#include "gifindex.h"
 #include "types.h"
 #include <GifDecoder.h>
 
@@ -111,13 +118,17 @@ struct
     int             _offsetY   = 0;
     byte            _fps       = 24;
     CRGB            _bkColor   = CRGB::Black;
+    CRGB *          _canvas    = nullptr;       // The decoder draws the frame in here, GIF sized
+    int             _width     = 0;
+    int             _height    = 0;
+    BufferedFileReader _file;                   // Where an uploaded GIF is streamed from
 }
 g_gifDecoderState;
 
 // We dynamically allocate the GIF decoder because it's pretty big and we don't want to waste the base
 // ram on it.  This way it, and the GIFs it decodes, can live in PSRAM.
 
-const std::unique_ptr<GifDecoder<MATRIX_WIDTH, MATRIX_HEIGHT, 16, true>> g_ptrGIFDecoder = make_unique_psram<GifDecoder<MATRIX_WIDTH, MATRIX_HEIGHT, 16, true>>();
+const psram_unique_ptr<GifDecoder<MATRIX_WIDTH, MATRIX_HEIGHT, 16, true>> g_ptrGIFDecoder = make_unique_psram<GifDecoder<MATRIX_WIDTH, MATRIX_HEIGHT, 16, true>>();
 
 // PatternAnimatedGIF
 //
@@ -127,10 +138,29 @@ class PatternAnimatedGIF : public LEDStripEffect
 {
 private:
 
+    static std::vector<SettingSpec, psram_allocator<SettingSpec>> mySettingSpecs;
+
     GIFIdentifier _gifIndex  = GIFIdentifier::INVALID;
+    String _fileName;                                   // Name of an uploaded GIF, which we show instead if it's set
+    mutable std::mutex _fileNameMutex;                  // The web server sets _fileName while we're drawing
+    String _shownFileName;                              // The _fileName we were prepared with
+    uint32_t _fileGeneration = 0;                       // Which version of that file we were prepared with
+    GIFFrameCache::Key _cacheKey;                       // What we're recording under, set when we start
     CRGB _bkColor            = BLACK16;
     bool _preClear           = false;
     bool _gifReadyToDraw     = false;
+    const GIFInfo * _pGifInfo = nullptr;
+    GIFIndex _fileIndex;
+    uint16_t _width          = 0;                       // Size of the GIF we're showing, 0 if we don't have one
+    uint16_t _height         = 0;
+    byte _fps                = 24;
+
+    std::vector<CRGB, psram_allocator<CRGB>> _canvas;  // What the decoder draws on, which persists between frames
+    std::shared_ptr<GIFFrames> _recording;              // Frames decoded so far on our first time through
+    size_t _reservedBytes    = 0;                       // What we've set aside in the cache for the recording
+    size_t _framesToRecord   = 0;
+    std::shared_ptr<const GIFFrames> _frames;           // All frames, once we have them, which we then play back
+    size_t _frameIndex       = 0;
 
     // GIF decoder callbacks.  These are static because the decoder doesn't allow you to pass any context, so they
     // have to be global.  We use the global g_gifDecoderState to track state.  The GifDecoder code calls back to
@@ -142,7 +172,9 @@ private:
     static void screenClearCallback(void)
     {
         auto& g = *(g_ptrSystem->EffectManager().g());
-        g.fillScreen(g.to16bit(g_gifDecoderState._bkColor));
+        uint16_t color = g.to16bit(g_gifDecoderState._bkColor);
+        g.fillScreen(color);
+        std::fill_n(g_gifDecoderState._canvas, g_gifDecoderState._width * g_gifDecoderState._height, GFXBase::from16Bit(color));
     }
 
     // We decide when to update the screen, so this is a no-op
@@ -154,17 +186,17 @@ private:
 
     // drawPixelCallback
     //
-    // This is called by the GIF decoder to draw a pixel.  We use the offset to center the GIF on the LED matrix.
+    // This is called by the GIF decoder to draw a pixel.  It goes on the canvas, which DrawFrame() then centers
+    // on the LED matrix.
 
     static void drawPixelCallback(int16_t x, int16_t y, uint8_t red, uint8_t green, uint8_t blue)
     {
-        auto& g = *(g_ptrSystem->EffectManager().g(0));
-        if (false == g.isValidPixel(x  + g_gifDecoderState._offsetX, y + g_gifDecoderState._offsetY))
+        if (x < 0 || x >= g_gifDecoderState._width || y < 0 || y >= g_gifDecoderState._height)
         {
-            debugW("drawPixelCallbackInvalid pixel: %d, %d", x + g_gifDecoderState._offsetX, y + g_gifDecoderState._offsetY);
+            debugW("drawPixelCallbackInvalid pixel: %d, %d", x, y);
             return;
         }
-        g.leds[XY(x + g_gifDecoderState._offsetX, y + g_gifDecoderState._offsetY)] = CRGB(red, green, blue);
+        g_gifDecoderState._canvas[y * g_gifDecoderState._width + x] = CRGB(red, green, blue);
     }
 
     // drawLineCallback
@@ -179,12 +211,164 @@ private:
         throw new std::runtime_error("drawLineCallback not implemented for animated GIFs");
     }
 
+    // File callbacks, which the decoder uses to stream uploaded GIFs from SPIFFS
+
+    static bool fileSeekCallback(unsigned long position)
+    {
+        return g_gifDecoderState._file.Seek(position);
+    }
+
+    static unsigned long filePositionCallback(void)
+    {
+        return g_gifDecoderState._file.Position();
+    }
+
+    static int fileReadCallback(void)
+    {
+        return g_gifDecoderState._file.Read();
+    }
+
+    static int fileReadBlockCallback(void * buffer, int numberOfBytes)
+    {
+        return g_gifDecoderState._file.Read(buffer, numberOfBytes);
+    }
+
+    static int fileSizeCallback(void)
+    {
+        return g_gifDecoderState._file.Size();
+    }
+
 
     size_t DesiredFramesPerSecond() const override
     {
         return g_gifDecoderState._fps;
     }
 
+    String FileName() const
+    {
+        std::lock_guard<std::mutex> guard(_fileNameMutex);
+        return _fileName;
+    }
+
+    bool IsUploaded() const
+    {
+        return !_shownFileName.isEmpty();
+    }
+
+    // Whether the file we're showing has been replaced or deleted since we were prepared
+    bool FileChanged() const
+    {
+        return GIFFrameCache::Instance().FileGeneration(_shownFileName) != _fileGeneration;
+    }
+
+    // StartDecoding
+    //
+    // Points the decoder at the GIF.  Embedded GIFs are decoded straight from flash, uploaded ones from the file.
+
+    bool StartDecoding()
+    {
+        if (!IsUploaded())
+            return ERROR_NONE == g_ptrGIFDecoder->startDecoding((uint8_t *) _pGifInfo->contents, _pGifInfo->length);
+
+        std::lock_guard<std::mutex> guard(Assets::FileMutex());
+
+        if (FileChanged() || !g_gifDecoderState._file.Open(Assets::Path(_shownFileName)))
+            return false;
+
+        g_ptrGIFDecoder->setFileSeekCallback( fileSeekCallback );
+        g_ptrGIFDecoder->setFilePositionCallback( filePositionCallback );
+        g_ptrGIFDecoder->setFileReadCallback( fileReadCallback );
+        g_ptrGIFDecoder->setFileReadBlockCallback( fileReadBlockCallback );
+        g_ptrGIFDecoder->setFileSizeCallback( fileSizeCallback );
+
+        return ERROR_NONE == g_ptrGIFDecoder->startDecoding();
+    }
+
+    // DecodeFrame
+    //
+    // Has the decoder draw the next frame on the canvas. An uploaded file is only read while it can't be swapped
+    // out, and not at all once it has been.
+
+    bool DecodeFrame()
+    {
+        if (!IsUploaded())
+            return ERROR_NONE == g_ptrGIFDecoder->decodeFrame(false);
+
+        std::lock_guard<std::mutex> guard(Assets::FileMutex());
+        return !FileChanged() && ERROR_NONE == g_ptrGIFDecoder->decodeFrame(false);
+    }
+
+    // DrawFrame
+    //
+    // Copies a whole GIF sized frame onto the middle of the matrix
+
+    void DrawFrame(const CRGB * frame)
+    {
+        auto& graphics = *g();
+        const int width = _width;
+
+        for (int y = 0; y < _height; y++)
+        {
+            const CRGB * row = frame + y * width;
+
+            #if USE_HUB75
+                // The panel is laid out a row at a time, so each row of the GIF is one copy
+                memcpy(&graphics.leds[XY(g_gifDecoderState._offsetX, g_gifDecoderState._offsetY + y)], row, width * sizeof(CRGB));
+            #else
+                for (int x = 0; x < width; x++)
+                    graphics.leds[XY(g_gifDecoderState._offsetX + x, g_gifDecoderState._offsetY + y)] = row[x];
+            #endif
+        }
+    }
+
+    // A recording counts against the cache's budget for as long as it's in progress, so we give back what we set
+    // aside for it when it's done or abandoned
+
+    void DropRecording()
+    {
+        _recording.reset();
+        GIFFrameCache::Instance().Unreserve(_reservedBytes);
+        _reservedBytes = 0;
+    }
+
+    // We only let go of the decoder's state if we're the ones using it, as another GIF effect may be by now
+
+    void ReleaseCanvas()
+    {
+        if (!_canvas.empty() && g_gifDecoderState._canvas == _canvas.data())
+        {
+            g_gifDecoderState._canvas = nullptr;
+            if (IsUploaded())
+                g_gifDecoderState._file.Close();
+        }
+
+        _canvas.clear();
+        _canvas.shrink_to_fit();
+    }
+
+    // RecordFrame
+    //
+    // Keeps a copy of the frame that was just decoded, and hands the lot to the cache once we've seen them all
+
+    void RecordFrame()
+    {
+        if (!_recording)
+            return;
+
+        _recording->AddFrame(_canvas.data());
+        if (_recording->FrameCount() < _framesToRecord)
+            return;
+
+        auto frames = _recording;
+        DropRecording();
+        GIFFrameCache::Instance().Insert(_cacheKey, frames);
+        _frames = std::move(frames);
+        _frameIndex = 0;
+
+        // We won't be decoding any more, so the canvas and the file can go
+        ReleaseCanvas();
+    }
+
 public:
 
     PatternAnimatedGIF(const String & friendlyName, GIFIdentifier gifIndex, bool preClear = false, CRGB bkColor = CRGB::Black) :
@@ -195,10 +379,19 @@ public:
     {
     }
 
+    PatternAnimatedGIF(const String & friendlyName, const String & fileName, bool preClear = false, CRGB bkColor = CRGB::Black) :
+        LEDStripEffect(EFFECT_MATRIX_ANIMATEDGIF, friendlyName),
+        _fileName(fileName),
+        _preClear(preClear),
+        _bkColor(bkColor)
+    {
+    }
+
     PatternAnimatedGIF(const JsonObjectConst& jsonObject)
         : LEDStripEffect(jsonObject),
           _preClear(jsonObject[PTY_PRECLEAR]),
           _gifIndex((GIFIdentifier)jsonObject[PTY_GIFINDEX].as<std::underlying_type_t<GIFIdentifier>>()),
+          _fileName(jsonObject[PTY_GIFFILE] | ""),
           _bkColor(jsonObject[PTY_BKCOLOR])
     {
     }
@@ -214,31 +407,142 @@ public:
         jsonDoc[PTY_BKCOLOR]   = _bkColor;
         jsonDoc[PTY_PRECLEAR]  = _preClear;
 
+        String fileName = FileName();
+        if (!fileName.isEmpty())
+            jsonDoc[PTY_GIFFILE] = fileName;
+
         assert(!jsonDoc.overflowed());
         return jsonObject.set(jsonDoc.as<JsonObjectConst>());
     }
 
+    bool FillSettingSpecs() override
+    {
+        if (!LEDStripEffect::FillSettingSpecs())
+            return false;
+
+        if (mySettingSpecs.size() == 0)
+        {
+            mySettingSpecs.emplace_back(
+                ACTUAL_NAME_OF(_fileName),
+                "GIF file",
+                "The name of an uploaded GIF to show instead of the built-in one. Leave empty for the built-in GIF.",
+                SettingSpec::SettingType::String
+            ).EmptyAllowed = true;
+        }
+
+        _settingSpecs.insert(_settingSpecs.end(), mySettingSpecs.begin(), mySettingSpecs.end());
+
+        return true;
+    }
+
+    bool SerializeSettingsToJSON(JsonObject& jsonObject) override
+    {
+        StaticJsonDocument<_jsonSize> jsonDoc;
+
+        JsonObject root = jsonDoc.to<JsonObject>();
+        LEDStripEffect::SerializeSettingsToJSON(root);
+
+        jsonDoc[ACTUAL_NAME_OF(_fileName)] = FileName();
+
+        if (jsonDoc.overflowed())
+            debugE("JSON buffer overflow while serializing settings for PatternAnimatedGIF - object incomplete!");
+
+        return jsonObject.set(jsonDoc.as<JsonObjectConst>());
+    }
+
+    // The new file is picked up the next time the effect is prepared
+    bool SetSetting(const String& name, const String& value) override
+    {
+        {
+            std::lock_guard<std::mutex> guard(_fileNameMutex);
+            RETURN_IF_SET(name, ACTUAL_NAME_OF(_fileName), _fileName, value);
+        }
+
+        return LEDStripEffect::SetSetting(name, value);
+    }
+
+    // Prepare
+    //
+    // Looks up the GIF we're going to show, and for an uploaded one reads its index. The decoder itself is shared
+    // by all GIF effects and may well be busy with the one that's showing right now, so we don't touch it until
+    // Start() is called. From here on we stick with the file name we have now, even if it's changed meanwhile.
+
+    void Prepare() override
+    {
+        _pGifInfo = nullptr;
+        _width = _height = 0;
+        _shownFileName = FileName();
+
+        if (IsUploaded())
+        {
+            std::lock_guard<std::mutex> guard(Assets::FileMutex());
+
+            _fileGeneration = GIFFrameCache::Instance().FileGeneration(_shownFileName);
+            if (_fileIndex.ForAsset(_shownFileName) && _fileIndex.FitsMatrix())
+            {
+                _width  = _fileIndex.Width();
+                _height = _fileIndex.Height();
+                _fps    = _fileIndex.FramesPerSecond();
+            }
+            return;
+        }
+
+        auto gif = AnimatedGIFs.find(_gifIndex);
+        if (gif == AnimatedGIFs.end())
+            return;
+
+        _pGifInfo = &gif->second;
+        _width    = _pGifInfo->_width;
+        _height   = _pGifInfo->_height;
+        _fps      = _pGifInfo->_fps;
+    }
+
     void Start() override
     {
         g()->Clear(_bkColor);
 
         // Open the GIF and start decoding
 
-        auto gif = AnimatedGIFs.find(_gifIndex);
-        if (gif == AnimatedGIFs.end())
-            throw std::runtime_error(str_sprintf("Unable to locate GIF by index %d in the map.", (int) _gifIndex).c_str());
-        
+        if (_width == 0)
+        {
+            // Uploaded files can come and go, so one that's missing isn't fatal
+            if (!IsUploaded())
+                throw std::runtime_error(str_sprintf("Unable to locate GIF by index %d in the map.", (int) _gifIndex).c_str());
+
+            debugW("Unable to show GIF %s", _shownFileName.c_str());
+            Stop();
+            return;
+        }
+
         // Set up the gifDecoderState with all of the context that it will need to decode and
         // draw the GIF, since the static callbacks will have no other context to work with.
 
-        assert(gif->second._width <= MATRIX_WIDTH);
-        assert(gif->second._height <= MATRIX_HEIGHT);
+        assert(_width <= MATRIX_WIDTH);
+        assert(_height <= MATRIX_HEIGHT);
 
-        g_gifDecoderState._offsetX   = (MATRIX_WIDTH  - gif->second._width) / 2;
-        g_gifDecoderState._offsetY   = (MATRIX_HEIGHT - gif->second._height) / 2;
-        g_gifDecoderState._fps       = gif->second._fps;
+        g_gifDecoderState._offsetX   = (MATRIX_WIDTH  - _width) / 2;
+        g_gifDecoderState._offsetY   = (MATRIX_HEIGHT - _height) / 2;
+        g_gifDecoderState._fps       = _fps;
         g_gifDecoderState._bkColor   = _bkColor;
 
+        // If we've decoded this GIF before, we can play it back without the decoder
+
+        DropRecording();
+        _frameIndex = 0;
+        _cacheKey = { to_value(_gifIndex), _shownFileName, _bkColor, _preClear };
+        _frames = GIFFrameCache::Instance().Find(_cacheKey);
+        if (_frames)
+        {
+            ReleaseCanvas();
+            _gifReadyToDraw = true;
+            return;
+        }
+
+        _canvas.assign(_width * _height, _bkColor);
+        g_gifDecoderState._canvas    = _canvas.data();
+        g_gifDecoderState._width     = _width;
+        g_gifDecoderState._height    = _height;
+
         // Set the GIF decoder callbacks to our static functions
 
         g_ptrGIFDecoder->setScreenClearCallback( screenClearCallback );
@@ -246,13 +550,50 @@ public:
         g_ptrGIFDecoder->setDrawPixelCallback( drawPixelCallback );
         g_ptrGIFDecoder->setDrawLineCallback( drawLineCallback );
 
-        _gifReadyToDraw = (ERROR_NONE == g_ptrGIFDecoder->startDecoding((uint8_t *) gif->second.contents, gif->second.length));
+        _gifReadyToDraw = StartDecoding();
         if (!_gifReadyToDraw)
+        {
             debugW("Failed to start decoding GIF");
+            return;
+        }
+
+        // Record the frames as we go if they'll fit in the cache. Counting the frames of an uploaded GIF would
+        // mean a pass over the whole file, so we take that from its index instead. The recording is sized for all
+        // of them at once, which the cache makes room for before we allocate it.
+
+        int frameCount = IsUploaded() ? _fileIndex.FrameCount() : g_ptrGIFDecoder->getFrameCount();
+        size_t recordingBytes = frameCount * _canvas.size() * sizeof(CRGB);
+        if (frameCount > 0 && GIFFrameCache::Instance().Reserve(recordingBytes))
+        {
+            _reservedBytes  = recordingBytes;
+            _framesToRecord = frameCount;
+            _recording = make_shared_psram<GIFFrames>(_width, _height, _framesToRecord);
+        }
+    }
+
+    // Stop
+    //
+    // Lets go of everything we decoded, so a GIF that isn't showing doesn't hold on to memory that the cache
+    // counts as free once it drops the frames
+
+    void Stop() override
+    {
+        DropRecording();
+        ReleaseCanvas();
+        _frames.reset();
+        _gifReadyToDraw = false;
     }
 
     void Draw() override
     {
+        // If the file we're showing was replaced, we start over with the new one, or find it's gone
+        if (IsUploaded() && FileChanged())
+        {
+            debugI("GIF %s has changed, starting it again", _shownFileName.c_str());
+            Prepare();
+            Start();
+        }
+
         // GIFs that use transparency will leave the previous frame in place, so we need
         // to clear the screen before we draw the next frame.  We can skip this if the
         // GIF doesn't use transparency.
@@ -260,10 +601,28 @@ public:
         if (_preClear)
             g()->Clear(_bkColor);
 
-        if (_gifReadyToDraw)
-            g_ptrGIFDecoder->decodeFrame(false);   
-        else
+        if (!_gifReadyToDraw)
+        {
             g()->Clear(CRGB::Red);
+            return;
+        }
+
+        if (_frames)
+        {
+            DrawFrame(_frames->Frame(_frameIndex));
+            _frameIndex = (_frameIndex + 1) % _frames->FrameCount();
+            return;
+        }
+
+        if (_preClear)
+            std::fill(_canvas.begin(), _canvas.end(), _bkColor);
+
+        // If the decoder has trouble we can't trust the frames we've kept, so we stop recording
+        if (!DecodeFrame())
+            DropRecording();
+
+        DrawFrame(_canvas.data());
+        RecordFrame();
     }
 };
 
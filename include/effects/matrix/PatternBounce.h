@@ -79,6 +79,7 @@ class PatternBounce : public LEDStripEffect
 private:
     static const int count = MATRIX_WIDTH;
     PVector gravity = PVector(0, 0.0125);
+    uint8_t frameCount = 0;
 
 public:
     PatternBounce() : LEDStripEffect(EFFECT_MATRIX_BOUNCE, "Bounce")
@@ -89,7 +90,13 @@ public:
     {
     }
 
-    bool RequiresDoubleBuffering() const override
+    std::optional<bool> RequiresDoubleBuffering() const override
+    {
+        return true;
+    }
+
+    // Each boid is a column of its own, so we keep all of them and save on the blur instead
+    bool SupportsQualityScaling() const override
     {
         return true;
     }
@@ -113,14 +120,17 @@ public:
     {
         // dim all pixels on the display
 
-        // Blue columns only, and skip the first row of each column if the VU meter is being shown so we don't blend it onto ourselves
-        g()->blurColumns(g()->leds, MATRIX_WIDTH, MATRIX_HEIGHT, g_ptrSystem->EffectManager().IsVUVisible() ? 1 : 0, 200);
+        // Blue columns only, and skip the first row of each column if the VU meter is being shown so we don't blend it onto ourselves.
+        // Below full quality we only blur every other frame, and at the lowest level not at all.
+        frameCount++;
+        if (QualityLevel() == kMaxQualityLevel || (QualityLevel() > 0 && (frameCount & 1)))
+            g()->blurColumns(g()->leds, MATRIX_WIDTH, MATRIX_HEIGHT, g_ptrSystem->EffectManager().IsVUVisible() ? 1 : 0, 200);
         g()->DimAll(250);
 
         auto totalVelocity = 0.0;
         for (int i = 0; i < count; i++)
         {
-            Boid boid = g()->_boids[i];
+            Boid & boid = g()->_boids[i];
             boid.applyForce(gravity);
             boid.update();
             totalVelocity += abs(boid.velocity.y);
@@ -133,8 +143,6 @@ public:
                 boid.location.y = MATRIX_HEIGHT - 1;
                 boid.velocity.y *= -1.0;
             }
-
-            g()->_boids[i] = boid;
         }
         
         // If the combined velocity of all the boids is less than 1.0, restart the animation.
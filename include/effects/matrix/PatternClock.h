@@ -56,7 +56,7 @@ class PatternClock : public LEDStripEffect
     {
     }
 
-    bool RequiresDoubleBuffering() const override
+    std::optional<bool> RequiresDoubleBuffering() const override
     {
         return false;
     }
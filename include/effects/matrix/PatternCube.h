@@ -202,7 +202,7 @@ class PatternCube : public LEDStripEffect
         return 40;
     }
 
-    bool RequiresDoubleBuffering() const override
+    std::optional<bool> RequiresDoubleBuffering() const override
     {
         return false;
     }
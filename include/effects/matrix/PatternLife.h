@@ -63,11 +63,7 @@
 #define PatternLife_H
 
 #include <bitset>
-
-extern "C"
-{
-    #include "uzlib/src/uzlib.h"
-}
+#include "LifeEngine.h"
 
 // Introduction:
 // -------------
@@ -114,13 +110,12 @@ extern "C"
 //    visualization on the LED matrix.
 //
 
-class Cell
+// Cells live in a bit-packed LifeWorld; what we keep per cell here is only how it's drawn
+
+struct CellLook
 {
-public:
-  uint8_t alive : 1;
-  uint8_t prev  : 1;
-  uint8_t hue;
-  uint8_t brightness;
+    uint8_t hue;
+    uint8_t brightness;
 };
 
 // We check for loops by keeping a number of hashes of previous frames.  A walker that goes up and across
@@ -131,12 +126,13 @@ constexpr auto CRC_LENGTH = (std::max(MATRIX_HEIGHT, MATRIX_WIDTH) * 4 + 1);
 class PatternLife : public LEDStripEffect
 {
 private:
-    std::unique_ptr<Cell [][MATRIX_HEIGHT]> world;
-    std::unique_ptr<uint32_t []> checksums;
-    int iChecksum = 0;
+    std::unique_ptr<LifeWorld> world;
+    psram_unique_ptr<CellLook []> looks;               // Indexed by y * MATRIX_WIDTH + x
+    std::unique_ptr<LifeCycleDetector> history;
     uint32_t bStuckInLoop = 0;
     unsigned int density = 50;
     int cGeneration = 0;
+    bool bSeeded = false;
     unsigned long seed;
 
 
@@ -147,17 +143,23 @@ private:
         // Note: placing the world in PSRAM may slow this effect down, but it's currently running
         //       fast enough (30+ fps) that we can afford to use it
 
-        world.reset(psram_allocator<Cell [MATRIX_HEIGHT]>().allocate(MATRIX_WIDTH)) ;
-        checksums.reset(psram_allocator<uint32_t>().allocate(CRC_LENGTH));
+        world = std::make_unique<LifeWorld>(MATRIX_WIDTH, MATRIX_HEIGHT);
+        looks = make_unique_psram_array<CellLook>(MATRIX_WIDTH * MATRIX_HEIGHT);
+        history = std::make_unique<LifeCycleDetector>(CRC_LENGTH);
 
         return true;
     }
 
-    bool RequiresDoubleBuffering() const override
+    std::optional<bool> RequiresDoubleBuffering() const override
     {
         return true;
     }
 
+    CellLook & Look(int x, int y)
+    {
+        return looks[y * MATRIX_WIDTH + x];
+    }
+
     // A table of seed vs generation count.  These are seeds that net long runs of at least 3000 generations.
     //
     // Example:  Seed: 92465, Generations: 1626
@@ -203,35 +205,30 @@ private:
             debugI("Randomized Seed: %lu", seed);
         }
 
+        // The fill goes column by column so the baked in seeds still produce the worlds they were picked for
+
+        world->Clear();
         srand(seed);
         for (int i = 0; i < MATRIX_WIDTH; i++) {
             for (int j = 0; j < MATRIX_HEIGHT; j++) {
-                if ((rand() % 100) < density) {
-                    world[i][j].alive = 1;
-                    world[i][j].brightness = 128;
-                }
-                else {
-                    world[i][j].alive = 0;
-                    world[i][j].brightness = 0;
-                }
-                world[i][j].prev = world[i][j].alive;
-                world[i][j].hue = 0;
+                bool alive = (rand() % 100) < density;
+                world->Set(i, j, alive);
+                Look(i, j) = { 0, (uint8_t)(alive ? 128 : 0) };
             }
         }
 
-        for (int i = 0; i < CRC_LENGTH; i++)
-            checksums[i] = 0xFFFFFFF;
+        history->Reset();
     }
 
-    int neighbours(int x, int y) {
-        return (world[(x + 1) % MATRIX_WIDTH][y].prev) +
-            (world[x][(y + 1) % MATRIX_HEIGHT].prev) +
-            (world[(x + MATRIX_WIDTH - 1) % MATRIX_WIDTH][y].prev) +
-            (world[x][(y + MATRIX_HEIGHT - 1) % MATRIX_HEIGHT].prev) +
-            (world[(x + 1) % MATRIX_WIDTH][(y + 1) % MATRIX_HEIGHT].prev) +
-            (world[(x + MATRIX_WIDTH - 1) % MATRIX_WIDTH][(y + 1) % MATRIX_HEIGHT].prev) +
-            (world[(x + MATRIX_WIDTH - 1) % MATRIX_WIDTH][(y + MATRIX_HEIGHT - 1) % MATRIX_HEIGHT].prev) +
-            (world[(x + 1) % MATRIX_WIDTH][(y + MATRIX_HEIGHT - 1) % MATRIX_HEIGHT].prev);
+    // Calls fn(x) for every bit set in the word, where x is the column the bit stands for
+    template<typename Fn>
+    static void ForEachCell(uint32_t word, int firstX, Fn fn)
+    {
+        while (word)
+        {
+            fn(firstX + __builtin_ctz(word));
+            word &= word - 1;
+        }
     }
 
 public:
@@ -247,46 +244,43 @@ public:
     void Reset()
     {
         randomFillWorld();
-        for (int i = 0; i < CRC_LENGTH; i++)
-            checksums[i] = 0xFFFFFFF;
         cGeneration = 0;
         bStuckInLoop = 0;
+        bSeeded = true;
+    }
+
+    // Seeding the world takes a while, so we do it up front when we can. Prepare() normally runs in the
+    // background before the effect starts.
+
+    void Prepare() override
+    {
+        if (!bSeeded)
+            Reset();
     }
 
     void Draw() override
     {
-        if (cGeneration == 0)
+        if (!bSeeded)
             Reset();
 
         // Display current generation
 
         for (int i = 0; i < MATRIX_WIDTH; i++) {
             for (int j = 0; j < MATRIX_HEIGHT; j++) {
-                if (world[i][j].brightness > 0)
-                    g()->leds[XY(i, j)] += g()->ColorFromCurrentPalette(world[i][j].hue * 4, world[i][j].brightness);
+                const auto& look = Look(i, j);
+                if (look.brightness > 0)
+                    g()->leds[XY(i, j)] += g()->ColorFromCurrentPalette(look.hue * 4, look.brightness);
                 else
                     g()->leds[XY(i, j)] = CRGB::Black;
             }
         }
 
-        // We maintain a scrolling window of the last N crcs and if the current crc makes it all
-        // the way down to the bottom half we assume we're stuck in a loop and restart.
-        // We have to first extract the alive bits alone because we don't want the hue and brightness
-        // data to mess with the CRC.
-
-        bool alive[MATRIX_WIDTH][MATRIX_HEIGHT];
-        for (int i = 0; i < MATRIX_WIDTH; i++)
-            for (int j = 0; j < MATRIX_HEIGHT; j++)
-                alive[i][j] = world[i][j].alive;
-
-        auto crc = uzlib_crc32(alive, sizeof(alive), 0xffffffff);
-        for (int i = 0; i < CRC_LENGTH - 1; i++)
-            checksums[i] = checksums[i+1];
-        checksums[CRC_LENGTH - 1] = crc;
+        // We remember the hashes of the last N generations, and if the current one is among them, we
+        // assume we're stuck in a loop and restart.
 
-
-        // Look for any occurrences of the current CRC in the first half of the window, which would mean
-        // a loop has occurred.  If
+        const auto hash = world->Hash();
+        const bool seenBefore = history->Contains(hash);
+        history->Add(hash);
 
         if (bStuckInLoop)
         {
@@ -301,56 +295,49 @@ public:
             }
             g()->DimAll(255 - 255*elapsed/resetTime);
 
-            for (int x = 0; x < MATRIX_WIDTH; x++)
-                for (int y = 0; y < MATRIX_HEIGHT; y++)
-                        world[x][y].brightness *= 0.9;
+            for (int i = 0; i < MATRIX_WIDTH * MATRIX_HEIGHT; i++)
+                looks[i].brightness *= 0.9;
             if (elapsed > resetTime)
                 Reset();
         }
-        else
+        else if (seenBefore)
         {
-            for (int i = CRC_LENGTH - 2; i >= 0; i--)
-            {
-                if (checksums[i] == crc)
-                {
-                    bStuckInLoop = millis();
-                    debugW("Seed: %10lu, Generations: %5d, %s", seed, cGeneration, cGeneration > 3000 ? "Y" : "N");
-                }
-                if (checksums[i] == 0xFFFFFFF)
-                    break;
-            }
+            bStuckInLoop = millis();
+            debugW("Seed: %10lu, Generations: %5d, %s", seed, cGeneration, cGeneration > 3000 ? "Y" : "N");
         }
 
-        // Birth and death cycle
-        for (int x = 0; x < MATRIX_WIDTH; x++) {
-            for (int y = 0; y < MATRIX_HEIGHT; y++) {
-                // Default is for cell to stay the same
-                if (world[x][y].brightness > 0 && world[x][y].prev == 0)
-                  world[x][y].brightness *= 0.75;
-
-                int count = neighbours(x, y);
-                if (count == 3 && world[x][y].prev == 0) {
-                    // A new cell is born
-                    world[x][y].alive = 1;
-                    world[x][y].hue += 1;
-                    world[x][y].brightness = 255;
-                } else if ((count < 2 || count > 3) && world[x][y].prev == 1) {
-                    // Cell dies
-                    world[x][y].alive = 0;
-                    world[x][y].brightness = 0;
-                }
-            }
-        }
+        // Birth and death cycle. The world works out the next generation; we then compare it word by word with
+        // the one before to fade out dead cells and light up new ones.
+
+        world->Step();
+
+        const uint32_t tailMask = MATRIX_WIDTH % 32 ? (1u << (MATRIX_WIDTH % 32)) - 1 : UINT32_MAX;
+
+        for (int y = 0; y < MATRIX_HEIGHT; y++) {
+            const uint32_t * previous = world->PreviousRow(y);
+            const uint32_t * current  = world->Row(y);
+
+            for (size_t k = 0; k < world->WordsPerRow(); k++) {
+                const int firstX = k * 32;
+                const uint32_t mask = k + 1 == world->WordsPerRow() ? tailMask : UINT32_MAX;
 
-        // Copy next generation into place
+                // Cells that were dead fade out a little more
+                ForEachCell(~previous[k] & mask, firstX, [&](int x) {
+                    auto& look = Look(x, y);
+                    look.brightness = look.brightness * 3 / 4;
+                });
 
-        int cCount = 0;
+                // A new cell is born
+                ForEachCell(current[k] & ~previous[k], firstX, [&](int x) {
+                    auto& look = Look(x, y);
+                    look.hue += 1;
+                    look.brightness = 255;
+                });
 
-        for (int x = 0; x < MATRIX_WIDTH; x++) {
-            for (int y = 0; y < MATRIX_HEIGHT; y++) {
-                if (world[x][y].prev != world[x][y].alive)
-                    cCount++;
-                world[x][y].prev = world[x][y].alive;
+                // Cell dies
+                ForEachCell(previous[k] & ~current[k], firstX, [&](int x) {
+                    Look(x, y).brightness = 0;
+                });
             }
         }
 
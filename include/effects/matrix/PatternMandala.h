@@ -108,7 +108,7 @@ public:
         return 30;
     }
 
-    bool RequiresDoubleBuffering() const override
+    std::optional<bool> RequiresDoubleBuffering() const override
     {
         return true;
     }
@@ -165,17 +165,19 @@ public:
     // show just one layer
     void ShowNoiseLayer(uint8_t layer, uint8_t colorrepeat, uint8_t colorshift)
     {
-        for (uint16_t i = 0; i < MATRIX_WIDTH; i++)
+        const CRGBPalette16 & palette = g()->GetCurrentPalette();
+
+        for (uint16_t j = 0; j < MATRIX_HEIGHT; j++)
         {
-            for (uint16_t j = 0; j < MATRIX_HEIGHT; j++)
+            for (uint16_t i = 0; i < MATRIX_WIDTH; i++)
             {
 
-                uint8_t color = g()->GetNoise().noise[i][j];
+                uint8_t color = g()->GetNoise().noise[j][i];
 
                 uint8_t bri = color;
 
                 // assign a color depending on the actual palette
-                CRGB pixel = ColorFromPalette(g()->GetCurrentPalette(), colorrepeat * (color + colorshift), bri);
+                CRGB pixel = ColorFromPalette(palette, colorrepeat * (color + colorshift), bri);
 
                 g()->leds[XY(i, j)] = pixel;
             }
@@ -116,7 +116,7 @@ class PatternRose : public LEDStripEffect
         return 60;
     }
 
-    bool RequiresDoubleBuffering() const override
+    std::optional<bool> RequiresDoubleBuffering() const override
     {
         return true;
     }
@@ -279,7 +279,7 @@ public:
         return 16;
     }
 
-    bool RequiresDoubleBuffering() const override
+    std::optional<bool> RequiresDoubleBuffering() const override
     {
         return false;
     }
@@ -108,7 +108,7 @@ class PatternPongClock : public LEDStripEffect
         return 35;
     }
 
-    bool RequiresDoubleBuffering() const override
+    std::optional<bool> RequiresDoubleBuffering() const override
     {
         return false;
     }
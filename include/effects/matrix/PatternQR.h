@@ -48,6 +48,7 @@ protected:
     QRCode qrcode;
     uint8_t * qrcodeData = nullptr;
     const int qrVersion = 2;
+    bool needsRedraw = true;
 
 public:
 
@@ -63,11 +64,18 @@ public:
 
     virtual ~PatternQR()
     {
-        free(qrcodeData);
+        PreferPSRAMFree(qrcodeData);
     }
 
     void Start() override
     {
+        needsRedraw = true;
+    }
+
+    // The code only changes with our address, so most frames draw nothing at all
+    bool TracksDirtyRegion() const override
+    {
+        return true;
     }
 
     size_t DesiredFramesPerSecond() const override
@@ -82,7 +90,13 @@ public:
         {
             lastData = sIP;
             qrcode_initText(&qrcode, qrcodeData, qrVersion, ECC_LOW, sIP.c_str());
+            needsRedraw = true;
         }
+
+        if (!needsRedraw)
+            return;
+        needsRedraw = false;
+
         g()->fillScreen(g()->to16bit(CRGB::DarkBlue));
         const int leftMargin = MATRIX_CENTER_X - qrcode.size / 2;
         const int topMargin = 4;
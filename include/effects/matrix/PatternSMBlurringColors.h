@@ -69,20 +69,6 @@ class PatternSMBlurringColors : public LEDStripEffect
     uint8_t deltaValue; // just a reusable variable
     uint8_t step;       // some kind of frame or sequence counter
 
-    [[nodiscard]] CRGB getPixColorXY(uint8_t x, uint8_t y) const
-    {
-        return g()->leds[XY(x, MATRIX_HEIGHT - 1 - y)];
-    }
-
-    void drawPixelXY(uint8_t x, uint8_t y, CRGB color)
-    {
-        y = MATRIX_HEIGHT - 1 - y;
-        if (g()->isValidPixel(x, y)) {
-            uint32_t thisPixel = XY(x, y);
-            g()->leds[thisPixel] = color;
-        }
-    }
-
     static inline uint8_t WU_WEIGHT(uint8_t a, uint8_t b)
     {
         return (uint8_t)(((a) * (b) + (a) + (b)) >> 8);
@@ -96,16 +82,16 @@ class PatternSMBlurringColors : public LEDStripEffect
         uint8_t wu[4] = {WU_WEIGHT(ix, iy), WU_WEIGHT(xx, iy), WU_WEIGHT(ix, yy), WU_WEIGHT(xx, yy)};
         // Multiply the intensities by the colour, and saturating-add them
         // to the pixels.
+        auto frame = frameView();
         for (uint8_t i = 0; i < 4; i++)
         {
             int16_t xn = x + (i & 1), yn = y + ((i >> 1) & 1);
-            if (g()->isValidPixel(xn, yn) == false)
+            if (frame.Contains(xn, yn) == false)
                 continue;
-            CRGB clr = getPixColorXY(xn, yn);
+            CRGB& clr = frame(xn, MATRIX_HEIGHT - 1 - yn);
             clr.r = qadd8(clr.r, (color.r * wu[i]) >> 8);
             clr.g = qadd8(clr.g, (color.g * wu[i]) >> 8);
             clr.b = qadd8(clr.b, (color.b * wu[i]) >> 8);
-            drawPixelXY(xn, yn, clr);
         }
     }
 
@@ -229,16 +215,27 @@ class PatternSMBlurringColors : public LEDStripEffect
         }
     }
 
+    bool SupportsQualityScaling() const override
+    {
+        return true;
+    }
+
     void Draw() override
     {
         step = deltaValue; // counter of the number of particles in the
                            // queue for nucleation in this loop
         g()->blur2d(g()->leds, MATRIX_WIDTH, 0, MATRIX_HEIGHT, 0, 27);
 
+        // At lower quality levels we stop emitting into the tail of the pool, so the live particle count
+        // drops as the particles already out there burn out
+        const size_t emitCount = QualityScaled(powder_item_max_count, powder_item_max_count / 5);
+
         // go over particles and update matrix cells on the way
-        for (auto& powder_item : _powder_items)
+        for (size_t i = 0; i < _powder_items.size(); i++)
         {
-            if (!powder_item._is_shift && step)
+            auto& powder_item = _powder_items[i];
+
+            if (!powder_item._is_shift && step && i < emitCount)
             {
                 FountainsEmit(powder_item);
                 step--;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "effectmanager.h"
+#include "firekernel.h"
 
 // Derived from https://editor.soulmatelights.com/gallery/388-fire2021
 
@@ -17,6 +18,23 @@ class PatternSMFire2021 : public LEDStripEffect
 
     const TProgmemRGBPalette16 *curPalette;
 
+    FlameColorTables _flameColors;
+    uint32_t _flameColorsGeneration = 0;
+
+    // The flame colors come from the current palette, so we only work them out again after it has changed
+
+    void UpdateFlameColors()
+    {
+        if (_flameColors.IsBuilt() && _flameColorsGeneration == g()->PaletteGeneration())
+            return;
+
+        _flameColorsGeneration = g()->PaletteGeneration();
+        _flameColors.Build([this](byte Col, uint8_t Bri)
+        {
+            return GetBlackBodyHeatColor(Col/255.0f, g()->ColorFromCurrentPalette(0, Bri)).fadeToBlackBy(255-Bri);
+        });
+    }
+
   public:
     PatternSMFire2021() : LEDStripEffect(EFFECT_MATRIX_SMFIRE2021, "Fireplace")
     {
@@ -45,22 +63,18 @@ class PatternSMFire2021 : public LEDStripEffect
     void Draw() override
     {
         ff_x += step; // static uint32_t t += speed;
+        UpdateFlameColors();
         for (unsigned x = 0; x < MATRIX_WIDTH; x++)
         {
             for (unsigned y = 0; y < MATRIX_HEIGHT; y++)
             {
-                int16_t Bri = inoise8(x * deltaValue, (y * deltaValue) - ff_x, ff_z) - (y * (255 / MATRIX_HEIGHT));
-                byte Col = Bri; // inoise8(x * deltaValue, (y * deltaValue) - ff_x, ff_z) - (y * (255 / MATRIX_HEIGHT));
-                if (Bri < 0)
-                    Bri = 0;
-                if (Bri != 0)
-                    Bri = 256 - (Bri * 0.2);
+                int16_t heat = inoise8(x * deltaValue, (y * deltaValue) - ff_x, ff_z) - (y * (255 / MATRIX_HEIGHT));
 
                 // Get the flame color using the black body radiation approximation, but when the palette is paused
                 // we make flame in that base color instead of the normal red
                 // NightDriver mod - invert Y argument.
 
-                nblend(g()->leds[XY(x, MATRIX_HEIGHT - 1 - y)], GetBlackBodyHeatColor(Col/255.0f, g()->ColorFromCurrentPalette(0, Bri)).fadeToBlackBy(255-Bri), pcnt);
+                nblend(g()->leds[XY(x, MATRIX_HEIGHT - 1 - y)], _flameColors[heat], pcnt);
             }
         }
 
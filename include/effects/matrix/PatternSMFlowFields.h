@@ -19,24 +19,6 @@ class PatternSMFlowFields : public LEDStripEffect
     // it's supposed to be. it works with 50 but it's a little slow. on an
     // esp32 it looks pretty nice at that number 15 is a safe number
 
-    [[nodiscard]] CRGB getPixColorXY(uint8_t x, uint8_t y) const
-    {
-        y = MATRIX_HEIGHT - y;
-        if (!g()->isValidPixel(x, y))
-            return 0;
-        return g()->leds[XY(x, MATRIX_HEIGHT - 1 - y)];
-    }
-
-    void drawPixelXY(uint8_t x, uint8_t y, CRGB color)
-    {
-        y = MATRIX_HEIGHT - y;
-        if (!g()->isValidPixel(x, y))
-            return;
-        // Mesmerizer flips the Y axis here.
-        uint32_t thisPixel = XY((uint8_t)x, MATRIX_HEIGHT - 1 - (uint8_t)y);
-        g()->leds[thisPixel] = color;
-    }
-
     static inline uint8_t WU_WEIGHT(uint8_t a, uint8_t b)
     {
         return (uint8_t)(((a) * (b) + (a) + (b)) >> 8);
@@ -56,14 +38,18 @@ class PatternSMFlowFields : public LEDStripEffect
         // calculate the intensities for each affected pixel
         // #define WU_WEIGHT(a,b) ((uint8_t) (((a)*(b)+(a)+(b))>>8))
         std::array<uint8_t, 4> wu{WU_WEIGHT(ix, iy), WU_WEIGHT(xx, iy), WU_WEIGHT(ix, yy), WU_WEIGHT(xx, yy)};
+        auto frame = frameView();
         for (uint8_t i = 0; i < 4; i++)
         {
-            int16_t xn = x + (i & 1), yn = y + ((i >> 1) & 1);
-            CRGB clr = getPixColorXY(xn, yn);
+            // The original had y running from 1 at the bottom up to MATRIX_HEIGHT; with Mesmerizer's flipped Y
+            // axis that works out to frame row y - 1, and anything outside the frame is dropped
+            int16_t xn = x + (i & 1), yn = y + ((i >> 1) & 1) - 1;
+            if (!frame.Contains(xn, yn))
+                continue;
+            CRGB& clr = frame(xn, yn);
             clr.r = qadd8(clr.r, (color.r * wu[i]) >> 8);
             clr.g = qadd8(clr.g, (color.g * wu[i]) >> 8);
             clr.b = qadd8(clr.b, (color.b * wu[i]) >> 8);
-            drawPixelXY(xn, yn, clr);
         }
     }
 
@@ -100,10 +86,20 @@ class PatternSMFlowFields : public LEDStripEffect
         }
     }
 
+    bool SupportsQualityScaling() const override
+    {
+        return true;
+    }
+
     void Draw() override
     {
-        for (auto &boid : boids)
+        // At lower quality levels only the first part of the flock is moved and drawn
+        const size_t activeBoids = QualityScaled(boids.size(), NUM_PARTICLES / 4);
+
+        for (size_t i = 0; i < activeBoids; i++)
         {
+            auto &boid = boids[i];
+
             int ioffset = scale * boid.location.x;
             int joffset = scale * boid.location.y;
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "effectmanager.h"
+#include "polarmap.h"
 
 // Inspired by https://editor.soulmatelights.com/gallery/2272-hypnosis
 // Spiraling swirls of rotating colors.
@@ -11,11 +12,9 @@ class PatternSMHypnosis : public LEDStripEffect
     const uint8_t C_X = MATRIX_WIDTH / 2;
     const uint8_t C_Y = MATRIX_HEIGHT / 2;
     const uint8_t mapp = 255 / MATRIX_WIDTH;
-    struct
-    {
-        uint8_t angle;
-        uint8_t radius;
-    } rMap[MATRIX_WIDTH][MATRIX_HEIGHT];
+    std::shared_ptr<const PolarMap> _polarMap;
+
+    PaletteLUT _paletteLUT;
 
   public:
     PatternSMHypnosis() : LEDStripEffect(EFFECT_MATRIX_SMHYPNOSIS, "Hypnosis")
@@ -26,18 +25,15 @@ class PatternSMHypnosis : public LEDStripEffect
     {
     }
 
+    void Prepare() override
+    {
+        _polarMap = PolarMap::Get(C_X, C_Y, mapp); // thanks Sutaburosu
+    }
+
     void Start() override
     {
         g()->Clear();
-        for (int8_t x = -C_X; x < C_X + (MATRIX_WIDTH % 2); x++)
-        {
-            for (int8_t y = -C_Y; y < C_Y + (MATRIX_HEIGHT % 2); y++)
-            {
-                rMap[x + C_X][y + C_Y].angle = 128 * (atan2(y, x) / PI);
-                rMap[x + C_X][y + C_Y].radius = hypot(x, y) * mapp; // thanks
-                                                                    // Sutaburosu
-            }
-        }
+        _paletteLUT.Update(RainbowStripeColors_p);
     }
 
     uint16_t t = 0;
@@ -45,8 +41,11 @@ class PatternSMHypnosis : public LEDStripEffect
     void Draw() override
     {
         t += 4;
-        for (uint x = 0; x < MATRIX_WIDTH; x++)
-            for (uint y = 0; y < MATRIX_HEIGHT; y++)
-                g()->leds[XY(x, y)] = ColorFromPalette(RainbowStripeColors_p, t / 2 + rMap[x][y].radius + rMap[x][y].angle, sin8(rMap[x][y].angle + (rMap[x][y].radius * 2) - t));
+        for (uint y = 0; y < MATRIX_HEIGHT; y++)
+        {
+            const PolarCoord * row = _polarMap->Row(y);
+            for (uint x = 0; x < MATRIX_WIDTH; x++)
+                g()->leds[XY(x, y)] = _paletteLUT.Color(t / 2 + row[x].radius + row[x].angle, sin8(row[x].angle + (row[x].radius * 2) - t));
+        }
     }
 };
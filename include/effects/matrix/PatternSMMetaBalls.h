@@ -1,6 +1,8 @@
 #pragma once
 
+#include <array>
 #include "effectmanager.h"
+#include "metaballfield.h"
 
 // Derived from https://wokwi.com/projects/289218075224441356
 // N Glowing balls in orbit around each other around a rotating plane.
@@ -9,20 +11,15 @@
 class PatternSMMetaBalls : public LEDStripEffect
 {
   private:
-    uint8_t bx[5];
-    uint8_t by[5];
+    static constexpr size_t kBallCount = 5;
+    static constexpr uint8_t kBallStrength = 220;       // The glow right at the center of a ball
 
-    byte dist(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2)
-    {
-        int a = y2 - y1;
-        int b = x2 - x1;
-        a *= a;
-        b *= b;
-        //    byte dist = 220 / (sqrt16(a + b) + 1);
-        // Avoid a div/0 crash.
-        byte dist = 220 / (sqrt16(a + b + 1));
-        return dist;
-    }
+    uint8_t bx[kBallCount];
+    uint8_t by[kBallCount];
+
+    psram_unique_ptr<MetaballField> _field;
+    std::vector<uint8_t> _row;                          // One row of the field, padded out for MetaballField
+    std::array<CRGB, 256> _colors;                      // Color for each value of the field
 
   public:
     PatternSMMetaBalls() : LEDStripEffect(EFFECT_MATRIX_SMMETA_BALLS, "MetaBalls")
@@ -33,33 +30,60 @@ class PatternSMMetaBalls : public LEDStripEffect
     {
     }
 
+    // The field's tables stay with us once they're built, as they only depend on the size of the matrix
+    void Prepare() override
+    {
+        if (_field)
+            return;
+
+        _field = make_unique_psram<MetaballField>(MATRIX_WIDTH, MATRIX_HEIGHT, kBallStrength);
+        _row.resize(MATRIX_WIDTH + 4);
+
+        // HeatColors2_p peaks with blue instead of white and looks nicer for this effect
+        for (int sum = 0; sum < 256; sum++)
+            _colors[sum] = ColorFromPalette(HeatColors2_p, sum + 220, 254, LINEARBLEND);
+    }
+
     void Start() override
     {
         g()->Clear();
     }
 
+    bool SupportsQualityScaling() const override
+    {
+        return true;
+    }
+
     void Draw() override
     {
-        for (uint8_t a = 0; a < 5; a++)
+        for (uint8_t a = 0; a < kBallCount; a++)
         {
             bx[a] = beatsin8(15 + a * 2, 0, MATRIX_WIDTH - 1, 0, a * 32);
             by[a] = beatsin8(18 + a * 2, 0, MATRIX_HEIGHT - 1, 0, a * 32);
         }
-        for (unsigned i = 0; i < MATRIX_WIDTH - 1; i++)
+
+        // Below full quality we evaluate the field once per 2x2 block, and at the lowest level we skip the blur too
+        const unsigned step = QualityLevel() < kMaxQualityLevel ? 2 : 1;
+
+        _field->SetBalls(bx, by, kBallCount, step);
+        auto& graphics = *g();
+
+        for (unsigned row = 0, j = 0; j < MATRIX_HEIGHT - 1; row++, j += step)
         {
-            for (unsigned j = 0; j < MATRIX_HEIGHT - 1; j++)
+            _field->FillRow(_row.data(), row);
+
+            for (unsigned column = 0, i = 0; i < MATRIX_WIDTH - 1; column++, i += step)
             {
-                byte sum = dist(i, j, bx[0], by[0]);
-                for (uint8_t a = 1; a < 5; a++)
-                {
-                    sum = qadd8(sum, dist(i, j, bx[a], by[a]));
-                }
-                // HeatColors2_p peaks with blue instead of white and looks nicer for this effect
-                g()->leds[XY(i, j)] = ColorFromPalette(HeatColors2_p, sum + 220, 254, LINEARBLEND);
+                CRGB color = _colors[_row[column]];
+
+                for (unsigned y = j; y < std::min(j + step, (unsigned)MATRIX_HEIGHT - 1); y++)
+                    for (unsigned x = i; x < std::min(i + step, (unsigned)MATRIX_WIDTH - 1); x++)
+                        graphics.leds[XY(x, y)] = color;
             }
         }
 
-        g()->blur2d(g()->leds, MATRIX_WIDTH - 1, 0, MATRIX_HEIGHT - 1, 0, 32);
+        if (QualityLevel() > 0)
+            graphics.blur2d(graphics.leds, MATRIX_WIDTH - 1, 0, MATRIX_HEIGHT - 1, 0, 32);
         fadeAllChannelsToBlackBy(10);
     }
 };
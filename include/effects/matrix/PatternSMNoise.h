@@ -1,6 +1,7 @@
 #pragma once
 
 #include "effectmanager.h"
+#include "noisefield.h"
 
 // Derived from https://editor.soulmatelights.com/gallery/1509-noise-palettes
 // Cycles through 17 effects of pallette noise, looking like a surreal topo.
@@ -403,6 +404,11 @@ class PatternSMNoise : public LEDStripEffect
         noisez = random16();
     }
 
+    bool SupportsQualityScaling() const override
+    {
+        return true;
+    }
+
     void Draw() override
     {
         static int prevmode = mode;
@@ -465,8 +471,9 @@ class PatternSMNoise : public LEDStripEffect
     // colors.
     uint16_t noisescale = 30; // scale is set dynamically once we've started up
 
-    // This is the array that we keep our computed noise values in
+    // This is the array that we keep our computed noise values in, a row per step along y
     uint8_t noise[MAX_DIMENSION][MAX_DIMENSION];
+    NoiseField noiseField{MAX_DIMENSION};
 
     uint8_t colorLoop = 0;
 
@@ -504,7 +511,8 @@ class PatternSMNoise : public LEDStripEffect
         }
     }
 
-    // Fill the x/y array of 8-bit noise values using the inoise8 function.
+    // Fill the x/y array of 8-bit noise values, a row at a time. The values are the top byte of inoise16() at
+    // our 8-bit coordinates scaled up, which takes the same shape as inoise8() at a little more precision.
     void fillnoise8()
     {
         // If we're runing at a low "speed", some 8-bit artifacts become visible
@@ -519,31 +527,34 @@ class PatternSMNoise : public LEDStripEffect
             dataSmoothing = 200 - (lowestNoise * 4);
         }
 
-        for (int i = 0; i < MAX_DIMENSION; i++)
-        {
-            int ioffset = noisescale * i;
-            for (int j = 0; j < MAX_DIMENSION; j++)
-            {
-                int joffset = noisescale * j;
-
-                uint8_t data = inoise8(noisex + ioffset, noisey + joffset, noisez);
-
-                // The range of the inoise8 function is roughly 16-238.
-                // These two operations expand those values out to roughly 0..255
-                // You can comment them out if you want the raw noise data.
-                data = qsub8(data, 16);
-                data = qadd8(data, scale8(data, 39));
-
-                if (dataSmoothing)
-                {
-                    uint8_t olddata = noise[i][j];
-                    uint8_t newdata = scale8(olddata, dataSmoothing) + scale8(data, 256 - dataSmoothing);
-                    data = newdata;
-                }
-
-                noise[i][j] = data;
-            }
-        }
+        // Below full quality we only work out every other row and column, and fill in the ones in between
+        const bool halfResolution = QualityLevel() < kMaxQualityLevel;
+
+        noiseField.Fill(MAX_DIMENSION,
+                        (uint32_t) noisex << 8, (uint32_t) noisescale << 8,
+                        (uint32_t) noisey << 8, (uint32_t) noisescale << 8,
+                        (uint32_t) noisez << 8,
+                        halfResolution,
+                        [&](size_t j, const uint8_t * fresh)
+                        {
+                            for (int i = 0; i < MAX_DIMENSION; i++)
+                            {
+                                // The range of the noise is roughly 16-238.
+                                // These two operations expand those values out to roughly 0..255
+                                // You can comment them out if you want the raw noise data.
+                                uint8_t data = qsub8(fresh[i], 16);
+                                data = qadd8(data, scale8(data, 39));
+
+                                if (dataSmoothing)
+                                {
+                                    uint8_t olddata = noise[j][i];
+                                    uint8_t newdata = scale8(olddata, dataSmoothing) + scale8(data, 256 - dataSmoothing);
+                                    data = newdata;
+                                }
+
+                                noise[j][i] = data;
+                            }
+                        });
 
         noisex += noisespeedx;
         noisey += noisespeedy;
@@ -560,10 +571,11 @@ class PatternSMNoise : public LEDStripEffect
             {
                 // We use the value at the (i,j) coordinate in the noise
                 // array for our brightness, and the flipped value from (j,i)
-                // for our pixel's index into the color palette.
+                // for our pixel's index into the color palette. The array
+                // is stored a row per y, so (i,j) is at noise[j][i].
 
-                uint8_t index = noise[j][i];
-                uint8_t bri = noise[i][j];
+                uint8_t index = noise[i][j];
+                uint8_t bri = noise[j][i];
 
                 // if this palette is a 'loop', add a slowly-changing base value
                 if (colorLoop)
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "effectmanager.h"
+#include "firekernel.h"
+#include "polarmap.h"
 
 // Derived from https://editor.soulmatelights.com/gallery/1570-radialfire
 
@@ -10,9 +12,33 @@ class PatternSMRadialFire : public LEDStripEffect
 
     static auto constexpr C_X = (MATRIX_WIDTH / 2);
     static auto constexpr C_Y = (MATRIX_HEIGHT / 2);
-    // BUGBUG: should probably be dynamically allocated into non-DMAable RAM.
-    byte XY_angle[MATRIX_WIDTH][MATRIX_HEIGHT];
-    byte XY_radius[MATRIX_WIDTH][MATRIX_HEIGHT];
+    std::shared_ptr<const PolarMap> _polarMap;
+
+    FlameColorTables _flameColors;
+    uint32_t _flameColorsGeneration = 0;
+    bool _flameColorsPaused = false;
+
+    // The flame colors depend on the palette and on whether it's paused, so we only work them out again after
+    // one of those has changed
+
+    void UpdateFlameColors()
+    {
+        auto& graphics = *g();
+        if (_flameColors.IsBuilt()
+            && _flameColorsGeneration == graphics.PaletteGeneration()
+            && _flameColorsPaused == graphics.IsPalettePaused())
+            return;
+
+        _flameColorsGeneration = graphics.PaletteGeneration();
+        _flameColorsPaused = graphics.IsPalettePaused();
+
+        // If the palette is paused, we use it to color the fire, otherwise we just use red
+        _flameColors.Build([&](byte Col, uint8_t Bri)
+        {
+            return GetBlackBodyHeatColor(Col/255.0f, _flameColorsPaused ? graphics.ColorFromCurrentPalette(Col) : CRGB::Red)
+                .fadeToBlackBy(255-Bri);
+        });
+    }
 
   public:
     PatternSMRadialFire() : LEDStripEffect(EFFECT_MATRIX_SMRADIAL_FIRE, "RadialFire")
@@ -23,17 +49,17 @@ class PatternSMRadialFire : public LEDStripEffect
     {
     }
 
+    // Building the polar map is the expensive part, so we do it in Prepare(), which normally runs in the background.
+    // It's shared with the other radial effects, so it's usually already there.
+
+    void Prepare() override
+    {
+        _polarMap = PolarMap::Get(C_X, C_Y); // thanks Sutaburosu
+    }
+
     void Start() override
     {
         g()->Clear();
-        for (int8_t x = -C_X; x < C_X + (MATRIX_WIDTH % 2); x++)
-        {
-            for (int8_t y = -C_Y; y < C_Y + (MATRIX_HEIGHT % 2); y++)
-            {
-                XY_angle[x + C_X][y + C_Y] = 128 * (atan2(y, x) / PI);
-                XY_radius[x + C_X][y + C_Y] = hypot(x, y); // thanks Sutaburosu
-            }
-        }
     }
 
     void Draw() override
@@ -44,24 +70,16 @@ class PatternSMRadialFire : public LEDStripEffect
         static byte speed = 24;
         static uint32_t t;
         t += speed;
-        for (uint8_t x = 0; x < MATRIX_WIDTH; x++)
+        UpdateFlameColors();
+        for (uint8_t y = 0; y < MATRIX_HEIGHT; y++)
         {
-            for (uint8_t y = 0; y < MATRIX_HEIGHT; y++)
+            const PolarCoord * row = _polarMap->Row(y);
+            for (uint8_t x = 0; x < MATRIX_WIDTH; x++)
             {
-                byte angle = XY_angle[x][y];
-                byte radius = XY_radius[x][y];
-                int16_t Bri = inoise8(angle * scaleX, (radius * scaleY) - t) - radius * (255 / MATRIX_HEIGHT);
-                byte Col = Bri;
-                if (Bri < 0)
-                    Bri = 0;
-                if (Bri != 0)
-                    Bri = 256 - (Bri * 0.2);
-
-                // If the palette is paused, we use it to color the fire, otherwise we just use red
-                CRGB color = (GetBlackBodyHeatColor(Col/255.0f, g()->IsPalettePaused() ? 
-                                    g()->ColorFromCurrentPalette(Col) 
-                                  : CRGB::Red).fadeToBlackBy(255-Bri));
-                nblend(g()->leds[XY(x, y)], color, speed);
+                byte angle = row[x].angle;
+                byte radius = row[x].radius;
+                int16_t heat = inoise8(angle * scaleX, (radius * scaleY) - t) - radius * (255 / MATRIX_HEIGHT);
+                nblend(g()->leds[XY(x, y)], _flameColors[heat], speed);
             }
         }
     }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "effectmanager.h"
+#include "polarmap.h"
 
 // Derived from https://editor.soulmatelights.com/gallery/1090-radialwave
 // A three-veined swirl rotates and changes direction, looking like an exhaust.
@@ -16,12 +17,7 @@ class PatternSMRadialWave : public LEDStripEffect
     static constexpr int8_t C_X = MATRIX_WIDTH / 2;
     static constexpr int8_t C_Y = MATRIX_HEIGHT / 2;
     static constexpr uint8_t mapp = 255 / MATRIX_WIDTH;
-    // BUGBUG: should probably be allocated into slow RAM.
-    struct
-    {
-        uint8_t angle;
-        uint8_t radius;
-    } rMap[MATRIX_WIDTH][MATRIX_HEIGHT];
+    std::shared_ptr<const PolarMap> _polarMap;
 
   public:
     PatternSMRadialWave() : LEDStripEffect(EFFECT_MATRIX_SMRADIAL_WAVE, "RadialWave")
@@ -32,18 +28,14 @@ class PatternSMRadialWave : public LEDStripEffect
     {
     }
 
+    void Prepare() override
+    {
+        _polarMap = PolarMap::Get(C_X, C_Y, mapp); // thanks Sutaburosu
+    }
+
     void Start() override
     {
         g()->Clear();
-        for (int8_t x = -C_X; x < C_X + (MATRIX_WIDTH % 2); x++)
-        {
-            for (int8_t y = -C_Y; y < C_Y + (MATRIX_HEIGHT % 2); y++)
-            {
-                rMap[x + C_X][y + C_Y].angle = 128 * (atan2(y, x) / PI);
-                rMap[x + C_X][y + C_Y].radius = hypot(x, y) * mapp; // thanks
-                                                                    // Sutaburosu
-            }
-        }
     }
 
     void Draw() override
@@ -51,12 +43,13 @@ class PatternSMRadialWave : public LEDStripEffect
         static byte speed = 1;
         static uint32_t t;
         t += speed;
-        for (uint8_t x = 0; x < MATRIX_WIDTH; x++)
+        for (uint8_t y = 0; y < MATRIX_HEIGHT; y++)
         {
-            for (uint8_t y = 0; y < MATRIX_HEIGHT; y++)
+            const PolarCoord * row = _polarMap->Row(y);
+            for (uint8_t x = 0; x < MATRIX_WIDTH; x++)
             {
-                byte angle = rMap[x][y].angle;
-                byte radius = rMap[x][y].radius;
+                byte angle = row[x].angle;
+                byte radius = row[x].radius;
                 g()->leds[XY(x, y)] = CHSV(t + radius, 255, sin8(t * 4 + sin8(t * 4 - radius) + angle * 3));
             }
         }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "effectmanager.h"
+#include "polarmap.h"
 
 // Inspired by https://editor.soulmatelights.com/gallery/1620-rainbow-tunel
 // Like Hypnosis, a swirling radial rainbow, but entering a black hole.
@@ -16,11 +17,7 @@ class PatternSMRainbowTunnel : public LEDStripEffect
     static constexpr uint8_t C_Y = MATRIX_HEIGHT / 2;
     static constexpr uint8_t mapp = 255 / MATRIX_WIDTH;
 
-    struct
-    {
-        uint8_t angle;
-        uint8_t radius;
-    } rMap[MATRIX_WIDTH][MATRIX_HEIGHT];
+    std::shared_ptr<const PolarMap> _polarMap;
 
   public:
     PatternSMRainbowTunnel() : LEDStripEffect(EFFECT_MATRIX_SMRAINBOW_TUNNEL, "Colorspin")
@@ -31,18 +28,14 @@ class PatternSMRainbowTunnel : public LEDStripEffect
     {
     }
 
+    void Prepare() override
+    {
+        _polarMap = PolarMap::Get(C_X, C_Y, mapp); // thanks Sutaburosu
+    }
+
     void Start() override
     {
         g()->Clear();
-        for (int8_t x = -C_X; x < C_X + (MATRIX_WIDTH % 2); x++)
-        {
-            for (int8_t y = -C_Y; y < C_Y + (MATRIX_HEIGHT % 2); y++)
-            {
-                rMap[x + C_X][y + C_Y].angle = 128 * (atan2(y, x) / PI);
-                rMap[x + C_X][y + C_Y].radius = hypot(x, y) * mapp; // thanks
-                                                                    // Sutaburosu
-            }
-        }
     }
 
     void Draw() override
@@ -54,12 +47,13 @@ class PatternSMRainbowTunnel : public LEDStripEffect
         static uint16_t t;
 
         t += speed;
-        for (uint8_t x = 0; x < MATRIX_WIDTH; x++)
+        for (uint8_t y = 0; y < MATRIX_HEIGHT; y++)
         {
-            for (uint8_t y = 0; y < MATRIX_HEIGHT; y++)
+            const PolarCoord * row = _polarMap->Row(y);
+            for (uint8_t x = 0; x < MATRIX_WIDTH; x++)
             {
-                byte angle = rMap[x][y].angle;
-                byte radius = rMap[x][y].radius;
+                byte angle = row[x].angle;
+                byte radius = row[x].radius;
                 g()->leds[XY(x, y)] =
                     CHSV((angle * scaleX) - t + (radius * scaleY), 255, constrain(radius * 3, 0, 255));
             }
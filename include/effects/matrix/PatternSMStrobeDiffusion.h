@@ -68,6 +68,7 @@ class PatternSMStrobeDiffusion : public LEDStripEffect
     {
         static int ct;
         ct++;
+        auto frame = frameView();
         // Scroll existing snowflakes down the screen.
         for (uint8_t x = 0U; x < MATRIX_WIDTH; x++)
         {
@@ -80,7 +81,7 @@ class PatternSMStrobeDiffusion : public LEDStripEffect
                 noise3d[x][y] = noise3d[x][y - 1];
                 if (noise3d[x][y] > 0)
                 {
-                    g()->drawPixel(x, y, CHSV(170, 5U, 127 + random8(128)));
+                    frame(x, y) = CHSV(170, 5U, 127 + random8(128));
                 }
             }
         }
@@ -160,28 +161,29 @@ class PatternSMStrobeDiffusion : public LEDStripEffect
         const uint8_t rows = (MATRIX_HEIGHT + 1) / 3U;
         uint8_t deltaHue = floor(Speed / 64) * 64;
         bool dir = false;
+        auto frame = frameView();
         for (uint8_t y = 0; y < rows; y++)
         {
             if (dir)
             {
                 if ((step % STEP) == 0)
                 { // small layers
-                    g()->drawPixel(MATRIX_WIDTH - 1, y * 3 + DELTA, CHSV(step, 255U, 255U));
+                    frame.TrySet(MATRIX_WIDTH - 1, y * 3 + DELTA, CHSV(step, 255U, 255U));
                 }
                 else
                 {
-                    g()->drawPixel(MATRIX_WIDTH - 1, y * 3 + DELTA, CHSV(170U, 255U, 1U));
+                    frame.TrySet(MATRIX_WIDTH - 1, y * 3 + DELTA, CHSV(170U, 255U, 1U));
                 }
             }
             else
             {
                 if ((step % STEP) == 0)
                 { // big layers
-                    g()->drawPixel(0, y * 3 + DELTA, CHSV((step + deltaHue), 255U, 255U));
+                    frame.TrySet(0, y * 3 + DELTA, CHSV((step + deltaHue), 255U, 255U));
                 }
                 else
                 {
-                    g()->drawPixel(0, y * 3 + DELTA, CHSV(0U, 255U, 0U));
+                    frame.TrySet(0, y * 3 + DELTA, CHSV(0U, 255U, 0U));
                 }
             }
 
@@ -190,11 +192,11 @@ class PatternSMStrobeDiffusion : public LEDStripEffect
             {
                 if (dir)
                 { // <==
-                    g()->drawPixel(x, y * 3 + DELTA, getPixColorXY(x, y * 3 + DELTA));
+                    frame.TrySet(x, y * 3 + DELTA, getPixColorXY(x, y * 3 + DELTA));
                 }
                 else
                 { // ==>
-                    g()->drawPixel(MATRIX_WIDTH - x, y * 3 + DELTA, getPixColorXY(MATRIX_WIDTH - x, y * 3 + DELTA));
+                    frame.TrySet(MATRIX_WIDTH - x, y * 3 + DELTA, getPixColorXY(MATRIX_WIDTH - x, y * 3 + DELTA));
                 }
             }
             dir = !dir;
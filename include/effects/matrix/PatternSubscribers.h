@@ -52,6 +52,7 @@ class PatternSubscribers : public LEDStripEffect
     CRGB backgroundColor                    = CRGB(0,16,64);
     CRGB borderColor                        = CRGB(160,160,255);
     bool guidUpdated                        = true;
+    bool needsRedraw                        = true;
     static std::vector<SettingSpec, psram_allocator<SettingSpec>> mySettingSpecs;
     size_t readerIndex                      = std::numeric_limits<size_t>::max();
 
@@ -120,6 +121,7 @@ class PatternSubscribers : public LEDStripEffect
         }
 
         subscribers = response.substring(startIndex, commaIndex).toInt();
+        needsRedraw = true;
 
         debugI("Got YouTube subscriber count for channel %s (GUID %s)", youtubeChannelName.c_str(), youtubeChannelGuid.c_str());
 
@@ -206,11 +208,22 @@ class PatternSubscribers : public LEDStripEffect
         return jsonObject.set(jsonDoc.as<JsonObjectConst>());
     }
 
-    bool RequiresDoubleBuffering() const override
+    std::optional<bool> RequiresDoubleBuffering() const override
     {
         return true;            // BUGBUG Flickers without this, but should NOT need it?
     }
 
+    // We draw straight into the matrix back buffer, so when we do draw we mark the whole frame dirty ourselves
+    bool TracksDirtyRegion() const override
+    {
+        return true;
+    }
+
+    void Start() override
+    {
+        needsRedraw = true;
+    }
+
     bool Init(std::vector<std::shared_ptr<GFXBase>>& gfx) override
     {
         if (!LEDStripEffect::Init(gfx))
@@ -223,6 +236,11 @@ class PatternSubscribers : public LEDStripEffect
 
     void Draw() override
     {
+        if (!needsRedraw)
+            return;
+        needsRedraw = false;
+        g()->MarkAllDirty();
+
         LEDMatrixGFX::backgroundLayer.fillScreen(rgb24(backgroundColor.r, backgroundColor.g, backgroundColor.b));
         LEDMatrixGFX::backgroundLayer.setFont(font5x7);
 
@@ -279,6 +297,8 @@ class PatternSubscribers : public LEDStripEffect
     // Extension override to accept our settings on top of those known by LEDStripEffect
     bool SetSetting(const String& name, const String& value) override
     {
+        needsRedraw = true;
+
         RETURN_IF_SET(name, NAME_OF(youtubeChannelGuid), youtubeChannelGuid, value);
         RETURN_IF_SET(name, NAME_OF(youtubeChannelName), youtubeChannelName, value);
         RETURN_IF_SET(name, NAME_OF(backgroundColor), backgroundColor, value);
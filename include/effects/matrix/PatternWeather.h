@@ -169,7 +169,7 @@ private:
      * 
      * @return bool - false No double buffering needed
      */
-    bool RequiresDoubleBuffering() const override
+    std::optional<bool> RequiresDoubleBuffering() const override
     {
         return false;
     }
@@ -108,7 +108,7 @@ class InsulatorSpectrumEffect : public LEDStripEffect, public BeatEffectBase, pu
         // REVIEW(davepl) This might look interesting if it didn't erase...
         bool bFlash = g_Analyzer._VURatio > 1.99 && span > 1.9 && elapsed > 0.25;
 
-        _allParticles.push_back(SpinningPaletteRingParticle(iInsulator, 0, _Palette, 256.0/FAN_SIZE, 4, -0.5, RING_SIZE_0, 0, LINEARBLEND, true, 1.0, bFlash ? max(0.12f, elapsed/8) : 0));
+        SpinningPaletteRingParticle::Spawn(_allParticles, iInsulator, 0, _Palette, 256.0/FAN_SIZE, 4, -0.5, RING_SIZE_0, 0, LINEARBLEND, true, 1.0, bFlash ? max(0.12f, elapsed/8) : 0);
     }
 };
 
@@ -197,6 +197,7 @@ class SpectrumAnalyzerEffect : public LEDStripEffect, virtual public VUMeterEffe
     uint8_t   _fadeRate;
 
     const CRGBPalette16 _palette;
+    PaletteLUT          _paletteLUT;            // Expanded version of _palette or the global colors, whichever we draw with
     bool                _ignoreGlobalColor;
     float               _peak1DecayRate;
     float               _peak2DecayRate;
@@ -208,7 +209,7 @@ class SpectrumAnalyzerEffect : public LEDStripEffect, virtual public VUMeterEffe
         return 60;
     }
 
-    virtual bool RequiresDoubleBuffering() const override
+    virtual std::optional<bool> RequiresDoubleBuffering() const override
     {
         return _fadeRate != 0;
     }
@@ -270,9 +271,12 @@ class SpectrumAnalyzerEffect : public LEDStripEffect, virtual public VUMeterEffe
         int yOffset   = pGFXChannel->height() - value ;
         int yOffset2  = pGFXChannel->height() - value2 ;
 
-        for (int y = yOffset2; y < pGFXChannel->height(); y++)
+        // Bars can be pushed past the top by the beat enhancement, and the bar widths add up to no more than the
+        // matrix width, so after clipping the top everything is on the matrix and can be set unchecked
+        auto frame = frameView();
+        for (int y = std::max(yOffset2, 0); y < pGFXChannel->height(); y++)
             for (int x = xOffset; x < xOffset + barWidth; x++)
-                g()->setPixel(x, y, baseColor);
+                frame(x, y) = baseColor;
 
         // We draw the highlight in white, but if its falling at a different rate than the bar itself,
         // it indicates a free-floating highlight, and those get faded out based on age
@@ -418,7 +422,7 @@ class SpectrumAnalyzerEffect : public LEDStripEffect, virtual public VUMeterEffe
             {
                 // We don't use the color offset when the palette is paused
                 int q = ::map(i, 0, _numBars, 0, 240);
-                DrawBar(i, pGFXChannel->ColorFromCurrentPalette(q % 240, 255, _scrollSpeed > 0 ? LINEARBLEND : NOBLEND));
+                DrawBar(i, pGFXChannel->ColorFromPaletteLUT(q % 240));
             }
             else
             {
@@ -429,8 +433,10 @@ class SpectrumAnalyzerEffect : public LEDStripEffect, virtual public VUMeterEffe
                 if (!_ignoreGlobalColor && deviceConfig.ApplyGlobalColors())
                     globalPalette = CRGBPalette16(deviceConfig.GlobalColor(), deviceConfig.SecondColor());
 
+                _paletteLUT.Update(globalPalette ? *globalPalette : _palette, _scrollSpeed > 0 ? LINEARBLEND : NOBLEND);
+
                 int q = ::map(i, 0, _numBars, 0, 255) + _colorOffset;
-                DrawBar(i, ColorFromPalette(globalPalette ? *globalPalette : _palette, (q) % 255, 255, _scrollSpeed > 0 ? LINEARBLEND : NOBLEND));
+                DrawBar(i, _paletteLUT.Color((q) % 255));
             }
         }
     }
@@ -574,7 +580,7 @@ class GhostWave : public WaveformEffect
         return jsonObject.set(jsonDoc.as<JsonObjectConst>());
     }
 
-    virtual bool RequiresDoubleBuffering() const override
+    virtual std::optional<bool> RequiresDoubleBuffering() const override
     {
         return true;
     }
@@ -667,7 +673,7 @@ class SpectrumBarEffect : public LEDStripEffect
         return 45;
     }
 
-    virtual bool RequiresDoubleBuffering() const override
+    virtual std::optional<bool> RequiresDoubleBuffering() const override
     {
         return true;
     }
@@ -34,7 +34,9 @@
 
 #include <cmath>
 #include "effects.h"
+#include "firekernel.h"
 #include "paletteeffect.h"
+#include "palettelut.h"
 #include "soundanalyzer.h"
 
 // Simple definitions of what direction we're talking about
@@ -669,6 +671,7 @@ public:
 class PaletteSpinEffect : public LEDStripEffect
 {
   const CRGBPalette16 _Palette;
+  PaletteLUT _PaletteLUT;
   bool _bReplaceMagenta;
   float _sparkleChance;
 
@@ -732,13 +735,15 @@ public:
 
   void DrawEffect()
   {
+    _PaletteLUT.Update(_Palette, NOBLEND);
+
     for (int i = 0; i < NUM_FANS; i++)
     {
       ClearFanPixels(0, FAN_SIZE, Sequential, i);
       for (int x = 0; x < FAN_SIZE; x++)
       {
         float q = fmod(ReelPos[i] + x, FAN_SIZE);
-        CRGB c = ColorFromPalette(_Palette, 255.0f * q / FAN_SIZE, 255, NOBLEND);
+        CRGB c = _PaletteLUT.Color(255.0f * q / FAN_SIZE);
         if (_bReplaceMagenta && c == CRGB(CRGB::Magenta))
           c = CRGB(CHSV(beatsin8(2, 0, 255), 255, 255));
         if (random_range(0.0f, 10.f) < _sparkleChance)
@@ -958,7 +963,8 @@ protected:
   bool bMulticolor; // If true each channel spoke will be a different color
   PixelOrder Order;
 
-  std::unique_ptr<uint8_t[]> abHeat; // Heat table to map temp to color
+  FireKernel abHeat; // Heat table to map temp to color
+  PaletteLUT _heatColors;
 
   // When diffusing the fire upwards, these control how much to blend in from the cells below (ie: downward neighbors)
   // You can tune these coefficients to control how quickly and smoothly the fire spreads
@@ -968,8 +974,6 @@ protected:
   static const uint8_t BlendNeighbor2 = 1; // 2
   static const uint8_t BlendNeighbor3 = 0; // 1
 
-  static const uint8_t BlendTotal = (BlendSelf + BlendNeighbor1 + BlendNeighbor2 + BlendNeighbor3);
-
   int CellCount() const { return LEDCount * CellsPerLED; }
 
 public:
@@ -999,7 +1003,7 @@ public:
   {
     if (bMirrored)
       LEDCount = LEDCount / 2;
-    abHeat.reset( psram_allocator<uint8_t>().allocate(CellCount()) );
+    abHeat.Resize(CellCount());
   }
 
   FireFanEffect(const JsonObjectConst& jsonObject)
@@ -1018,7 +1022,7 @@ public:
   {
     if (bMirrored)
       LEDCount = LEDCount / 2;
-    abHeat.reset( psram_allocator<uint8_t>().allocate(CellCount()) );
+    abHeat.Resize(CellCount());
   }
 
   bool SerializeToJSON(JsonObject& jsonObject) override
@@ -1045,9 +1049,10 @@ public:
     return jsonObject.set(jsonDoc.as<JsonObjectConst>());
   }
 
+  // Same as ColorFromPalette(Palette, temp, 255); DrawFire keeps the lookup table in step with the palette
   CRGB GetBlackBodyHeatColorByte(byte temp) const
   {
-    return ColorFromPalette(Palette, temp, 255);
+    return _heatColors.Color(temp);
   }
 
   void Draw() override
@@ -1063,26 +1068,23 @@ public:
 
   virtual void DrawFire(PixelOrder order = Sequential)
   {
-    // First cool each cell by a litle bit
+    FireRandom & rng = abHeat.Random();
+
+    abHeat.NewFrame();
+    _heatColors.Update(Palette);
+
+    // First cool each cell by a litle bit, more so when the music is quiet
 
     EVERY_N_MILLISECONDS(50)
     {
-      for (int i = 0; i < CellCount(); i++)
-      {
-        int coolingAmount = random(0, Cooling);
-        abHeat[i] = ::max(0.0, abHeat[i] - coolingAmount * (2.0 - g_Analyzer._VURatio));
-      }
+      float coolingFactor = std::clamp(2.0f - g_Analyzer._VURatio, 0.0f, 2.0f);
+      abHeat.Cool(Cooling, coolingFactor * 256);
     }
 
     EVERY_N_MILLISECONDS(20)
     {
       // Next drift heat up and diffuse it a little bit
-      for (int i = 0; i < CellCount(); i++)
-        abHeat[i] = min(255, (abHeat[i] * BlendSelf +
-                              abHeat[(i + 1) % CellCount()] * BlendNeighbor1 +
-                              abHeat[(i + 2) % CellCount()] * BlendNeighbor2 +
-                              abHeat[(i + 3) % CellCount()] * BlendNeighbor3) /
-                                 BlendTotal);
+      abHeat.DiffuseTowardStart<BlendSelf, BlendNeighbor1, BlendNeighbor2, BlendNeighbor3>();
     }
 
     // Randomly ignite new sparks down in the flame kernel
@@ -1091,10 +1093,10 @@ public:
     {
       for (int i = 0; i < Sparks; i++)
       {
-        if (random(255) < Sparking / 4 + Sparking * (g_Analyzer._VURatio / 2.0) * 0.5)
+        if (rng.Below(255) < Sparking / 4 + Sparking * (g_Analyzer._VURatio / 2.0) * 0.5)
         {
-          int y = CellCount() - 1 - random(SparkHeight * CellsPerLED);
-          abHeat[y] = abHeat[y] + random(50, 255); // Can roll over which actually looks good!
+          int y = CellCount() - 1 - rng.Below(SparkHeight * CellsPerLED);
+          abHeat[y] = abHeat[y] + rng.Between(50, 255); // Can roll over which actually looks good!
         }
       }
     }
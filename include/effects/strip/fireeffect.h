@@ -32,7 +32,9 @@
 #pragma once
 
 #include "globals.h"
+#include "firekernel.h"
 #include "musiceffect.h"
+#include "palettelut.h"
 #include "soundanalyzer.h"
 #include "systemcontainer.h"
 
@@ -40,7 +42,7 @@ class FireEffect : public LEDStripEffect
 {
     void construct()
     {
-        heat.reset( psram_allocator<uint8_t>().allocate(CellCount()) );
+        heat.Resize(CellCount());
     }
 
   protected:
@@ -53,7 +55,8 @@ class FireEffect : public LEDStripEffect
     bool    bReversed;          // If reversed we draw from 0 outwards
     bool    bMirrored;          // If mirrored we split and duplicate the drawing
 
-    std::unique_ptr<uint8_t []> heat;
+    FireKernel heat;
+    HeatColorTable _heatColors;
 
     // When diffusing the fire upwards, these control how much to blend in from the cells below (ie: downward neighbors)
     // You can tune these coefficients to control how quickly and smoothly the fire spreads
@@ -63,12 +66,22 @@ class FireEffect : public LEDStripEffect
     static const uint8_t BlendNeighbor2 = 2;       // 2
     static const uint8_t BlendNeighbor3 = 0;       // 1
 
-    static const uint8_t BlendTotal = (BlendSelf + BlendNeighbor1 + BlendNeighbor2 + BlendNeighbor3);
-
     static constexpr int _jsonSize = LEDStripEffect::_jsonSize + 128;
 
     int CellCount() const { return LEDCount * CellsPerLED; }
 
+    // Fills in the color for each heat value. The black body colors never change, so they're only worked out once.
+    virtual void UpdateHeatColors()
+    {
+        if (_heatColors.IsBuilt())
+            return;
+
+        _heatColors.Build([this](uint8_t temperature)
+        {
+            return GetBlackBodyHeatColor(temperature / (float)std::numeric_limits<uint8_t>::max());
+        });
+    }
+
   public:
 
     FireEffect(const String & strName, int ledCount = NUM_LEDS, int cellsPerLED = 1, int cooling = 20, int sparking = 100, int sparks = 3, int sparkHeight = 4,  bool breversed = false, bool bmirrored = false)
@@ -142,36 +155,29 @@ class FireEffect : public LEDStripEffect
     {
         for (int i = 0 ; i < Sparks * multiplier; i++)
         {
-            if (random(255) < Sparking)
+            if (heat.Random().Below(255) < Sparking)
             {
-                int y = CellCount() - 1 - random(SparkHeight * CellsPerLED);
-                heat[y] = random(200, 255);   // Can roll over which actually looks good!
+                int y = CellCount() - 1 - heat.Random().Below(SparkHeight * CellsPerLED);
+                heat[y] = heat.Random().Between(200, 255);   // Can roll over which actually looks good!
             }
         }
     }
 
     virtual void DrawFire()
     {
+        heat.NewFrame();
+
         // First cool each cell by a little bit
 
         EVERY_N_MILLISECONDS(50)
         {
-          for (int i = 0; i < CellCount(); i++)
-          {
-            int coolingAmount = random(0, Cooling);
-            heat[i] = ::max(0, heat[i] - coolingAmount);
-          }
+            heat.Cool(Cooling);
         }
 
         EVERY_N_MILLISECONDS(20)
         {
-          // Next drift heat up and diffuse it a little bit
-          for (int i = 0; i < CellCount(); i++)
-              heat[i] = std::min(255, (heat[i] * BlendSelf +
-                        heat[(i + 1) % CellCount()] * BlendNeighbor1 +
-                        heat[(i + 2) % CellCount()] * BlendNeighbor2 +
-                        heat[(i + 3) % CellCount()] * BlendNeighbor3)
-                        / BlendTotal);
+            // Next drift heat up and diffuse it a little bit
+            heat.DiffuseTowardStart<BlendSelf, BlendNeighbor1, BlendNeighbor2, BlendNeighbor3>();
         }
 
         // Randomly ignite new sparks down in the flame kernel
@@ -183,6 +189,10 @@ class FireEffect : public LEDStripEffect
 
         // Finally, convert heat to a color
 
+        #if !LANTERN
+            UpdateHeatColors();
+        #endif
+
         for (int i = 0; i < LEDCount; i++)
         {
             auto sum = 0;
@@ -193,7 +203,7 @@ class FireEffect : public LEDStripEffect
             #if LANTERN
                 CRGB color = CRGB(avg, avg * .45, avg * .08);
             #else
-                CRGB color = GetBlackBodyHeatColor(avg/(float)std::numeric_limits<uint8_t>::max());
+                CRGB color = _heatColors[avg];
             #endif
 
             // If we're reversed, we work from the end back.  We don't reverse the bonus pixels
@@ -210,12 +220,39 @@ class PaletteFlameEffect : public FireEffect
 {
     CRGBPalette16 _palette;
     bool _ignoreGlobalColor;
+    CRGBPalette16 _heatColorsPalette;      // Palette the heat colors were last built from
 
     void construct()
     {
         _effectNumber = EFFECT_STRIP_PALETTE_FLAME;
     }
 
+    // The palette we draw from, which is built from the global color if that's being applied
+    CRGBPalette16 HeatPalette() const
+    {
+        auto& deviceConfig = g_ptrSystem->DeviceConfig();
+        if (deviceConfig.ApplyGlobalColors() && !_ignoreGlobalColor)
+            return CRGBPalette16(CRGB::Black, deviceConfig.GlobalColor(), CRGB::Yellow, CRGB::White);
+
+        return _palette;
+    }
+
+  protected:
+
+    // The global color can change at any time, so the heat colors are rebuilt whenever the palette has changed
+    void UpdateHeatColors() override
+    {
+        auto palette = HeatPalette();
+        if (_heatColors.IsBuilt() && palette == _heatColorsPalette)
+            return;
+
+        _heatColorsPalette = palette;
+        _heatColors.Build([this](uint8_t temperature)
+        {
+            return GetBlackBodyHeatColor(temperature / (float)std::numeric_limits<uint8_t>::max());
+        });
+    }
+
 public:
     PaletteFlameEffect(const String & strName,
                        const CRGBPalette16 &palette,
@@ -262,17 +299,7 @@ public:
     {
         temp = min(1.0f, temp);
         int index = fmap(temp, 0.0f, 1.0f, 0.0f, 240.0f);
-        auto& deviceConfig = g_ptrSystem->DeviceConfig();
-        if (deviceConfig.ApplyGlobalColors() && !_ignoreGlobalColor)
-        {
-            auto tempPalette = CRGBPalette16(CRGB::Black, deviceConfig.GlobalColor(), CRGB::Yellow, CRGB::White);
-            return ColorFromPalette(tempPalette, index, 255);
-        }
-        else
-            return ColorFromPalette(_palette, index, 255);
-
-        //        uint8_t heatramp = (uint8_t)(t192 & 0x3F);
-        //        heatramp <<=2;
+        return ColorFromPalette(HeatPalette(), index, 255);
     }
 };
 
@@ -341,6 +368,9 @@ class ClassicFireEffect : public LEDStripEffect
     bool _Reversed;
     int  _Cooling;
 
+    FireKernel _heat;
+    HeatColorTable _heatColors;
+
 public:
 
     ClassicFireEffect(bool mirrored = false, bool reversed = false, int cooling = 5)
@@ -375,6 +405,16 @@ public:
         return jsonObject.set(jsonDoc.as<JsonObjectConst>());
     }
 
+    bool Init(std::vector<std::shared_ptr<GFXBase>>& gfx) override
+    {
+        if (!LEDStripEffect::Init(gfx))
+            return false;
+
+        _heat.Resize(_cLEDs);
+        _heatColors.Build(HeatRampColor);
+        return true;
+    }
+
     void Draw() override
     {
         Fire(_Cooling, 180, 5);
@@ -383,43 +423,31 @@ public:
 
     void Fire(int Cooling, int Sparking, int Sparks)
     {
-        static std::unique_ptr<uint8_t []> heat = make_unique_psram_array<uint8_t>(NUM_LEDS);
+        FireRandom & rng = _heat.Random();
+
+        _heat.NewFrame();
         setAllOnAllChannels(0,0,0);
 
-        // Step 1.  Cool down every cell a little
-        for (int i = 0; i < _cLEDs; i++)
-        {
-            int cooldown = random_range(0, Cooling);
-            if (cooldown > heat[i])
-            {
-                heat[i] = 0;
-            }
-            else
-            {
-                heat[i] = heat[i] - cooldown;
-            }
-        }
+        // Step 1.  Cool down every cell a little (by up to Cooling inclusive)
+        _heat.Cool(Cooling + 1);
 
         // Step 2.  Heat from each cell drifts 'up' and diffuses a little
-        for (int k = _cLEDs - 1; k >= 3; k--)
-        {
-            heat[k] = (heat[k - 1] + heat[k - 2] + heat[k - 3]) / 3;
-        }
+        _heat.DiffuseTowardEnd();
 
         // Step 3.  Randomly ignite new 'sparks' near the bottom
         for (int frame = 0; frame < Sparks; frame++)
         {
-            if (random(255) < Sparking)
+            if (rng.Below(255) < Sparking)
             {
-                int y = random(5);
-                heat[y] = heat[y] + random(160, 255); // This randomly rolls over sometimes of course, and that's essential to the effect
+                int y = rng.Below(5);
+                _heat[y] = _heat[y] + rng.Between(160, 255); // This randomly rolls over sometimes of course, and that's essential to the effect
             }
         }
 
         // Step 4.  Convert heat to LED colors
         for (int j = 0; j < _cLEDs; j++)
         {
-            setPixelHeatColor(j, heat[j]);
+            setPixelHeatColor(j, _heat[j]);
         }
     }
 
@@ -444,26 +472,7 @@ public:
 
     void setPixelHeatColor(int Pixel, uint8_t temperature)
     {
-        // Scale 'heat' down from 0-255 to 0-191
-        uint8_t t192 = round((temperature / 255.0) * 191);
-
-        // calculate ramp up from
-        uint8_t heatramp = t192 & 0x3F; // 0..63
-        heatramp <<= 2;              // scale up to 0..252
-
-        // figure out which third of the spectrum we're in:
-        if (t192 > 0x80)
-        { // hottest
-            setPixelWithMirror(Pixel, CRGB(255, 255, heatramp));
-        }
-        else if (t192 > 0x40)
-        { // middle
-            setPixelWithMirror(Pixel, CRGB(255, heatramp, 0));
-        }
-        else
-        { // coolest
-            setPixelWithMirror(Pixel, CRGB(heatramp, 0, 0));
-        }
+        setPixelWithMirror(Pixel, _heatColors[temperature]);
     }
 
 
@@ -482,6 +491,7 @@ private:
     bool _Mirrored;
 
     float * _Temperatures = nullptr;
+    PaletteLUT _heatColors;
 
 public:
     // Parameter:   Cooling   Sparks    driftPasses  drift sparkHeight   Turbo
@@ -558,7 +568,7 @@ public:
 
     ~SmoothFireEffect()
     {
-        free(_Temperatures);
+        PreferPSRAMFree(_Temperatures);
     }
 
     void Draw() override
@@ -609,9 +619,11 @@ public:
             }
         }
 
+        // Same colors as GetBlackBodyHeatColor, from the lookup table
+        _heatColors.Update(HeatColors_p);
         for (uint j = 0; j < _cLEDs; j++)
         {
-            CRGB c = GetBlackBodyHeatColor(_Temperatures[j]);
+            CRGB c = _heatColors.Color(255 * min(_Temperatures[j], 1.0f));
             setPixelWithMirror(j, c);
         }
     }
@@ -632,7 +644,7 @@ class BaseFireEffect : public LEDStripEffect
 {
     void construct()
     {
-        heat = std::make_unique<uint8_t []>(CellCount);
+        heat.Resize(CellCount);
     }
 
   protected:
@@ -646,7 +658,7 @@ class BaseFireEffect : public LEDStripEffect
     int     LEDCount;           // Number of LEDs total
     int     CellCount;          // How many heat cells to represent entire flame
 
-    std::unique_ptr<uint8_t []> heat;
+    FireKernel heat;
 
     // When diffusing the fire upwards, these control how much to blend in from the cells below (ie: downward neighbors)
     // You can tune these coefficients to control how quickly and smoothly the fire spreads
@@ -656,8 +668,6 @@ class BaseFireEffect : public LEDStripEffect
     static const uint8_t BlendNeighbor2 = 2;       // 2
     static const uint8_t BlendNeighbor3 = 0;       // 1
 
-    static const uint8_t BlendTotal = (BlendSelf + BlendNeighbor1 + BlendNeighbor2 + BlendNeighbor3);
-
   public:
 
     BaseFireEffect(int ledCount, int cellsPerLED = 1, int cooling = 20, int sparking = 100, int sparks = 3, int sparkHeight = 4, bool breversed = false, bool bmirrored = false)
@@ -716,20 +726,7 @@ class BaseFireEffect : public LEDStripEffect
 
     virtual CRGB MapHeatToColor(uint8_t temperature)
     {
-        uint8_t t192 = round((temperature/255.0)*191);
-
-        // calculate ramp up from
-        uint8_t heatramp = t192 & 0x3F; // 0..63
-        heatramp <<= 2; // scale up to 0..252
-
-        // figure out which third of the spectrum we're in:
-        if( t192 > 0x80) {                     // hottest
-            return CRGB(255, 255, heatramp);
-        } else if( t192 > 0x40 ) {             // middle
-            return CRGB( 255, heatramp, 0);
-        } else {                               // coolest
-            return CRGB( heatramp, 0, 0);
-        }
+        return HeatRampColor(temperature);
     }
 
     void Draw() override
@@ -743,26 +740,24 @@ class BaseFireEffect : public LEDStripEffect
 
     virtual void DrawFire()
     {
+        FireRandom & rng = heat.Random();
+
+        heat.NewFrame();
+
         // First cool each cell by a little bit
-        for (int i = 0; i < CellCount; i++)
-            heat[i] = max(0L, heat[i] - random(0, ((Cooling * 10) / CellCount) + 2));
+        heat.Cool(((Cooling * 10) / CellCount) + 2);
 
         // Next drift heat up and diffuse it a little bit
-        for (int i = 0; i < CellCount; i++)
-            heat[i] = min(255, (heat[i] * BlendSelf +
-                       heat[(i + 1) % CellCount] * BlendNeighbor1 +
-                       heat[(i + 2) % CellCount] * BlendNeighbor2 +
-                       heat[(i + 3) % CellCount] * BlendNeighbor3)
-                      / BlendTotal);
+        heat.DiffuseTowardStart<BlendSelf, BlendNeighbor1, BlendNeighbor2, BlendNeighbor3>();
 
         // Randomly ignite new sparks down in the flame kernel
 
         for (int i = 0 ; i < Sparks; i++)
         {
-            if (random(255) < Sparking)
+            if (rng.Below(255) < Sparking)
             {
-                int y = CellCount - 1 - random(SparkHeight * CellCount / LEDCount);
-                heat[y] = random(200, 255);// heat[y] + random(50, 255);       // Can roll over which actually looks good!
+                int y = CellCount - 1 - rng.Below(SparkHeight * CellCount / LEDCount);
+                heat[y] = rng.Between(200, 255);// heat[y] + random(50, 255);       // Can roll over which actually looks good!
             }
         }
 
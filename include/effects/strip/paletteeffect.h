@@ -47,6 +47,7 @@ class PaletteEffect : public LEDStripEffect
     const TBlendType  _blend;
     const bool  _bErase;
     const float _brightness;
+    PaletteLUT _paletteLUT;
 
   public:
 
@@ -120,6 +121,8 @@ class PaletteEffect : public LEDStripEffect
         if (_bErase)
           setAllOnAllChannels(0,0,0);
 
+        _paletteLUT.Update(_palette, _blend);
+
         float deltaTime = g_Values.AppTime.LastFrameTime();
         float increment = (deltaTime * _LEDSPerSecond);
         const int totalSize = _gapSize + _lightSize + 1;
@@ -137,7 +140,7 @@ class PaletteEffect : public LEDStripEffect
           for (int i = 0; i < _cLEDs; i+=_lightSize)
           {
             iColor = fmodf(iColor + _density, 256);
-            setPixelsOnAllChannels(i, _lightSize, ColorFromPalette(_palette, iColor, 255 * _brightness, _blend), false);
+            setPixelsOnAllChannels(i, _lightSize, _paletteLUT.Color(iColor, 255 * _brightness), false);
           }
         }
         else
@@ -154,7 +157,7 @@ class PaletteEffect : public LEDStripEffect
               int index = fmodf(i, totalSize);
               if (index == 0)
               {
-                  CRGB c = ColorFromPalette(_palette, iColor, 255 * _brightness, _blend);
+                  CRGB c = _paletteLUT.Color(iColor, 255 * _brightness);
                   setPixelsOnAllChannels(i+_startIndex, _lightSize, c,false);
               }
           }
@@ -118,22 +118,29 @@ class FadingObject : public Lifespan
 
     virtual float FadeoutAmount() const
     {
-        float age = Age();
+        return FadeoutAmountAt(Age(), PreignitionTime(), IgnitionTime(), HoldTime(), FadeTime());
+    }
+
+    // The same fade curve for an object of the given age and life stages, for particles that keep their
+    // timing somewhere other than a FadingObject
+
+    static float FadeoutAmountAt(float age, float preignitionTime, float ignitionTime, float holdTime, float fadeTime)
+    {
         if (age < 0)
             age = 0;
 
-        if (age < PreignitionTime() && PreignitionTime() != 0.0f)
-            return 1.0 - (age / PreignitionTime());
-        age -= PreignitionTime();
-        if (age < IgnitionTime() && IgnitionTime() != 0.0f)
-            return (age / IgnitionTime());
-        age -= IgnitionTime();
-        if (age < HoldTime())
+        if (age < preignitionTime && preignitionTime != 0.0f)
+            return 1.0 - (age / preignitionTime);
+        age -= preignitionTime;
+        if (age < ignitionTime && ignitionTime != 0.0f)
+            return (age / ignitionTime);
+        age -= ignitionTime;
+        if (age < holdTime)
             return 0.0f;                                                // Just born
-        if (age > HoldTime() + FadeTime())
+        if (age > holdTime + fadeTime)
             return 1.0f;                                                // Black hole, all faded out
-        age -= (HoldTime());
-            return (age / FadeTime());                                  // Fading star
+        age -= holdTime;
+            return (age / fadeTime);                                    // Fading star
     }
 };
 
@@ -285,92 +292,256 @@ class ObjectSize
       }
 };
 
-class DrawableParticle : public Lifespan
-{
-  protected:
+// PooledParticle
+//
+// What a ParticlePool hands to the update for each live particle: its age this frame and references to its
+// entries in the pool's arrays, so a particle can move itself or change color as it goes
 
-  public:
-     virtual void Render(const std::vector<std::shared_ptr<GFXBase>>& _GFX) = 0;
+template <typename Attributes> struct PooledParticle
+{
+    float        age;
+    float        lifetime;
+    float      & position;
+    float      & velocity;
+    CRGB       & color;
+    Attributes & attributes;
 };
 
-template <typename Type = DrawableParticle> class ParticleSystem
+// ParticlePool
+//
+// Fixed-capacity particle storage that keeps each particle field in its own array.  The arrays are sized once
+// by SetCapacity, so spawning and expiring particles never touches the heap: a new particle takes a slot off
+// the free list, and the per-frame update hands expired slots straight back.  Anything a particle type needs
+// beyond position, velocity, color and lifetime goes in its Attributes.
+//
+// Particles are updated oldest first, the same order they were spawned in, so newer particles still draw over
+// older ones.  When every slot is taken, the oldest particle makes way for the new one.
+
+const size_t cMaxParticles = 64;
+
+template <typename Attributes> class ParticlePool
 {
-  protected:
+    template <typename T> using PoolArray = std::vector<T, psram_allocator<T>>;
 
-    std::deque<Type> _allParticles;
+    PoolArray<double>     _birthTime;
+    PoolArray<float>      _lifetime;
+    PoolArray<float>      _position;
+    PoolArray<float>      _velocity;
+    PoolArray<CRGB>       _color;
+    PoolArray<Attributes> _attributes;
 
-    // Once per frame we are called to update all particles, which includes aging out old ones
+    PoolArray<uint16_t>   _freeSlots;               // Stack of unused slots
+    size_t                _freeCount = 0;
+    PoolArray<uint16_t>   _liveSlots;               // Slots in use, oldest first
+    size_t                _liveCount = 0;
 
   public:
 
-    ParticleSystem<Type>()
+    explicit ParticlePool(size_t capacity = 0)
     {
+        if (capacity)
+            SetCapacity(capacity);
     }
 
-    virtual void Render(const std::vector<std::shared_ptr<GFXBase>>& _gfx)
+    // Sizes the pool for up to capacity particles and empties it.  This is the only call that allocates.  The
+    // allocator hands back null rather than throwing, so we first check that one block as big as all the arrays
+    // together can be had; if it can't, the pool is left empty and we return false.
+
+    bool SetCapacity(size_t capacity)
+    {
+        assert(capacity <= UINT16_MAX);     // Slots are indexed with 16 bits
+
+        constexpr size_t kBytesPerParticle = sizeof(double) + 3 * sizeof(float) + sizeof(CRGB) + sizeof(Attributes)
+                                           + 2 * sizeof(uint16_t);
+        if (Capacity())
+            Release();
+
+        void * probe = PreferPSRAMAlloc(capacity * kBytesPerParticle);
+        if (!probe)
+            return false;
+        PreferPSRAMFree(probe);
+
+        _birthTime.resize(capacity);
+        _lifetime.resize(capacity);
+        _position.resize(capacity);
+        _velocity.resize(capacity);
+        _color.resize(capacity);
+        _attributes.resize(capacity);
+        _freeSlots.resize(capacity);
+        _liveSlots.resize(capacity);
+
+        Clear();
+        return true;
+    }
+
+    // Gives the arrays back to the heap; the pool holds nothing until SetCapacity is called again
+
+    void Release()
+    {
+        *this = ParticlePool();
+    }
+
+    void Clear()
+    {
+        _liveCount = 0;
+        _freeCount = Capacity();
+        for (size_t i = 0; i < _freeCount; i++)
+            _freeSlots[i] = _freeCount - 1 - i;
+    }
+
+    size_t Capacity() const
+    {
+        return _freeSlots.size();
+    }
+
+    size_t Count() const
+    {
+        return _liveCount;
+    }
+
+    bool IsFull() const
+    {
+        return _freeCount == 0;
+    }
+
+    // Sets up a particle born this frame and returns its attributes for the caller to fill in
+
+    Attributes & Spawn(float lifetime, CRGB color = CRGB::Black, float position = 0.0f, float velocity = 0.0f)
     {
-        debugV("ParticleSystemEffect::Draw for %d particles", _allParticles.size());
+        assert(Capacity() > 0);
 
-        while (_allParticles.size() > 0 && _allParticles.front().Age() >= _allParticles.front().TotalLifetime())
-            _allParticles.pop_front();
+        if (_freeCount == 0)
+        {
+            _freeSlots[_freeCount++] = _liveSlots[0];
+            std::copy(_liveSlots.begin() + 1, _liveSlots.begin() + _liveCount, _liveSlots.begin());
+            _liveCount--;
+        }
 
-        while (_allParticles.size() > _gfx[0]->GetLEDCount())
-            _allParticles.pop_front();
+        const uint16_t slot = _freeSlots[--_freeCount];
+        _liveSlots[_liveCount++] = slot;
 
-        for(auto i = _allParticles.begin(); i != _allParticles.end(); i++)
-            i->Render(_gfx);
+        _birthTime[slot]  = g_Values.AppTime.FrameStartTime();
+        _lifetime[slot]   = lifetime;
+        _position[slot]   = position;
+        _velocity[slot]   = velocity;
+        _color[slot]      = color;
+        _attributes[slot] = Attributes();
+        return _attributes[slot];
+    }
+
+    // Frees the slots of particles that have outlived their lifetime and calls update(PooledParticle &) for the
+    // rest.  Survivors are packed down the live list as we go, which keeps them in spawn order.
+
+    template <typename UpdateFunction> void Update(UpdateFunction update)
+    {
+        const double now = g_Values.AppTime.FrameStartTime();
+        size_t kept = 0;
+
+        for (size_t i = 0; i < _liveCount; i++)
+        {
+            const uint16_t slot = _liveSlots[i];
+            const float age = now - _birthTime[slot];
+
+            if (age >= _lifetime[slot])
+            {
+                _freeSlots[_freeCount++] = slot;
+                continue;
+            }
+
+            _liveSlots[kept++] = slot;
+
+            PooledParticle<Attributes> particle { age, _lifetime[slot], _position[slot], _velocity[slot], _color[slot], _attributes[slot] };
+            update(particle);
+        }
+
+        _liveCount = kept;
     }
 };
 
-class RingParticle : public FadingColoredObject
+// ParticleSystem
+//
+// Base for effects that draw a pool of particles.  Type is the particle type, which supplies the Attributes
+// each particle carries, a static Spawn that adds one to the pool, and a static Render that draws one; the
+// whole pool is then aged and drawn in a single pass each frame.
+
+template <typename Type> class ParticleSystem
 {
   protected:
 
-    int             _iInsulator;
-    int             _iRing;
-    float           _ignitionTime;
-    float           _fadeTime;
+    ParticlePool<typename Type::Attributes> _allParticles;
+
+  public:
+
+    ParticleSystem() : _allParticles(cMaxParticles)
+    {
+    }
+
+    virtual void Render(const std::vector<std::shared_ptr<GFXBase>>& _gfx)
+    {
+        debugV("ParticleSystemEffect::Draw for %zu particles", _allParticles.Count());
 
+        _allParticles.Update([&](PooledParticle<typename Type::Attributes> & particle)
+        {
+            Type::Render(_gfx, particle);
+        });
+    }
+};
+
+// RingParticle
+//
+// Fills a ring on one insulator, or on all of them for a major beat, flashing white at ignition and then
+// fading out its color
+
+class RingParticle
+{
   public:
 
-    RingParticle(int iInsulator, int iRing, CRGB color, float ignitionTime = 0.0f, float fadeTime = 1.0f)
-      :  FadingColoredObject(color),
-         _iInsulator(iInsulator),
-         _iRing(iRing),
-         _ignitionTime(ignitionTime),
-         _fadeTime(fadeTime)
+    struct Attributes
+    {
+        int             iInsulator;
+        int             iRing;
+        float           ignitionTime;
+    };
+
+    template <typename Pool>
+    static void Spawn(Pool & pool, int iInsulator, int iRing, CRGB color, float ignitionTime = 0.0f, float fadeTime = 1.0f)
     {
         assert(iRing <= NUM_RINGS);
         assert(iInsulator < NUM_FANS);
         debugV("Creating particle at insulator %d", iInsulator);
+
+        pool.Spawn(ignitionTime + fadeTime, color) = { iInsulator, iRing, ignitionTime };
     }
 
-    virtual void Render(const std::vector<std::shared_ptr<GFXBase>>& _GFX)
+    static void Render(const std::vector<std::shared_ptr<GFXBase>>& _GFX, PooledParticle<Attributes> & particle)
     {
-        debugV("Particle Render at insulator %d", _iInsulator);
+        const Attributes & ring = particle.attributes;
+        debugV("Particle Render at insulator %d", ring.iInsulator);
 
-        if (_iInsulator < 0)    // -1 is a major beat, all insulators
+        CRGB c;
+        if (particle.age < ring.ignitionTime)
         {
-          CRGB c = ObjectColor();
-
-          //c.fadeToBlackBy(192);
+            c = CRGB::White;
+            c.fadeToBlackBy(255 - (particle.age / ring.ignitionTime * 255));
+            c += particle.color;
+        }
+        else
+        {
+            const float fadeTime = particle.lifetime - ring.ignitionTime;
+            c = particle.color;
+            fadeToBlackBy(&c, 1, 255 * FadingObject::FadeoutAmountAt(particle.age, 0.0f, ring.ignitionTime, 0.0f, fadeTime));
+        }
 
+        if (ring.iInsulator < 0)    // -1 is a major beat, all insulators
+        {
           for (int i = 0; i < NUM_FANS; i++)
-          {
-
-            FillRingPixels(c, i, _iRing);
-          }
+            FillRingPixels(c, i, ring.iRing);
         }
         else    // Individual ring for a minor beat
         {
-          FillRingPixels(ObjectColor(), _iInsulator, _iRing);
+          FillRingPixels(c, ring.iInsulator, ring.iRing);
         }
     }
-
-    float PreignitionTime() const override         { return 0.0f;          }
-    float IgnitionTime()    const override         { return _ignitionTime; }
-    float HoldTime()        const override         { return 0.0f;          }
-    float FadeTime()        const override         { return _fadeTime;     }
 };
 
 
@@ -394,8 +565,7 @@ class ColorBeatWithFlash : public BeatEffectBase, public ParticleSystem<RingPart
     {
       debugV("MusicalInsulatorEffect2 LightInsulator for Insulator %d", iInsulator);
 
-      RingParticle newparticle(iInsulator, iRing, color, !bMajor ? 0.05 : 0.0, 0.75);
-      _allParticles.push_back(newparticle);
+      RingParticle::Spawn(_allParticles, iInsulator, iRing, color, !bMajor ? 0.05 : 0.0, 0.75);
     }
 
     virtual void HandleBeat(bool bMajor, float elapsed, float span)
@@ -466,7 +636,7 @@ class ColorBeatOverRed : public LEDStripEffect, public BeatEffectBase, public Pa
         float fadetime = min(5.0, elapsed * 1.5);   // Cap it at 5 seconds so we don't get ultra-long beats resulting from delays
         float flashtime = 0;
 
-        _allParticles.push_back(RingParticle(iInsulator, 0, RandomSaturatedColor(), flashtime, fadetime));
+        RingParticle::Spawn(_allParticles, iInsulator, 0, RandomSaturatedColor(), flashtime, fadetime);
     }
 
     virtual void Draw() override
@@ -488,31 +658,35 @@ class ColorBeatOverRed : public LEDStripEffect, public BeatEffectBase, public Pa
 };
 #endif
 
-class SpinningPaletteRingParticle : public FadingObject
-{
-  protected:
-
-          int             _iInsulator;
-          int             _iRing;
-    const CRGBPalette16  _palette;
-          int             _length;
-          int             _start;
-    const float           _density;
-    const float           _paletteSpeed;
-    const float           _LEDSPerSecond;
-    const float           _lightSize;
-    const float           _gapSize;
-    const TBlendType      _blend;
-    const bool            _bErase;
-          float           _startIndex;
-          float           _paletteIndex;
-    const float           _brightness;
-    const float           _ignitionTime;
-
+// SpinningPaletteRingParticle
+//
+// Scrolls a palette around a ring, optionally as lights separated by gaps.  The scroll offset is kept in the
+// particle's position and the scroll speed, in LEDs per second, in its velocity.
 
+class SpinningPaletteRingParticle
+{
   public:
 
-    SpinningPaletteRingParticle(
+    struct Attributes
+    {
+        const CRGBPalette16 * palette;
+        int                   start;
+        int                   length;
+        float                 density;
+        float                 lightSize;
+        float                 gapSize;
+        TBlendType            blend;
+        bool                  bErase;
+        float                 brightness;
+        float                 ignitionTime;
+    };
+
+    // paletteSpeed is accepted for the existing callers but has no effect; the palette index it drove was
+    // never used for drawing
+
+    template <typename Pool>
+    static void Spawn(
+                  Pool                 & pool,
                   int                    iInsulator,
                   int                    iRing,
                   const CRGBPalette16 & palette,
@@ -525,62 +699,43 @@ class SpinningPaletteRingParticle : public FadingObject
                   bool                   bErase = true,
                   float                  brightness = 1.0f,
                   float                  ignitionTime = 0.0)
-      :  _iInsulator(iInsulator),
-         _iRing(iRing),
-         _palette(palette),
-         _density(density),
-         _paletteSpeed(paletteSpeed),
-         _LEDSPerSecond(ledsPerSecond),
-         _lightSize(lightSize),
-         _gapSize(gapSize),
-         _blend(blend),
-         _bErase(bErase),
-         _startIndex(0.0f),
-         _paletteIndex(0.0f),
-         _brightness(brightness),
-         _ignitionTime(ignitionTime)
     {
         assert(iRing <= NUM_RINGS);
         assert(iInsulator < NUM_FANS);
         debugV("Creating particle at insulator %d", iInsulator);
 
-        // REVIEW(davepl): I'm not sure what I was doing here.  I think it allows you to pass 0 for speed and always start at 0 index?
-
-        _paletteIndex += beatsin16(4, 0, 255) * paletteSpeed;
-        _startIndex += beatsin16(4, 0, 255) * ledsPerSecond;
-
-        _start = iInsulator * FAN_SIZE;     // Move to correct insulator
+        int start = iInsulator * FAN_SIZE;  // Move to correct insulator
         for (int i = 0; i < iRing; i++)     // Move to ring within the insulator
-          _start += g_aRingSizeTable[i];
+          start += g_aRingSizeTable[i];
 
-        _length = g_aRingSizeTable[iRing];    // Length is size of this particular ring
+        // Length is size of this particular ring
+        pool.Spawn(ignitionTime + FadeTime, CRGB::Black, beatsin16(4, 0, 255) * ledsPerSecond, ledsPerSecond) =
+            { &palette, start, g_aRingSizeTable[iRing], density, lightSize, gapSize, blend, bErase, brightness, ignitionTime };
     }
 
-    virtual void Render(const std::vector<std::shared_ptr<GFXBase>>& _GFX)
+    static void Render(const std::vector<std::shared_ptr<GFXBase>>& _GFX, PooledParticle<Attributes> & particle)
     {
-        debugV("Particle Render at insulator %d", _iInsulator);
+        const Attributes & ring = particle.attributes;
+        debugV("Particle Render at ring start %d", ring.start);
 
-        if (_bErase)
-          _GFX[0]->setPixelsF(_start, _length, CRGB::Black, false);
+        const float fadeout = FadingObject::FadeoutAmountAt(particle.age, 0.0f, ring.ignitionTime, 0.0f, FadeTime);
 
-        float deltaTime = g_Values.AppTime.LastFrameTime();
-        float increment = (deltaTime * _LEDSPerSecond);
-        const int totalSize = _gapSize + _lightSize + 1;
-        _startIndex   = totalSize > 1 ? fmodf(_startIndex + increment, totalSize) : 0;
+        if (ring.bErase)
+          _GFX[0]->setPixelsF(ring.start, ring.length, CRGB::Black, false);
 
-        // A single color step in a palette is 32 increments.  There are 256 total in a palette, and 144 pixels per meter typical, so this
-        // scaling yields a color rotation of "one full palette per meter" by default.  We go backwards (-1) to match pixel scrolling direction.
-
-        _paletteIndex = _paletteIndex - (deltaTime * _paletteSpeed * _density);
+        float deltaTime = g_Values.AppTime.LastFrameTime();
+        float increment = (deltaTime * particle.velocity);
+        const int totalSize = ring.gapSize + ring.lightSize + 1;
+        particle.position = totalSize > 1 ? fmodf(particle.position + increment, totalSize) : 0;
 
-        float iColor = 0; // fmodf(_paletteIndex + _startIndex * _density, 256);
+        float iColor = 0;
 
-        if (_gapSize == 0)
+        if (ring.gapSize == 0)
         {
-          for (int i = _start; i < _start+_length; i+=_lightSize)
+          for (int i = ring.start; i < ring.start + ring.length; i += ring.lightSize)
           {
-            iColor = fmodf(iColor + _density, 256);
-            _GFX[0]->setPixelsF(i, _lightSize, ColorFromPalette(_palette, iColor, 255 - 255 * FadeoutAmount(), _blend), true);
+            iColor = fmodf(iColor + ring.density, 256);
+            _GFX[0]->setPixelsF(i, ring.lightSize, ColorFromPalette(*ring.palette, iColor, 255 - 255 * fadeout, ring.blend), true);
           }
         }
         else
@@ -588,71 +743,69 @@ class SpinningPaletteRingParticle : public FadingObject
           // Start far enough "back" to have one off-strip light and gap, and then we need to draw at least as far as the last light.
           // This prevents sticks of light from "appearing" or "disappearing" at the ends
 
-          for (float i = _start-totalSize; i < _start+_length+_lightSize; i++)
+          for (float i = ring.start - totalSize; i < ring.start + ring.length + ring.lightSize; i++)
           {
               // We look for each pixel where we cross an even multiple of the light+gap size, which means it's time to start the drawing
               // of the light here
 
-              iColor = fmodf(iColor + _density, 256);
+              iColor = fmodf(iColor + ring.density, 256);
               int index = fmodf(i, totalSize);
               if (index == 0)
               {
-                  CRGB c = ColorFromPalette(_palette, iColor, 255 * _brightness * FadeoutAmount(), _blend);
-                  if (i + _startIndex > _start)
-                    _GFX[0]->setPixelsF(i+_startIndex, _lightSize, c, true);
+                  CRGB c = ColorFromPalette(*ring.palette, iColor, 255 * ring.brightness * fadeout, ring.blend);
+                  if (i + particle.position > ring.start)
+                    _GFX[0]->setPixelsF(i + particle.position, ring.lightSize, c, true);
               }
           }
         }
 
-        if (Age() < IgnitionTime() + PreignitionTime() && Age() >= PreignitionTime())
-          _GFX[0]->setPixelsF(_start + random(0, _length), 1, CRGB::White, true);
+        if (particle.age < ring.ignitionTime)
+          _GFX[0]->setPixelsF(ring.start + random(0, ring.length), 1, CRGB::White, true);
     }
 
-    float PreignitionTime() const override         { return 0.0f;          }
-    float IgnitionTime() const override            { return _ignitionTime; }
-    float HoldTime() const override                { return 0.0f;          }
-    float FadeTime() const override                { return 1.00;          }
+  private:
+
+    static constexpr float FadeTime = 1.00f;
 };
 
+// HotWhiteRingParticle
+//
+// Fills a ring with a white flash that cools through yellow and red as it fades
 
-class HotWhiteRingParticle : public FadingObject
+class HotWhiteRingParticle
 {
-  protected:
-
-    int             _iInsulator;
-    int             _iRing;
-    float           _ignitionTime;
-    float           _fadeTime;
-
   public:
 
-    HotWhiteRingParticle(int iInsulator, int iRing, float ignitionTime = 0.25f, float fadeTime = 1.0f)
-      :  _iInsulator(iInsulator),
-         _iRing(iRing),
-         _ignitionTime(ignitionTime),
-         _fadeTime(fadeTime)
+    struct Attributes
+    {
+        int             iInsulator;
+        int             iRing;
+        float           ignitionTime;
+    };
+
+    template <typename Pool>
+    static void Spawn(Pool & pool, int iInsulator, int iRing, float ignitionTime = 0.25f, float fadeTime = 1.0f)
     {
         assert(iRing <= NUM_RINGS);
         assert(iInsulator < NUM_FANS);
         debugV("Creating particle at insulator %d", iInsulator);
+
+        pool.Spawn(ignitionTime + fadeTime) = { iInsulator, iRing, ignitionTime };
     }
 
-    virtual void Render(const std::vector<std::shared_ptr<GFXBase>>& _GFX)
+    static void Render(const std::vector<std::shared_ptr<GFXBase>>& _GFX, PooledParticle<Attributes> & particle)
     {
-        debugV("Particle Render at insulator %d", _iInsulator);
+        const Attributes & ring = particle.attributes;
+        debugV("Particle Render at insulator %d", ring.iInsulator);
 
         CRGB c = CRGB::White;
 
-        if (Age() >= PreignitionTime() && Age() < IgnitionTime() + PreignitionTime())
-        {
-            c = CRGB::White;
-            //c.fadeToBlackBy(255 - ((Age() - PreignitionTime()) / IgnitionTime() * 255));
-        }
-        else
+        if (particle.age >= ring.ignitionTime)
         {
-          float age = Age() - PreignitionTime() - IgnitionTime();
+          const float fadeTime = particle.lifetime - ring.ignitionTime;
+          float age = particle.age - ring.ignitionTime;
 
-          uint8_t temperature = 255 * (1.0 - (age/FadeTime()));
+          uint8_t temperature = 255 * (1.0 - (age/fadeTime));
           uint8_t t192 = round((temperature/255.0)*191);
 
           // calculate ramp up from
@@ -665,26 +818,21 @@ class HotWhiteRingParticle : public FadingObject
               c = CRGB( 255, heatramp, 0);
           else                                  // coolest
               c = CRGB( heatramp, 0, 0);
-          fadeToBlackBy(&c, 1, 255 * FadeoutAmount());
+          fadeToBlackBy(&c, 1, 255 * FadingObject::FadeoutAmountAt(particle.age, 0.0f, ring.ignitionTime, 0.0f, fadeTime));
         }
 
-        if (_iInsulator < 0)    // -1 is a major beat, all insulators
+        if (ring.iInsulator < 0)    // -1 is a major beat, all insulators
         {
             for (int i = 0; i < NUM_FANS; i++)
             {
-              FillRingPixels(c, i, _iRing);
+              FillRingPixels(c, i, ring.iRing);
             }
         }
         else    // Individual ring for a minor beat
         {
-          FillRingPixels(c, _iInsulator, _iRing);
+          FillRingPixels(c, ring.iInsulator, ring.iRing);
         }
     }
-
-    float PreignitionTime() const override         { return 0.0f;          }
-    float IgnitionTime()    const override         { return _ignitionTime; }
-    float HoldTime()        const override         { return 0.0f;          }
-    float FadeTime()        const override         { return _fadeTime;     }
 };
 
 #if ENABLE_AUDIO
@@ -741,26 +889,26 @@ class MoltenGlassOnVioletBkgnd : public LEDStripEffect, public BeatEffectBase, p
         switch (random(10))
         {
           case 0:
-            _allParticles.push_back(SpinningPaletteRingParticle(0, 0, _Palette, 256.0/FAN_SIZE, 0, -0.5, RING_SIZE_0, 0, LINEARBLEND, true, 1.0, 0));
-            _allParticles.push_back(SpinningPaletteRingParticle(2, 0, _Palette, 256.0/FAN_SIZE, 0, -0.5, RING_SIZE_0, 0, LINEARBLEND, true, 1.0, 0));
-            _allParticles.push_back(SpinningPaletteRingParticle(4, 0, _Palette, 256.0/FAN_SIZE, 0, -0.5, RING_SIZE_0, 0, LINEARBLEND, true, 1.0, 0));
+            SpinningPaletteRingParticle::Spawn(_allParticles, 0, 0, _Palette, 256.0/FAN_SIZE, 0, -0.5, RING_SIZE_0, 0, LINEARBLEND, true, 1.0, 0);
+            SpinningPaletteRingParticle::Spawn(_allParticles, 2, 0, _Palette, 256.0/FAN_SIZE, 0, -0.5, RING_SIZE_0, 0, LINEARBLEND, true, 1.0, 0);
+            SpinningPaletteRingParticle::Spawn(_allParticles, 4, 0, _Palette, 256.0/FAN_SIZE, 0, -0.5, RING_SIZE_0, 0, LINEARBLEND, true, 1.0, 0);
             break;
 
           case 1:
-            _allParticles.push_back(SpinningPaletteRingParticle(1, 0, _Palette, 256.0/FAN_SIZE, 0, -0.5, RING_SIZE_0, 0, LINEARBLEND, true, 1.0, 0));
-            _allParticles.push_back(SpinningPaletteRingParticle(3, 0, _Palette, 256.0/FAN_SIZE, 0, -0.5, RING_SIZE_0, 0, LINEARBLEND, true, 1.0, 0));
+            SpinningPaletteRingParticle::Spawn(_allParticles, 1, 0, _Palette, 256.0/FAN_SIZE, 0, -0.5, RING_SIZE_0, 0, LINEARBLEND, true, 1.0, 0);
+            SpinningPaletteRingParticle::Spawn(_allParticles, 3, 0, _Palette, 256.0/FAN_SIZE, 0, -0.5, RING_SIZE_0, 0, LINEARBLEND, true, 1.0, 0);
             break;
 
           case 2:
-            _allParticles.push_back(SpinningPaletteRingParticle(0, 0, _Palette, 2, 50, -0.5, 1, 0, LINEARBLEND, true, 1.0, 0));
-            _allParticles.push_back(SpinningPaletteRingParticle(1, 0, _Palette, 2, 50, -0.5, 1, 0, LINEARBLEND, true, 1.0, 0));
-            _allParticles.push_back(SpinningPaletteRingParticle(2, 0, _Palette, 2, 50, -0.5, 1, 0, LINEARBLEND, true, 1.0, 0));
-            _allParticles.push_back(SpinningPaletteRingParticle(3, 0, _Palette, 2, 50, -0.5, 1, 0, LINEARBLEND, true, 1.0, 0));
-            _allParticles.push_back(SpinningPaletteRingParticle(4, 0, _Palette, 2, 50, -0.5, 1, 0, LINEARBLEND, true, 1.0, 0));
+            SpinningPaletteRingParticle::Spawn(_allParticles, 0, 0, _Palette, 2, 50, -0.5, 1, 0, LINEARBLEND, true, 1.0, 0);
+            SpinningPaletteRingParticle::Spawn(_allParticles, 1, 0, _Palette, 2, 50, -0.5, 1, 0, LINEARBLEND, true, 1.0, 0);
+            SpinningPaletteRingParticle::Spawn(_allParticles, 2, 0, _Palette, 2, 50, -0.5, 1, 0, LINEARBLEND, true, 1.0, 0);
+            SpinningPaletteRingParticle::Spawn(_allParticles, 3, 0, _Palette, 2, 50, -0.5, 1, 0, LINEARBLEND, true, 1.0, 0);
+            SpinningPaletteRingParticle::Spawn(_allParticles, 4, 0, _Palette, 2, 50, -0.5, 1, 0, LINEARBLEND, true, 1.0, 0);
             break;
 
           default:
-            _allParticles.push_back(SpinningPaletteRingParticle(iInsulator, 0, _Palette, 256.0/FAN_SIZE, 0, -0.5, RING_SIZE_0, 0, LINEARBLEND, true, 1.0, 0));
+            SpinningPaletteRingParticle::Spawn(_allParticles, iInsulator, 0, _Palette, 256.0/FAN_SIZE, 0, -0.5, RING_SIZE_0, 0, LINEARBLEND, true, 1.0, 0);
             break;
         }
     }
@@ -832,26 +980,26 @@ class NewMoltenGlassOnVioletBkgnd : public LEDStripEffect, public BeatEffectBase
         switch (random(10))
         {
           case 0:
-            _allParticles.push_back(SpinningPaletteRingParticle(0, 0, _Palette, 256.0/FAN_SIZE, 0, -0.5, RING_SIZE_0, 0, LINEARBLEND, true, 1.0, 0));
-            _allParticles.push_back(SpinningPaletteRingParticle(2, 0, _Palette, 256.0/FAN_SIZE, 0, -0.5, RING_SIZE_0, 0, LINEARBLEND, true, 1.0, 0));
-            _allParticles.push_back(SpinningPaletteRingParticle(4, 0, _Palette, 256.0/FAN_SIZE, 0, -0.5, RING_SIZE_0, 0, LINEARBLEND, true, 1.0, 0));
+            SpinningPaletteRingParticle::Spawn(_allParticles, 0, 0, _Palette, 256.0/FAN_SIZE, 0, -0.5, RING_SIZE_0, 0, LINEARBLEND, true, 1.0, 0);
+            SpinningPaletteRingParticle::Spawn(_allParticles, 2, 0, _Palette, 256.0/FAN_SIZE, 0, -0.5, RING_SIZE_0, 0, LINEARBLEND, true, 1.0, 0);
+            SpinningPaletteRingParticle::Spawn(_allParticles, 4, 0, _Palette, 256.0/FAN_SIZE, 0, -0.5, RING_SIZE_0, 0, LINEARBLEND, true, 1.0, 0);
             break;
 
           case 1:
-            _allParticles.push_back(SpinningPaletteRingParticle(1, 0, _Palette, 256.0/FAN_SIZE, 0, -0.5, RING_SIZE_0, 0, LINEARBLEND, true, 1.0, 0));
-            _allParticles.push_back(SpinningPaletteRingParticle(3, 0, _Palette, 256.0/FAN_SIZE, 0, -0.5, RING_SIZE_0, 0, LINEARBLEND, true, 1.0, 0));
+            SpinningPaletteRingParticle::Spawn(_allParticles, 1, 0, _Palette, 256.0/FAN_SIZE, 0, -0.5, RING_SIZE_0, 0, LINEARBLEND, true, 1.0, 0);
+            SpinningPaletteRingParticle::Spawn(_allParticles, 3, 0, _Palette, 256.0/FAN_SIZE, 0, -0.5, RING_SIZE_0, 0, LINEARBLEND, true, 1.0, 0);
             break;
 
           case 2:
-            _allParticles.push_back(SpinningPaletteRingParticle(0, 0, _Palette, 2, 50, -0.5, 1, 0, LINEARBLEND, true, 1.0, 0));
-            _allParticles.push_back(SpinningPaletteRingParticle(1, 0, _Palette, 2, 50, -0.5, 1, 0, LINEARBLEND, true, 1.0, 0));
-            _allParticles.push_back(SpinningPaletteRingParticle(2, 0, _Palette, 2, 50, -0.5, 1, 0, LINEARBLEND, true, 1.0, 0));
-            _allParticles.push_back(SpinningPaletteRingParticle(3, 0, _Palette, 2, 50, -0.5, 1, 0, LINEARBLEND, true, 1.0, 0));
-            _allParticles.push_back(SpinningPaletteRingParticle(4, 0, _Palette, 2, 50, -0.5, 1, 0, LINEARBLEND, true, 1.0, 0));
+            SpinningPaletteRingParticle::Spawn(_allParticles, 0, 0, _Palette, 2, 50, -0.5, 1, 0, LINEARBLEND, true, 1.0, 0);
+            SpinningPaletteRingParticle::Spawn(_allParticles, 1, 0, _Palette, 2, 50, -0.5, 1, 0, LINEARBLEND, true, 1.0, 0);
+            SpinningPaletteRingParticle::Spawn(_allParticles, 2, 0, _Palette, 2, 50, -0.5, 1, 0, LINEARBLEND, true, 1.0, 0);
+            SpinningPaletteRingParticle::Spawn(_allParticles, 3, 0, _Palette, 2, 50, -0.5, 1, 0, LINEARBLEND, true, 1.0, 0);
+            SpinningPaletteRingParticle::Spawn(_allParticles, 4, 0, _Palette, 2, 50, -0.5, 1, 0, LINEARBLEND, true, 1.0, 0);
             break;
 
           default:
-            _allParticles.push_back(SpinningPaletteRingParticle(iInsulator, 0, _Palette, 256.0/FAN_SIZE, 0, -0.5, RING_SIZE_0, 0, LINEARBLEND, true, 1.0, 0));
+            SpinningPaletteRingParticle::Spawn(_allParticles, iInsulator, 0, _Palette, 256.0/FAN_SIZE, 0, -0.5, RING_SIZE_0, 0, LINEARBLEND, true, 1.0, 0);
             break;
         }
     }
@@ -917,7 +1065,7 @@ class SparklySpinningMusicEffect : public LEDStripEffect, public BeatEffectBase,
         } while (NUM_FANS > 3 && iInsulator == _iLastInsulator);
         _iLastInsulator = iInsulator;
 
-        _allParticles.push_back(SpinningPaletteRingParticle(iInsulator, 0, _Palette, 1, 1.0, 1.0, 1, 0, NOBLEND, true, 1.0, min(0.15f, elapsed/2)));
+        SpinningPaletteRingParticle::Spawn(_allParticles, iInsulator, 0, _Palette, 1, 1.0, 1.0, 1, 0, NOBLEND, true, 1.0, min(0.15f, elapsed/2));
     }
 
     virtual void Draw() override
@@ -962,7 +1110,7 @@ class MusicalHotWhiteInsulatorEffect : public LEDStripEffect, public BeatEffectB
         } while (NUM_FANS > 3 && iInsulator == _iLastInsulator);
         _iLastInsulator = iInsulator;
 
-        _allParticles.push_back(HotWhiteRingParticle(iInsulator, 0, 0.25, 0.75));
+        HotWhiteRingParticle::Spawn(_allParticles, iInsulator, 0, 0.25, 0.75);
     }
 
     virtual void Draw() override
@@ -34,96 +34,90 @@
 #include "particles.h"
 
 const int cMaxNewStarsPerFrame = 144;
-const int cMaxStars = 500;
 const int starWidth = 1;
 
+// StarTiming
+//
+// How long a star spends in each stage of its life, in seconds: fading in before it ignites, flashing white
+// while it ignites, holding its color, and fading out
 
-class Star : public MovingFadingPaletteObject, public ObjectSize
+struct StarTiming
 {
-  public:
+    float preignition;
+    float ignition;
+    float hold;
+    float fade;
 
-    static int GetStarTypeNumber()
+    constexpr float Lifetime() const
     {
-        return EFFECT_STAR;
+        return preignition + ignition + hold + fade;
     }
+};
 
-    virtual float GetStarSize()
-    {
-        return _objectSize;
-    }
+// Timing for every star type, indexed by its star type number
 
-    Star(const CRGBPalette16 & palette, TBlendType blendType = NOBLEND, float maxSpeed = 1.0, float starSize = 1.0)
-        : MovingFadingPaletteObject(palette, blendType, maxSpeed),
-          ObjectSize(starSize)
-    {
-    }
+constexpr StarTiming g_StarTimings[] =
+{
+    { 0.00f, 0.00f, 0.00f, 0.00f },     // (unused)
+    { 0.00f, 0.50f, 1.00f, 1.50f },     // EFFECT_STAR
+    { 0.00f, 0.50f, 1.00f, 1.50f },     // EFFECT_STAR_RANDOM_PALETTE_COLOR
+    { 0.25f, 5.00f, 0.00f, 0.00f },     // EFFECT_STAR_LONG_LIFE_SPARKLE
+    { 0.00f, 0.50f, 1.00f, 1.50f },     // EFFECT_STAR_COLOR
+    { 0.00f, 0.11f, 2.00f, 0.25f },     // EFFECT_STAR_MUSIC
+    { 0.00f, 0.00f, 1.00f, 2.00f },     // EFFECT_STAR_MUSIC_PULSE
+    { 1.00f, 0.00f, 0.00f, 2.00f },     // EFFECT_STAR_QUIET
+    { 0.00f, 0.05f, 0.25f, 0.50f },     // EFFECT_STAR_BUBBLY
+    { 0.00f, 0.10f, 0.10f, 0.05f },     // EFFECT_STAR_FLASH
+    { 2.00f, 0.00f, 2.00f, 0.50f },     // EFFECT_STAR_COLOR_CYCLE
+    { 2.00f, 0.00f, 2.00f, 0.50f },     // EFFECT_STAR_MULTI_COLOR
+    { 0.20f, 0.00f, 6.00f, 1.25f },     // EFFECT_STAR_CHRISTMAS
+    { 0.00f, 0.20f, 0.00f, 2.00f },     // EFFECT_STAR_HOT_WHITE
 };
 
-class RandomPaletteColorStar : public MovingFadingPaletteObject, public ObjectSize
+static_assert(std::size(g_StarTimings) == EFFECT_STAR_HOT_WHITE + 1, "Every star type needs an entry in g_StarTimings");
+
+// Star types
+//
+// A star type is its type number, which picks its timing from g_StarTimings and is what gets saved with the
+// effect, plus the way it picks the palette index of a new star
+
+class Star
 {
   public:
 
-    static int GetStarTypeNumber()
+    static constexpr int GetStarTypeNumber()
     {
-        return EFFECT_STAR_RANDOM_PALETTE_COLOR;
-    }
-
-    virtual float GetStarSize()
-    {
-        return _objectSize;
+        return EFFECT_STAR;
     }
 
-    RandomPaletteColorStar(const CRGBPalette16 & palette, TBlendType blendType = NOBLEND, float maxSpeed = 1.0, float starSize = 1.0)
-        : MovingFadingPaletteObject(palette, blendType, maxSpeed, random(16)*16),
-          ObjectSize(starSize)
+    static uint8_t NewColorIndex()
     {
+        return random8();
     }
 };
 
-class LongLifeSparkleStar : public MovingFadingPaletteObject, public ObjectSize
+class RandomPaletteColorStar : public Star
 {
-    float PreignitionTime() const override         { return .25f;  }
-    float IgnitionTime()    const override         { return 5.0f;  }
-    float HoldTime()        const override         { return 0.00f; }
-    float FadeTime()        const override         { return 0.0f;  }
-
   public:
 
-    static int GetStarTypeNumber()
-    {
-        return EFFECT_STAR_LONG_LIFE_SPARKLE;
-    }
-
-    virtual float GetStarSize()
+    static constexpr int GetStarTypeNumber()
     {
-        return _objectSize;
+        return EFFECT_STAR_RANDOM_PALETTE_COLOR;
     }
 
-    LongLifeSparkleStar(const CRGBPalette16 & palette, TBlendType blendType = NOBLEND, float maxSpeed = 1.0, float starSize = 1.0)
-        : MovingFadingPaletteObject(palette, blendType, maxSpeed),
-          ObjectSize(starSize)
+    static uint8_t NewColorIndex()
     {
+        return random(16)*16;
     }
 };
 
-class ColorStar : public MovingFadingColoredObject, public ObjectSize
+class LongLifeSparkleStar : public Star
 {
   public:
 
-    static int GetStarTypeNumber()
-    {
-        return EFFECT_STAR_COLOR;
-    }
-
-    virtual float GetStarSize()
-    {
-        return _objectSize;
-    }
-
-    ColorStar(CRGB color, float maxSpeed = 1.0, float starSize = 1.0)
-        : MovingFadingColoredObject(color, maxSpeed),
-          ObjectSize(starSize)
+    static constexpr int GetStarTypeNumber()
     {
+        return EFFECT_STAR_LONG_LIFE_SPARKLE;
     }
 };
 
@@ -131,20 +125,10 @@ class QuietStar : public RandomPaletteColorStar
 {
   public:
 
-    static int GetStarTypeNumber()
+    static constexpr int GetStarTypeNumber()
     {
         return EFFECT_STAR_QUIET;
     }
-
-    QuietStar(const CRGBPalette16 & palette, TBlendType blendType = NOBLEND, float maxSpeed = 10.0, float starSize = 1)
-      : RandomPaletteColorStar(palette, blendType, maxSpeed, starSize)
-    {}
-
-    float PreignitionTime() const override { return 1.0f; }
-    float IgnitionTime()    const override { return 0.00f; }
-    float HoldTime()        const override { return 0.00f; }
-    float FadeTime()        const override { return 2.0f;  }
-    virtual float StarSize()        const { return 1;     }
 };
 
 #if ENABLE_AUDIO
@@ -152,200 +136,76 @@ class MusicStar : public Star
 {
   public:
 
-    MusicStar(const CRGBPalette16 & palette, TBlendType blendType = NOBLEND, float maxSpeed = 2.0, float starSize = 1)
-      : Star(palette, blendType, maxSpeed, starSize)
-    {
-    }
-
-    static int GetStarTypeNumber()
+    static constexpr int GetStarTypeNumber()
     {
         return EFFECT_STAR_MUSIC;
     }
-
-    virtual float PreignitionTime() const      { return 0.0f; }
-    virtual float IgnitionTime()    const      { return 0.11f; }
-    virtual float HoldTime()        const      { return 2.0f; }
-    virtual float FadeTime()        const      { return 0.25f;  }
-
 };
 
 class MusicPulseStar : public Star
 {
-    public:
-
-    MusicPulseStar(const CRGBPalette16 & palette, TBlendType blendType = LINEARBLEND, float maxSpeed = 0.0, float size = 0.0)
-      : Star(palette, blendType, maxSpeed, size)
-    {
-
-    }
-
-    virtual ~MusicPulseStar()
-    {
-    }
+  public:
 
-    static int GetStarTypeNumber()
+    static constexpr int GetStarTypeNumber()
     {
         return EFFECT_STAR_MUSIC_PULSE;
     }
-
-    virtual float PreignitionTime() const { return 0.00f;  }
-    virtual float IgnitionTime()    const { return 0.00f; }
-    virtual float HoldTime()        const { return 1.00f;  }
-    virtual float FadeTime()        const { return 2.00f; }
-    virtual float GetStarSize()    const { return 1 + _objectSize * g_Analyzer._VURatio; }
 };
-
 #endif
 
 class BubblyStar : public Star
 {
-    protected:
-    int         _hue;
-
-    public:
-
-    BubblyStar(const CRGBPalette16 & palette, TBlendType blendType = LINEARBLEND, float maxSpeed = 2.0, float starSize = 12)
-      : Star(palette, blendType, maxSpeed, starSize)
-    {
-        static float lastHue = 0;
-        _hue        = lastHue;
-        lastHue += 16;
-        lastHue = fmod(lastHue, 256);
-    }
+  public:
 
-    static int GetStarTypeNumber()
+    static constexpr int GetStarTypeNumber()
     {
         return EFFECT_STAR_BUBBLY;
     }
-
-    float GetStarSize() override
-    {
-        float x = Age()/TotalLifetime();
-        float ratio1 = -1 * (2*(x-.5)) * (2*(x-.5)) + 1;
-        float width = ratio1 * _objectSize;
-        return width;
-    }
-
-    ~BubblyStar() override
-    {}
-
-    float PreignitionTime() const override  { return 0.00f; }
-    float IgnitionTime()    const override  { return 0.05f; }
-    float HoldTime()        const override  { return 0.25f; }
-    float FadeTime()        const override  { return 0.50f; }
 };
 
 class FlashStar : public Star
 {
-    using Star::Star;
+  public:
 
-    static int GetStarTypeNumber()
+    static constexpr int GetStarTypeNumber()
     {
         return EFFECT_STAR_FLASH;
     }
-
-    float PreignitionTime() const override  { return 0.00f; }
-    float IgnitionTime()    const override  { return 0.10f; }
-    float HoldTime()        const override  { return 0.10f; }
-    float FadeTime()        const override  { return 0.05f; }
 };
 
 class ColorCycleStar : public Star
 {
-    protected:
-    int         _brightness;
-
-    public:
-
-    ColorCycleStar(const CRGBPalette16 & palette, TBlendType blendType = LINEARBLEND, float maxSpeed = 2.0, int speedDivisor = 1)
-      : Star(palette, blendType, maxSpeed)
-    {
-        _brightness = random_range(128,255);
-    }
+  public:
 
-    static int GetStarTypeNumber()
+    static constexpr int GetStarTypeNumber()
     {
         return EFFECT_STAR_COLOR_CYCLE;
     }
-
-    virtual CRGB Render(TBlendType blend)
-    {
-        CRGB c = ColorFromPalette(_palette, millis() / 2048.0f, _brightness, blend);
-        fadeToBlackBy(&c, 1, 255 * FadeoutAmount());
-        return c;
-    }
-
-    ~ColorCycleStar() override
-    {}
-
-    float PreignitionTime() const override { return 2.0f; }
-    float IgnitionTime()    const override { return 0.0f;}
-    float HoldTime()        const override { return 2.00f; }
-    float FadeTime()        const override { return 0.5f;  }
-    virtual float StarSize()        const { return 1;     }
 };
 
 class MultiColorStar : public Star
 {
-    protected:
-    uint8_t         _brightness;
-    uint8_t         _hue;
-
-    public:
-    MultiColorStar(const CRGBPalette16 & palette, TBlendType blendType = LINEARBLEND, float maxSpeed = 2.0, int speedDivisor = 1)
-      : Star(palette, blendType, maxSpeed)
-    {
-        _brightness = random_range(128,255);
-        _hue        = random_range(0, 255);
-    }
-
-    virtual CRGB Render(TBlendType blend)
-    {
-        CRGB c = ColorFromPalette(_palette, _hue, _brightness, blend);
-        fadeToBlackBy(&c, 1, 255 * FadeoutAmount());
-        return c;
-    }
-
-    ~MultiColorStar() override
-    {}
+  public:
 
-    static int GetStarTypeNumber()
+    static constexpr int GetStarTypeNumber()
     {
         return EFFECT_STAR_MULTI_COLOR;
     }
-
-    float PreignitionTime() const override { return 2.0f; }
-    float IgnitionTime()    const override { return 0.0f; }
-    float HoldTime()        const override { return 2.00f;}
-    float FadeTime()        const override { return 0.5f; }
-    virtual float StarSize()        const { return 1;    }
 };
 
 class ChristmasLightStar : public Star
 {
   public:
 
-    ChristmasLightStar(const CRGBPalette16 & palette, TBlendType blendType, float maxSpeed = 0.0)
-      : Star(palette, blendType, maxSpeed, 1.0)
-
+    static constexpr int GetStarTypeNumber()
     {
-        int iColor = random_range(0,255);
-        _colorIndex = iColor;
+        return EFFECT_STAR_CHRISTMAS;
     }
 
-    ~ChristmasLightStar() override
-    {}
-
-    static int GetStarTypeNumber()
+    static uint8_t NewColorIndex()
     {
-        return EFFECT_STAR_CHRISTMAS;
+        return random_range(0,255);
     }
-
-    float PreignitionTime() const override { return 0.20f; }
-    float IgnitionTime()    const override { return 0.00f; }
-    float HoldTime()        const override { return 6.0f;  }
-    float FadeTime()        const override { return 1.25f; }
-    virtual float StarSize()        const { return 0.00f; }
 };
 
 // Hot white stars that cool down through white, yellow, red
@@ -354,35 +214,13 @@ class HotWhiteStar : public Star
 {
   public:
 
-    HotWhiteStar(const CRGBPalette16 & palette, TBlendType blendType = LINEARBLEND, float maxSpeed = 0.0, float size = 0.0)
-      : Star(palette, blendType, maxSpeed, size)
-    {
-    }
-
-    ~HotWhiteStar() override
-    {}
-
-    static int GetStarTypeNumber()
+    static constexpr int GetStarTypeNumber()
     {
         return EFFECT_STAR_HOT_WHITE;
     }
-
-    float PreignitionTime() const override { return 0.00f;  }
-    float IgnitionTime()    const override { return 0.20f;  }
-    float HoldTime()        const override { return 0.00f;  }
-    float FadeTime()        const override { return 2.00f;  }
-
-    virtual CRGB RenderColor(TBlendType blend)
-    {
-        if (Age() < IgnitionTime() + HoldTime())
-            return CRGB::White;
-        CRGB c = ColorFromPalette(_palette, 130*(1.0f-FadeoutAmount()), 256*(1.0f-FadeoutAmount()), blend);
-        return c;
-    }
 };
 
 
-
 /*
 template <typename ObjectType> class BeatStarterEffect : public BeatEffectBase
 {
@@ -418,7 +256,7 @@ template <typename ObjectType> class BeatStarterEffect : public BeatEffectBase
 template <typename StarType> class StarryNightEffect : public LEDStripEffect
 {
   protected:
-    std::deque<StarType>         _allParticles;
+    ParticlePool<uint8_t>        _allParticles;         // Each star's attributes are just its palette index
     const CRGBPalette16         _palette;
     float                        _newStarProbability;
     float                        _starSize;
@@ -497,6 +335,24 @@ template <typename StarType> class StarryNightEffect : public LEDStripEffect
         LEDStripEffect::setAllOnAllChannels(_skyColor.r, _skyColor.g, _skyColor.b);
     }
 
+    // There can be as many stars as there are LEDs, so that's how big the pool gets if there's room for it; if
+    // not, we make do with as many as fit. Effects stay loaded on strips, so the pool is only kept while we're
+    // showing.
+
+    void Prepare() override
+    {
+        if (_allParticles.Capacity() == _cLEDs)
+            return;
+
+        for (size_t capacity = _cLEDs; capacity > 0 && !_allParticles.SetCapacity(capacity); capacity /= 2)
+            debugW("No room for %zu stars, trying half as many", capacity);
+    }
+
+    void Stop() override
+    {
+        _allParticles.Release();
+    }
+
 
     virtual void CreateStars()
     {
@@ -514,29 +370,23 @@ template <typename StarType> class StarryNightEffect : public LEDStripEffect
             constexpr auto kProbabilitySpan = 2.5;
             if (random_range(0.0, kProbabilitySpan) < g_Values.AppTime.LastFrameTime() * prob)
             {
-                StarType newstar(_palette, _blendType, _maxSpeed * _musicFactor, _starSize);
+                // If every slot is taken the new star is dropped, rather than cutting an older one short
+                if (_allParticles.IsFull())
+                    break;
+
                 // This always starts stars on even pixel boundaries so they look like the desired width if not moving
-                newstar._iPos = (int) random_range(0U, _cLEDs-1-starWidth);
-                _allParticles.push_back(newstar);
+                const float position = (int) random_range(0U, _cLEDs-1-starWidth);
+                const float maxSpeed = _maxSpeed * _musicFactor;
+                const float velocity = random_range(0.0f, maxSpeed * 2) - maxSpeed;
+
+                _allParticles.Spawn(kTiming.Lifetime(), CRGB::Black, position, velocity) = StarType::NewColorIndex();
             }
         }
     }
 
-    virtual void Update()
-    {
-        // Any particles that have lived their lifespan can be removed.  They should be found at the back of the array
-        while (_allParticles.size() > 0 && (_allParticles.front().Age() >= _allParticles.front().TotalLifetime()))
-            _allParticles.pop_front();
-
-        // If we've created too many stars, prune the newest first, before they get painted
-        while (_allParticles.size() > cMaxStars)
-            _allParticles.pop_back();
-    }
-
     void Draw() override
     {
         CreateStars();
-        Update();
 
         if (_blurFactor == 0)
         {
@@ -548,16 +398,28 @@ template <typename StarType> class StarryNightEffect : public LEDStripEffect
             fadeAllChannelsToBlackBy(55 * (2.0 - g_Analyzer._VURatioFade));
         }
 
-        //Serial.printf("Stars: %d Deltatime: %lf\n", _allParticles.size(), g_AppTime.DeltaTime());
-        for(auto i = _allParticles.begin(); i != _allParticles.end(); i++)
+        // Expired stars are dropped as we go; the rest drift, then fade in, flash and fade out on their type's timing
+
+        const float deltaTime = g_Values.AppTime.LastFrameTime();
+        const auto  gfx = g();
+
+        _allParticles.Update([&](PooledParticle<uint8_t> & star)
         {
-            i->UpdatePosition();
-            float fPos = i->_iPos;
-            CRGB c = i->ObjectColor();
-            g()->setPixelsF(fPos - i->_objectSize / 2.0, i->_objectSize, c, true);
-        }
+            star.position += star.velocity * deltaTime;
+
+            const float fadeout = FadingObject::FadeoutAmountAt(star.age, kTiming.preignition, kTiming.ignition, kTiming.hold, kTiming.fade);
+            const bool  igniting = star.age >= kTiming.preignition && star.age < kTiming.preignition + kTiming.ignition;
+
+            CRGB c = igniting ? CRGB(CRGB::White) : ColorFromPalette(_palette, star.attributes, 255, _blendType);
+            fadeToBlackBy(&c, 1, 255 * fadeout);
+            gfx->setPixelsF(star.position - _starSize / 2.0, _starSize, c, true);
+        });
     }
 
+  private:
+
+    static constexpr StarTiming kTiming = g_StarTimings[StarType::GetStarTypeNumber()];
+
 
 };
 
@@ -226,7 +226,7 @@ const CRGBPalette16 USAColors_p =
 
 const CRGBPalette16 rainbowPalette(RainbowColors_p);
 
-extern DRAM_ATTR std::unique_ptr<EffectFactories> g_ptrEffectFactories;
+extern DRAM_ATTR psram_unique_ptr<EffectFactories> g_ptrEffectFactories;
 
 // Adds a default and JSON effect factory for a specific effect number and type.
 //   All parameters beyond effectNumber and effectType will be passed on to the default effect constructor.
@@ -0,0 +1,278 @@
+//+--------------------------------------------------------------------------
+//
+// File:        firekernel.h
+//
+// NightDriverStrip - (c) 2018 Plummer's Software LLC.  All Rights Reserved.
+//
+// This file is part of the NightDriver software project.
+//
+//    NightDriver is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    NightDriver is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with Nightdriver.  It is normally found in copying.txt
+//    If not, see <https://www.gnu.org/licenses/>.
+//
+//
+// Description:
+//
+//    The pieces shared by the fire effects: heat cells that diffuse
+//    without wrapping their index, a cheap per-frame random generator,
+//    and tables that turn heat into color with a single lookup.
+//
+//
+// History:     Oct-19-2026                     Created for NightDriverStrip
+//
+//---------------------------------------------------------------------------
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include "FastLED.h"
+#include "types.h"
+
+// HeatRampColor
+//
+// The classic three band heat ramp: black through red, then yellow, then white as the temperature rises
+
+inline CRGB HeatRampColor(uint8_t temperature)
+{
+    // Scale 'heat' down from 0-255 to 0-191
+    uint8_t t192 = round((temperature / 255.0) * 191);
+
+    // calculate ramp up from
+    uint8_t heatramp = t192 & 0x3F; // 0..63
+    heatramp <<= 2;                 // scale up to 0..252
+
+    // figure out which third of the spectrum we're in:
+    if (t192 > 0x80)                        // hottest
+        return CRGB(255, 255, heatramp);
+    else if (t192 > 0x40)                   // middle
+        return CRGB(255, heatramp, 0);
+    else                                    // coolest
+        return CRGB(heatramp, 0, 0);
+}
+
+// HeatColorTable
+//
+// The color for every possible heat value, worked out once so that turning heat into color is a table lookup.
+// Fires that draw from a palette can use PaletteLUT instead; this is for any other mapping of heat to color.
+
+class HeatColorTable
+{
+    std::array<CRGB, 256> _colors;
+    bool _built = false;
+
+  public:
+
+    template <typename ColorForHeat>
+    void Build(ColorForHeat colorForHeat)
+    {
+        for (int heat = 0; heat < 256; heat++)
+            _colors[heat] = colorForHeat((uint8_t) heat);
+        _built = true;
+    }
+
+    bool IsBuilt() const
+    {
+        return _built;
+    }
+
+    const CRGB & operator[](uint8_t heat) const
+    {
+        return _colors[heat];
+    }
+};
+
+// FlameColorTables
+//
+// The noise driven matrix fires work out a signed heat per pixel and draw it with a brightness that falls off as
+// the heat rises. Heat at or below zero is drawn at zero brightness but still takes its color from the wrapped
+// byte value, so it gets a table of its own. ColorForHeat is called as colorForHeat(heat, brightness).
+
+class FlameColorTables
+{
+    HeatColorTable _flame;
+    HeatColorTable _embers;
+
+  public:
+
+    template <typename ColorForHeat>
+    void Build(ColorForHeat colorForHeat)
+    {
+        _flame.Build([&](uint8_t heat)
+        {
+            return colorForHeat(heat, heat == 0 ? (uint8_t) 0 : (uint8_t)(256 - (heat * 0.2)));
+        });
+        _embers.Build([&](uint8_t heat) { return colorForHeat(heat, (uint8_t) 0); });
+    }
+
+    bool IsBuilt() const
+    {
+        return _flame.IsBuilt();
+    }
+
+    // Heat runs from -255 to 255
+    const CRGB & operator[](int16_t heat) const
+    {
+        return heat > 0 ? _flame[heat] : _embers[(uint8_t) heat];
+    }
+};
+
+// FireRandom
+//
+// Xorshift generator for the many small random numbers a fire needs each frame. Seed it once per frame from the
+// system's random source and it hands out numbers for a few instructions each, with no division.
+
+class FireRandom
+{
+    uint32_t _state = 1;
+
+  public:
+
+    void Seed(uint32_t seed)
+    {
+        _state = seed ? seed : 1;
+    }
+
+    uint32_t Next()
+    {
+        _state ^= _state << 13;
+        _state ^= _state >> 17;
+        _state ^= _state << 5;
+        return _state;
+    }
+
+    // Uniform in [0, limit), for limits up to 65536
+    uint32_t Below(uint32_t limit)
+    {
+        return ((Next() >> 16) * limit) >> 16;
+    }
+
+    // Uniform in [low, high)
+    int Between(int low, int high)
+    {
+        return low + Below(high - low);
+    }
+};
+
+// FireKernel
+//
+// The heat cells of a one dimensional fire and the steps that animate them. The cells are followed by a few
+// cells of padding that mirror the first ones, so diffusion can read past the end of the fire without wrapping
+// its index around.
+
+class FireKernel
+{
+    static constexpr int kPadding = 3;
+
+    std::vector<uint8_t, psram_allocator<uint8_t>> _heat;
+    int _cellCount = 0;
+    FireRandom _random;
+
+  public:
+
+    explicit FireKernel(int cellCount = 0)
+    {
+        Resize(cellCount);
+    }
+
+    // Sets the number of cells and makes them all cold
+    void Resize(int cellCount)
+    {
+        _cellCount = std::max(cellCount, 0);
+        _heat.assign(_cellCount + kPadding, 0);
+    }
+
+    int CellCount() const
+    {
+        return _cellCount;
+    }
+
+    uint8_t & operator[](int cell)
+    {
+        return _heat[cell];
+    }
+
+    FireRandom & Random()
+    {
+        return _random;
+    }
+
+    // Call at the start of each frame, before using Random()
+    void NewFrame()
+    {
+        _random.Seed(random(INT32_MAX));
+    }
+
+    // Cools every cell by a random amount below maxCooling, scaled by scale/256, stopping at zero
+
+    void Cool(int maxCooling, uint16_t scale = 256)
+    {
+        for (int i = 0; i < _cellCount; i++)
+        {
+            int cooldown = (_random.Below(maxCooling) * scale) >> 8;
+            _heat[i] = cooldown > _heat[i] ? 0 : _heat[i] - cooldown;
+        }
+    }
+
+    // Drifts heat toward the start of the fire: each cell becomes a weighted average of itself and the three
+    // cells after it, wrapping around at the end. Cells are updated in place from the start, so the wrapped
+    // reads at the end see the first cells' new values; that's why the padding is refreshed only after them.
+
+    template <uint8_t BlendSelf, uint8_t BlendNeighbor1, uint8_t BlendNeighbor2, uint8_t BlendNeighbor3>
+    void DiffuseTowardStart()
+    {
+        constexpr unsigned BlendTotal = BlendSelf + BlendNeighbor1 + BlendNeighbor2 + BlendNeighbor3;
+        uint8_t * heat = _heat.data();
+
+        auto blend = [heat](int i)
+        {
+            heat[i] = (heat[i] * BlendSelf +
+                       heat[i + 1] * BlendNeighbor1 +
+                       heat[i + 2] * BlendNeighbor2 +
+                       heat[i + 3] * BlendNeighbor3) / BlendTotal;
+        };
+
+        // Fires too short for the first cells' neighbors to stay clear of the end take the slow way around
+        if (_cellCount < 2 * kPadding)
+        {
+            for (int i = 0; i < _cellCount; i++)
+                heat[i] = (heat[i] * BlendSelf +
+                           heat[(i + 1) % _cellCount] * BlendNeighbor1 +
+                           heat[(i + 2) % _cellCount] * BlendNeighbor2 +
+                           heat[(i + 3) % _cellCount] * BlendNeighbor3) / BlendTotal;
+            return;
+        }
+
+        for (int i = 0; i < kPadding; i++)
+            blend(i);
+
+        memcpy(heat + _cellCount, heat, kPadding);
+
+        for (int i = kPadding; i < _cellCount; i++)
+            blend(i);
+    }
+
+    // Drifts heat toward the end of the fire: from the end back, each cell becomes the average of the three
+    // cells before it. The first three cells are left alone.
+
+    void DiffuseTowardEnd()
+    {
+        uint8_t * heat = _heat.data();
+
+        for (int k = _cellCount - 1; k >= 3; k--)
+            heat[k] = (heat[k - 1] + heat[k - 2] + heat[k - 3]) / 3;
+    }
+};
@@ -0,0 +1,181 @@
+//+--------------------------------------------------------------------------
+//
+// File:        framekernels.h
+//
+// NightDriverStrip - (c) 2018 Plummer's Software LLC.  All Rights Reserved.
+//
+// This file is part of the NightDriver software project.
+//
+//    NightDriver is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    NightDriver is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with Nightdriver.  It is normally found in copying.txt
+//    If not, see <https://www.gnu.org/licenses/>.
+//
+//
+// Description:
+//
+//    Full-frame byte kernels that work on four color channels at a time
+//    by packing them into a 32-bit word (SWAR). Results are bit-for-bit
+//    the same as FastLED's per-pixel nscale8, nscale8_video and
+//    saturating += on CRGB, so callers can switch over freely.
+//
+//
+// History:     Oct-19-2026                     Created for NightDriverStrip
+//
+//---------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "pixeltypes.h"
+
+// Single byte versions, used for the ragged ends of a buffer
+
+inline uint8_t ScaleByte(uint8_t value, uint8_t scale)
+{
+    return (value * (scale + 1)) >> 8;
+}
+
+inline uint8_t ScaleByteVideo(uint8_t value, uint8_t scale)
+{
+    return value == 0 ? 0 : ((value * scale) >> 8) + (scale != 0 ? 1 : 0);
+}
+
+inline uint8_t AddByteSaturated(uint8_t a, uint8_t b)
+{
+    unsigned sum = a + b;
+    return sum > 255 ? 255 : sum;
+}
+
+// Word versions. The even and odd bytes of the word are multiplied separately so each product gets 16 bits
+// of room, which is enough for 255 * 256.
+
+inline uint32_t ScaleWord(uint32_t word, uint8_t scale)
+{
+    const uint32_t factor = scale + 1;
+    const uint32_t even = (((word & 0x00FF00FF) * factor) >> 8) & 0x00FF00FF;
+    const uint32_t odd  = (((word >> 8) & 0x00FF00FF) * factor) & 0xFF00FF00;
+    return even | odd;
+}
+
+inline uint32_t ScaleWordVideo(uint32_t word, uint8_t scale)
+{
+    const uint32_t even = (((word & 0x00FF00FF) * scale) >> 8) & 0x00FF00FF;
+    const uint32_t odd  = (((word >> 8) & 0x00FF00FF) * scale) & 0xFF00FF00;
+
+    if (scale == 0)
+        return 0;
+
+    // Add one to every byte that was nonzero to begin with; the scaled byte is at most 254, so this can't carry
+    const uint32_t nonZero = (((word & 0x7F7F7F7F) + 0x7F7F7F7F) | word) & 0x80808080;
+    return (even | odd) + (nonZero >> 7);
+}
+
+inline uint32_t AddWordSaturated(uint32_t a, uint32_t b)
+{
+    // Add the low seven bits of each byte without carries crossing into the next byte, then fix up the top bits
+    const uint32_t low  = (a & 0x7F7F7F7F) + (b & 0x7F7F7F7F);
+    const uint32_t sum  = low ^ ((a ^ b) & 0x80808080);
+    const uint32_t carry = ((a & b) | ((a | b) & ~sum)) & 0x80808080;
+    return sum | ((carry >> 7) * 0xFF);
+}
+
+// ForEachWord
+//
+// Applies wordOp to every aligned word in the buffer and byteOp to any bytes before the first and after the
+// last of those. Loads and stores go through memcpy so we don't break aliasing rules; on aligned addresses
+// that compiles down to plain word loads and stores.
+
+template<typename WordOp, typename ByteOp>
+inline void ForEachWord(uint8_t * bytes, size_t count, WordOp wordOp, ByteOp byteOp)
+{
+    while (count && (reinterpret_cast<uintptr_t>(bytes) & 3))
+    {
+        *bytes = byteOp(*bytes);
+        bytes++;
+        count--;
+    }
+
+    uint8_t * words = static_cast<uint8_t *>(__builtin_assume_aligned(bytes, 4));
+    for (; count >= 4; count -= 4, words += 4)
+    {
+        uint32_t word;
+        memcpy(&word, words, 4);
+        word = wordOp(word);
+        memcpy(words, &word, 4);
+    }
+
+    for (; count; count--, words++)
+        *words = byteOp(*words);
+}
+
+// Same as above for a destination buffer that's combined with a source buffer of the same length
+
+template<typename WordOp, typename ByteOp>
+inline void ForEachWord(uint8_t * dest, const uint8_t * source, size_t count, WordOp wordOp, ByteOp byteOp)
+{
+    while (count && (reinterpret_cast<uintptr_t>(dest) & 3))
+    {
+        *dest = byteOp(*dest, *source++);
+        dest++;
+        count--;
+    }
+
+    uint8_t * words = static_cast<uint8_t *>(__builtin_assume_aligned(dest, 4));
+    for (; count >= 4; count -= 4, words += 4, source += 4)
+    {
+        uint32_t word, sourceWord;
+        memcpy(&word, words, 4);
+        memcpy(&sourceWord, source, 4);
+        word = wordOp(word, sourceWord);
+        memcpy(words, &word, 4);
+    }
+
+    for (; count; count--, words++)
+        *words = byteOp(*words, *source++);
+}
+
+// Pixel buffer kernels. CRGB is three packed bytes, so a run of pixels is just a run of bytes to us.
+
+// Same as calling nscale8(scale) on each pixel
+inline void ScalePixels(CRGB * pixels, size_t count, uint8_t scale)
+{
+    ForEachWord(reinterpret_cast<uint8_t *>(pixels), count * sizeof(CRGB),
+                [scale](uint32_t word) { return ScaleWord(word, scale); },
+                [scale](uint8_t value) { return ScaleByte(value, scale); });
+}
+
+// Same as calling nscale8_video(scale) on each pixel
+inline void ScalePixelsVideo(CRGB * pixels, size_t count, uint8_t scale)
+{
+    ForEachWord(reinterpret_cast<uint8_t *>(pixels), count * sizeof(CRGB),
+                [scale](uint32_t word) { return ScaleWordVideo(word, scale); },
+                [scale](uint8_t value) { return ScaleByteVideo(value, scale); });
+}
+
+// Same as dest[i] += source[i]
+inline void AddPixels(CRGB * dest, const CRGB * source, size_t count)
+{
+    ForEachWord(reinterpret_cast<uint8_t *>(dest), reinterpret_cast<const uint8_t *>(source), count * sizeof(CRGB),
+                [](uint32_t a, uint32_t b) { return AddWordSaturated(a, b); },
+                [](uint8_t a, uint8_t b) { return AddByteSaturated(a, b); });
+}
+
+// Same as dest[i] += source[i] followed by dest[i].nscale8(scale), in one pass
+inline void AddAndScalePixels(CRGB * dest, const CRGB * source, size_t count, uint8_t scale)
+{
+    ForEachWord(reinterpret_cast<uint8_t *>(dest), reinterpret_cast<const uint8_t *>(source), count * sizeof(CRGB),
+                [scale](uint32_t a, uint32_t b) { return ScaleWord(AddWordSaturated(a, b), scale); },
+                [scale](uint8_t a, uint8_t b) { return ScaleByte(AddByteSaturated(a, b), scale); });
+}
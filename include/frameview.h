@@ -0,0 +1,110 @@
+//+--------------------------------------------------------------------------
+//
+// File:        frameview.h
+//
+// NightDriverStrip - (c) 2018 Plummer's Software LLC.  All Rights Reserved.
+//
+// This file is part of the NightDriver software project.
+//
+//    NightDriver is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    NightDriver is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with Nightdriver.  It is normally found in copying.txt
+//    If not, see <https://www.gnu.org/licenses/>.
+//
+//
+// Description:
+//
+//    Lightweight pixel accessor for effect inner loops. Unlike the
+//    GFXBase pixel methods it makes no virtual calls, and it lets the
+//    caller choose between checked and unchecked access.
+//
+//
+// History:     Oct-19-2026                     Created for NightDriverStrip
+//
+//---------------------------------------------------------------------------
+
+#pragma once
+
+#include "pixeltypes.h"
+
+// FrameView
+//
+// Wraps the current pixel buffer of a GFX device of concrete type GFX. Indexing and dimensions come from the
+// non-virtual PixelIndex(), FrameWidth() and FrameHeight() of that type, so for a device with a fixed layout
+// (like LEDMatrixGFX) they compile down to constants and a multiply-add.
+//
+// The operator() accessors don't check their coordinates; use them where the loop bounds already guarantee
+// the pixel is on the device. The Try and GetOr variants quietly ignore positions that are off the device.
+//
+// A FrameView captures the device's leds pointer when it's made, and that changes between frames on double
+// buffered devices, so make a fresh one per frame rather than keeping one around.
+
+template<typename GFX>
+class FrameView
+{
+    GFX & _gfx;
+    CRGB * const _leds;
+
+  public:
+
+    explicit FrameView(GFX & gfx) : _gfx(gfx), _leds(gfx.leds)
+    {
+    }
+
+    size_t Width() const
+    {
+        return _gfx.FrameWidth();
+    }
+
+    size_t Height() const
+    {
+        return _gfx.FrameHeight();
+    }
+
+    bool Contains(int x, int y) const
+    {
+        return x >= 0 && y >= 0 && (size_t)x < Width() && (size_t)y < Height();
+    }
+
+    CRGB & operator()(int x, int y)
+    {
+        return _leds[_gfx.PixelIndex(x, y)];
+    }
+
+    const CRGB & operator()(int x, int y) const
+    {
+        return _leds[_gfx.PixelIndex(x, y)];
+    }
+
+    bool TrySet(int x, int y, CRGB color)
+    {
+        if (!Contains(x, y))
+            return false;
+
+        (*this)(x, y) = color;
+        return true;
+    }
+
+    bool TryAdd(int x, int y, CRGB color)
+    {
+        if (!Contains(x, y))
+            return false;
+
+        (*this)(x, y) += color;
+        return true;
+    }
+
+    CRGB GetOr(int x, int y, CRGB fallback = CRGB::Black) const
+    {
+        return Contains(x, y) ? (*this)(x, y) : fallback;
+    }
+};
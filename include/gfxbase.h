@@ -70,6 +70,18 @@
 #include "effects/matrix/Boid.h"
 #include "effects/matrix/Vector.h"
 #include "globals.h"
+#include "framekernels.h"
+#include "noisefield.h"
+#include "palettelut.h"
+
+// Builds with an irregular layout can drop in a custom_xymap.h that defines the pixel index of every x/y
+// position as const uint16_t CustomXYMap[XY_TABLE_HEIGHT * XY_TABLE_WIDTH], in row order.
+#if __has_include("custom_xymap.h")
+    #include "custom_xymap.h"
+    #define HAS_CUSTOM_XYMAP 1
+#else
+    #define HAS_CUSTOM_XYMAP 0
+#endif
 #include <memory>
 
 #if USE_HUB75
@@ -84,7 +96,7 @@
         uint32_t noise_z;
         uint32_t noise_scale_x;
         uint32_t noise_scale_y;
-        uint8_t  noise[MATRIX_WIDTH][MATRIX_HEIGHT];
+        uint8_t  noise[MATRIX_HEIGHT][MATRIX_WIDTH];     // Row-major, so noise[y][x]
         uint8_t  noisesmoothing;
     } Noise;
 
@@ -123,18 +135,49 @@ protected:
     CRGBPalette16 _targetPalette;
     String _currentPaletteName;
 
+    // Bumped whenever _currentPalette changes, so ColorFromPaletteLUT knows when to rebuild its table
+    uint32_t _paletteGeneration = 0;
+
+    void SetCurrentPalette(const CRGBPalette16 & palette)
+    {
+        if (_currentPalette == palette)
+            return;
+
+        _currentPalette = palette;
+        _paletteGeneration++;
+    }
+
+    mutable uint32_t _paletteLUTGeneration = UINT32_MAX;
+    mutable PaletteLUT _paletteLUT;
+
     #if USE_NOISE
         std::unique_ptr<Noise> _ptrNoise;
+        std::unique_ptr<NoiseField> _noiseField;
+
+        // Blends fresh noise centered on (centerX, centerY) into _ptrNoise->noise; see FillGetNoise()
+        void FillNoise(int centerX, int centerY, uint8_t freshWeight, bool halfResolution);
     #endif
 
     static const int _heatColorsPaletteIndex = 6;
     static const int _randomPaletteIndex = 9;
 
+    #if USE_XY_TABLE
+        std::unique_ptr<uint16_t[]> _xyTable;       // Result of xy() for every x/y in range; see BuildXYTable()
+    #endif
+
+    // Scratch space for the blur functions, kept around so we don't allocate on every frame
+    std::vector<CRGB> _blurRowScratch;
+    std::vector<uint32_t> _blurSumScratch;
+
+    // Range of leds[] indices written since the frame was last output; starts out as the whole frame
+    size_t _dirtyBegin = 0;
+    size_t _dirtyEnd = SIZE_MAX;
+
 public:
     // Many of the Aurora effects need direct access to these from external classes
 
     CRGB *leds = nullptr;
-    std::unique_ptr<Boid[]> _boids;
+    psram_unique_ptr<Boid[]> _boids;
 
     // Definition moved to GFXBase.cpp because it uses the FillGetNoise() function template
     GFXBase(int w, int h);
@@ -150,7 +193,8 @@ public:
     }
     #endif
 
-    CRGBPalette16 &GetCurrentPalette()
+    // Read only, so PaletteGeneration() only has to change when one of our own functions changes the palette
+    const CRGBPalette16 &GetCurrentPalette() const
     {
         return _currentPalette;
     }
@@ -212,12 +256,63 @@ public:
         return to16bit(CRGB(code));
     }
 
+    // Dirty span
+    //
+    // The drawing primitives in this class record which part of leds[] they've written to since the frame was
+    // last output, so the code that consumes the frame can skip what didn't change, or the whole frame if
+    // nothing did. Code that writes to leds[] directly has to call MarkDirty itself. Effects that don't promise
+    // to do that (see LEDStripEffect::TracksDirtyRegion) have their whole frame marked after every draw.
+
+    void MarkDirty(size_t index)
+    {
+        _dirtyBegin = std::min(_dirtyBegin, index);
+        _dirtyEnd = std::max(_dirtyEnd, index + 1);
+    }
+
+    // Marks the indices from begin up to, but not including, end
+    void MarkDirty(size_t begin, size_t end)
+    {
+        if (begin >= end)
+            return;
+
+        _dirtyBegin = std::min(_dirtyBegin, begin);
+        _dirtyEnd = std::max(_dirtyEnd, end);
+    }
+
+    void MarkAllDirty()
+    {
+        _dirtyBegin = 0;
+        _dirtyEnd = _width * _height;
+    }
+
+    void ClearDirty()
+    {
+        _dirtyBegin = SIZE_MAX;
+        _dirtyEnd = 0;
+    }
+
+    bool IsFrameDirty() const
+    {
+        return _dirtyBegin < _dirtyEnd;
+    }
+
+    size_t DirtyBegin() const
+    {
+        return _dirtyBegin;
+    }
+
+    size_t DirtyEnd() const
+    {
+        return std::min(_dirtyEnd, _width * _height);
+    }
+
     virtual void Clear(CRGB color = CRGB::Black)
     {
         if (color == CRGB::Black)
             memset(leds, 0, sizeof(CRGB) * _width * _height);
         else
             fill_solid(leds, _width * _height, color);
+        MarkAllDirty();
     }
     virtual bool isValidPixel(uint x, uint y) const
     {
@@ -249,6 +344,11 @@ public:
 
     virtual uint16_t xy(uint16_t x, uint16_t y) const
     {
+        #if HAS_CUSTOM_XYMAP
+            if (x < XY_TABLE_WIDTH && y < XY_TABLE_HEIGHT)
+                return CustomXYMap[y * XY_TABLE_WIDTH + x];
+        #endif
+
         if (x & 0x01)
         {
             // Odd rows run backwards
@@ -268,10 +368,55 @@ public:
 
     #if USE_HUB75
         #define XY(x, y) ((y) * MATRIX_WIDTH + (x))
+    #elif USE_XY_TABLE
+        #define XY(x, y) xyLookup(x, y)
     #else
         #define XY(x, y) xy(x, y)
     #endif
 
+    // BuildXYTable
+    //
+    // Fills the XY() lookup table by asking xy() for every position once. This has to happen after construction,
+    // as xy() is virtual and the derived class' version isn't reachable from the GFXBase constructor.
+
+    void BuildXYTable()
+    {
+        #if USE_XY_TABLE
+            _xyTable = std::make_unique<uint16_t[]>(XY_TABLE_WIDTH * XY_TABLE_HEIGHT);
+            for (uint16_t y = 0; y < XY_TABLE_HEIGHT; y++)
+                for (uint16_t x = 0; x < XY_TABLE_WIDTH; x++)
+                    _xyTable[y * XY_TABLE_WIDTH + x] = xy(x, y);
+        #endif
+    }
+
+    #if USE_XY_TABLE
+        uint16_t xyLookup(uint16_t x, uint16_t y) const
+        {
+            if (x < XY_TABLE_WIDTH && y < XY_TABLE_HEIGHT)
+                return _xyTable[y * XY_TABLE_WIDTH + x];
+
+            return xy(x, y);
+        }
+    #endif
+
+    // Non-virtual layout accessors used by FrameView. Devices with a fixed layout hide these with compile-time
+    // versions, which FrameView picks up when it's instantiated for that device type.
+
+    uint16_t PixelIndex(uint16_t x, uint16_t y) const
+    {
+        return XY(x, y);
+    }
+
+    size_t FrameWidth() const
+    {
+        return _width;
+    }
+
+    size_t FrameHeight() const
+    {
+        return _height;
+    }
+
     virtual CRGB getPixel(int16_t x, int16_t y) const
     {
         if (isValidPixel(x, y))
@@ -291,13 +436,20 @@ public:
     virtual void addColor(int16_t i, CRGB c)
     {
         if (isValidPixel(i))
+        {
             leds[i] += c;
+            MarkDirty(i);
+        }
     }
 
     virtual void drawPixel(int16_t x, int16_t y, CRGB color)
     {
         if (isValidPixel(x, y))
-            leds[XY(x, y)] = color;
+        {
+            const auto index = XY(x, y);
+            leds[index] = color;
+            MarkDirty(index);
+        }
         else
             debugE("Invalid drawPixel request: x=%d, y=%d, NUM_LEDS=%d", x, y, NUM_LEDS);
     }
@@ -305,7 +457,11 @@ public:
     void drawPixel(int16_t x, int16_t y, uint16_t color) override
     {
         if (isValidPixel(x, y))
-            leds[XY(x, y)] = from16Bit(color);
+        {
+            const auto index = XY(x, y);
+            leds[index] = from16Bit(color);
+            MarkDirty(index);
+        }
         else
             debugE("Invalid drawPixel request: x=%d, y=%d, NUM_LEDS=%d", x, y, NUM_LEDS);
     }
@@ -323,7 +479,11 @@ public:
     virtual void setPixel(int16_t x, int16_t y, uint16_t color)
     {
         if (isValidPixel(x, y))
-            leds[XY(x, y)] = from16Bit(color);
+        {
+            const auto index = XY(x, y);
+            leds[index] = from16Bit(color);
+            MarkDirty(index);
+        }
         else
             debugE("Invalid setPixel request: x=%d, y=%d, NUM_LEDS=%d", x, y, NUM_LEDS);
     }
@@ -331,7 +491,11 @@ public:
     void setPixel(int16_t x, int16_t y, CRGB color)
     {
         if (isValidPixel(x, y))
-            leds[XY(x, y)] = color;
+        {
+            const auto index = XY(x, y);
+            leds[index] = color;
+            MarkDirty(index);
+        }
         else
             debugE("Invalid setPixel request: x=%d, y=%d, NUM_LEDS=%d", x, y, NUM_LEDS);
     }
@@ -348,7 +512,10 @@ public:
     virtual void setPixel(int x, CRGB color)
     {
         if (isValidPixel(x))
+        {
             leds[x] = color;
+            MarkDirty(x);
+        }
         else
             debugE("Invalid setPixel request: x=%d, NUM_LEDS=%d", x, NUM_LEDS);
     }
@@ -439,7 +606,10 @@ public:
 
         float p = fPos;
         if (p >= 0 && isValidPixel(p))
+        {
             leds[(int)p] = bMerge ? leds[(int)p] + c1 : c1;
+            MarkDirty((int)p);
+        }
 
         p = fPos + (1.0f - frac1);
         count -= (1.0f - frac1);
@@ -449,15 +619,20 @@ public:
         while (count >= 1)
         {
             if (p >= 0 && isValidPixel(p))
+            {
                 leds[(int)p] = bMerge ? leds[(int)p] + c : c;
+                MarkDirty((int)p);
+            }
             count--;
             p++;
         };
 
         // Final pixel, if in bounds
-        if (count > 0)
-            if (p >= 0 && isValidPixel(p))
-                leds[(int)p] = bMerge ? leds[(int)p] + c2 : c2;
+        if (count > 0 && p >= 0 && isValidPixel(p))
+        {
+            leds[(int)p] = bMerge ? leds[(int)p] + c2 : c2;
+            MarkDirty((int)p);
+        }
     }
 
     void blurRows(CRGB *leds, uint16_t width, uint16_t height, uint16_t first, fract8 blur_amount)
@@ -489,28 +664,53 @@ public:
         // blur columns
         uint8_t keep = 255 - blur_amount;
         uint8_t seep = blur_amount >> 1;
-        for (uint16_t col = 0; col < width; ++col)
-        {
-            CRGB carryover = CRGB::Black;
+
+        #if USE_HUB75
+            // Rows are contiguous on the matrix, so rather than walking down each column with a stride of a whole
+            // row, we walk down all columns at once a row at a time, with a row of carryover values. The result
+            // is the same as the column by column version below.
+
+            _blurRowScratch.resize(width * 2);
+            CRGB * carryover = &_blurRowScratch[0];
+            CRGB * part = &_blurRowScratch[width];
+
+            std::fill_n(carryover, width, CRGB::Black);
             for (uint16_t i = first; i < height; ++i)
             {
-                CRGB cur = leds[XY(col, i)];
-                CRGB part = cur;
-                part.nscale8(seep);
-                cur.nscale8(keep);
-                cur += carryover;
+                CRGB * row = &leds[XY(0, i)];
+                std::copy_n(row, width, part);
+                ScalePixels(part, width, seep);
+                ScalePixels(row, width, keep);
+                AddPixels(row, carryover, width);
                 if (i)
-                    leds[XY(col, i - 1)] += part;
-                leds[XY(col, i)] = cur;
-                carryover = part;
+                    AddPixels(&leds[XY(0, i - 1)], part, width);
+                std::swap(carryover, part);
             }
-        }
+        #else
+            for (uint16_t col = 0; col < width; ++col)
+            {
+                CRGB carryover = CRGB::Black;
+                for (uint16_t i = first; i < height; ++i)
+                {
+                    CRGB cur = leds[XY(col, i)];
+                    CRGB part = cur;
+                    part.nscale8(seep);
+                    cur.nscale8(keep);
+                    cur += carryover;
+                    if (i)
+                        leds[XY(col, i - 1)] += part;
+                    leds[XY(col, i)] = cur;
+                    carryover = part;
+                }
+            }
+        #endif
     }
 
     void blur2d(CRGB *leds, uint16_t width, uint16_t firstColumn, uint16_t height, uint16_t firstRow, fract8 blur_amount)
     {
         blurRows(leds, width, height, firstColumn, blur_amount);
         blurColumns(leds, width, height, firstRow, blur_amount);
+        MarkAllDirty();
     }
 
     void BlurFrame(int amount)
@@ -519,6 +719,119 @@ public:
         blur2d(leds, _width, 0, _height, 1, amount);
     }
 
+    // BoxBlur
+    //
+    // Replaces every pixel with the average of the pixels up to radius away from it horizontally and vertically,
+    // which spreads light a lot further than blur2d does. Both passes keep running sums, so the cost per pixel
+    // is the same for any radius. Near the edges we average over the pixels that exist rather than treating
+    // the outside as black, so the edges don't darken.
+
+    void BoxBlur(uint8_t radius)
+    {
+        if (radius == 0)
+            return;
+
+        MarkAllDirty();
+
+        const int width = _width;
+        const int height = _height;
+        const int ringRows = radius + 1;
+
+        _blurRowScratch.resize((ringRows + 1) * width);
+        _blurSumScratch.resize(width * 3);
+
+        // Horizontal pass, one row at a time from a copy of the row
+
+        CRGB * line = &_blurRowScratch[0];
+        for (int y = 0; y < height; y++)
+        {
+            for (int x = 0; x < width; x++)
+                line[x] = leds[XY(x, y)];
+
+            uint32_t r = 0, g = 0, b = 0, count = 0;
+            for (int x = 0; x <= std::min<int>(radius, width - 1); x++, count++)
+            {
+                r += line[x].r;
+                g += line[x].g;
+                b += line[x].b;
+            }
+
+            for (int x = 0; x < width; x++)
+            {
+                leds[XY(x, y)] = CRGB(r / count, g / count, b / count);
+
+                const int entering = x + radius + 1;
+                const int leaving = x - radius;
+                if (entering < width)
+                {
+                    r += line[entering].r;
+                    g += line[entering].g;
+                    b += line[entering].b;
+                    count++;
+                }
+                if (leaving >= 0)
+                {
+                    r -= line[leaving].r;
+                    g -= line[leaving].g;
+                    b -= line[leaving].b;
+                    count--;
+                }
+            }
+        }
+
+        // Vertical pass, a row at a time with a running sum per column. The rows we've already overwritten but
+        // still need to subtract later are kept in a ring of radius + 1 rows.
+
+        uint32_t * sums = &_blurSumScratch[0];
+        CRGB * ring = &_blurRowScratch[width];
+        std::fill_n(sums, width * 3, 0);
+
+        uint32_t count = 0;
+        for (int y = 0; y <= std::min<int>(radius, height - 1); y++, count++)
+            for (int x = 0; x < width; x++)
+            {
+                const CRGB pixel = leds[XY(x, y)];
+                sums[x * 3]     += pixel.r;
+                sums[x * 3 + 1] += pixel.g;
+                sums[x * 3 + 2] += pixel.b;
+            }
+
+        for (int y = 0; y < height; y++)
+        {
+            CRGB * saved = &ring[(y % ringRows) * width];
+            for (int x = 0; x < width; x++)
+            {
+                saved[x] = leds[XY(x, y)];
+                leds[XY(x, y)] = CRGB(sums[x * 3] / count, sums[x * 3 + 1] / count, sums[x * 3 + 2] / count);
+            }
+
+            const int entering = y + radius + 1;
+            const int leaving = y - radius;
+            if (entering < height)
+            {
+                for (int x = 0; x < width; x++)
+                {
+                    const CRGB pixel = leds[XY(x, entering)];
+                    sums[x * 3]     += pixel.r;
+                    sums[x * 3 + 1] += pixel.g;
+                    sums[x * 3 + 2] += pixel.b;
+                }
+                count++;
+            }
+            if (leaving >= 0)
+            {
+                const CRGB * old = &ring[(leaving % ringRows) * width];
+                for (int x = 0; x < width; x++)
+                {
+                    sums[x * 3]     -= old[x].r;
+                    sums[x * 3 + 1] -= old[x].g;
+                    sums[x * 3 + 2] -= old[x].b;
+                }
+                count--;
+            }
+        }
+    }
+
     void CyclePalette(int offset = 1)
     {
         loadPalette(_paletteIndex + offset);
@@ -581,12 +894,24 @@ public:
         return _palettePaused;
     }
 
+    // Changes whenever the current palette changes, so effects can tell when colors they've cached are stale
+    uint32_t PaletteGeneration() const
+    {
+        return _paletteGeneration;
+    }
+
     void UpdatePaletteCycle()
     {
 
         ChangePalettePeriodically();
         uint8_t maxChanges = 24;
-        nblendPaletteTowardPalette(_currentPalette, _targetPalette, maxChanges);
+
+        // Once the blend has reached its target nothing changes, and the palette LUT can stay as it is
+        if (memcmp(_currentPalette.entries, _targetPalette.entries, sizeof(_currentPalette.entries)))
+        {
+            nblendPaletteTowardPalette(_currentPalette, _targetPalette, maxChanges);
+            _paletteGeneration++;
+        }
     }
 
     void RandomPalette()
@@ -603,7 +928,7 @@ public:
 
     void setPalette(CRGBPalette16 palette)
     {
-        _currentPalette = palette;
+        SetCurrentPalette(palette);
         _targetPalette = palette;
         _currentPaletteName = "Custom";
     }
@@ -665,7 +990,7 @@ public:
             _currentPaletteName = "Random";
             break;
         }
-        _currentPalette = _targetPalette;
+        SetCurrentPalette(_targetPalette);
     }
 
     void setPalette(String paletteName)
@@ -1005,31 +1330,44 @@ public:
     // give it a linear tail downwards
     void StreamDown(uint8_t scale)
     {
-        for (int x = 0; x < _width; x++)
-        {
+        #if USE_HUB75
+            // Rows are contiguous on the matrix, so we can stream a whole row onto the next in one go
             for (int y = 1; y < _height; y++)
+                AddAndScalePixels(&leds[XY(0, y)], &leds[XY(0, y - 1)], _width, scale);
+            ScalePixels(&leds[XY(0, 0)], _width, scale);
+        #else
+            for (int x = 0; x < _width; x++)
             {
-                leds[XY(x, y)] += leds[XY(x, y - 1)];
-                leds[XY(x, y)].nscale8(scale);
+                for (int y = 1; y < _height; y++)
+                {
+                    leds[XY(x, y)] += leds[XY(x, y - 1)];
+                    leds[XY(x, y)].nscale8(scale);
+                }
             }
-        }
-        for (int x = 0; x < _width; x++)
-            leds[XY(x, 0)].nscale8(scale);
+            for (int x = 0; x < _width; x++)
+                leds[XY(x, 0)].nscale8(scale);
+        #endif
     }
 
     // give it a linear tail upwards
     void StreamUp(uint8_t scale)
     {
-        for (int x = 0; x < _width; x++)
-        {
+        #if USE_HUB75
             for (int y = _height - 2; y >= 0; y--)
+                AddAndScalePixels(&leds[XY(0, y)], &leds[XY(0, y + 1)], _width, scale);
+            ScalePixels(&leds[XY(0, _height - 1)], _width, scale);
+        #else
+            for (int x = 0; x < _width; x++)
             {
-                leds[XY(x, y)] += leds[XY(x, y + 1)];
-                leds[XY(x, y)].nscale8(scale);
+                for (int y = _height - 2; y >= 0; y--)
+                {
+                    leds[XY(x, y)] += leds[XY(x, y + 1)];
+                    leds[XY(x, y)].nscale8(scale);
+                }
             }
-        }
-        for (int x = 0; x < _width; x++)
-            leds[XY(x, _height - 1)].nscale8(scale);
+            for (int x = 0; x < _width; x++)
+                leds[XY(x, _height - 1)].nscale8(scale);
+        #endif
     }
 
     // give it a linear tail up and to the left
@@ -1159,11 +1497,8 @@ public:
 
     void DimAll(uint8_t value)
     {
-        for (int i = 0; i < NUM_LEDS; i++)
-        {
-            // if ((leds[i].r != 255) || (leds[i].g != 255) || (leds[i].b != 255))           // Don't dim pure white
-            leds[i].nscale8(value);
-        }
+        ScalePixels(leds, NUM_LEDS, value);
+        MarkAllDirty();
     }
 
     CRGB ColorFromCurrentPalette(uint8_t index = 0, uint8_t brightness = 255, TBlendType blendType = LINEARBLEND) const
@@ -1171,6 +1506,21 @@ public:
         return ColorFromPalette(_currentPalette, index, brightness, _currentBlendType);
     }
 
+    // ColorFromPaletteLUT
+    //
+    // Same result as ColorFromCurrentPalette, but from a table of all 256 colors that's only rebuilt after the
+    // current palette has changed. Use this when looking up many colors per frame.
+
+    CRGB ColorFromPaletteLUT(uint8_t index, uint8_t brightness = 255) const
+    {
+        if (_paletteLUTGeneration != _paletteGeneration)
+        {
+            _paletteLUT.Update(_currentPalette, _currentBlendType);
+            _paletteLUTGeneration = _paletteGeneration;
+        }
+        return _paletteLUT.Color(index, brightness);
+    }
+
     CRGB HsvToRgb(uint8_t h, uint8_t s, uint8_t v) const
     {
         CHSV hsv = CHSV(h, s, v);
@@ -1217,8 +1567,11 @@ public:
         //
         // The default approach for all functions is determined by the value of _defaultNoiseApproach,
         // which is defined earlier in this class.
+        //
+        // FillGetNoise() can work at half resolution, evaluating only every other row and column and
+        // interpolating the rest, for effects that don't need the fine detail.
         template<NoiseApproach = _defaultNoiseApproach>
-        void FillGetNoise();
+        void FillGetNoise(bool halfResolution = false);
 
         template<NoiseApproach = _defaultNoiseApproach>
         void MoveFractionalNoiseX(uint8_t amt, uint8_t shift = 0);
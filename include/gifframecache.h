@@ -0,0 +1,252 @@
+//+--------------------------------------------------------------------------
+//
+// File:        gifframecache.h
+//
+// NightDriverStrip - (c) 2018 Plummer's Software LLC.  All Rights Reserved.
+//
+// This file is part of the NightDriver software project.
+//
+//    NightDriver is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    NightDriver is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with Nightdriver.  It is normally found in copying.txt
+//    If not, see <https://www.gnu.org/licenses/>.
+//
+//
+// Description:
+//
+//    Keeps the decoded frames of recently shown animated GIFs so that
+//    looping one again is a copy rather than another trip through the
+//    LZW decoder. The cache holds at most GIF_FRAME_CACHE_BYTES of
+//    frames and lets go of the least recently used GIFs first.
+//
+//
+// History:     Oct-19-2026                     Created for NightDriverStrip
+//
+//---------------------------------------------------------------------------
+
+#pragma once
+
+#include <algorithm>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "globals.h"
+#include "types.h"
+
+// GIFFrames
+//
+// Every frame of one GIF as it ends up on the matrix, stored one after the other
+
+class GIFFrames
+{
+    uint16_t _width;
+    uint16_t _height;
+    std::vector<CRGB, psram_allocator<CRGB>> _pixels;
+
+  public:
+
+    GIFFrames(uint16_t width, uint16_t height, size_t expectedFrames = 0)
+        : _width(width),
+          _height(height)
+    {
+        _pixels.reserve(expectedFrames * FrameSize());
+    }
+
+    size_t FrameSize() const
+    {
+        return _width * _height;
+    }
+
+    size_t FrameCount() const
+    {
+        return FrameSize() ? _pixels.size() / FrameSize() : 0;
+    }
+
+    size_t Bytes() const
+    {
+        return _pixels.capacity() * sizeof(CRGB);
+    }
+
+    const CRGB * Frame(size_t index) const
+    {
+        return &_pixels[index * FrameSize()];
+    }
+
+    void AddFrame(const CRGB * frame)
+    {
+        _pixels.insert(_pixels.end(), frame, frame + FrameSize());
+    }
+};
+
+// GIFFrameCache
+//
+// Frames depend on the background color and on whether the screen is cleared between frames as well as on the
+// GIF itself, so all three make up the key. A GIF is either one of the embedded ones or an uploaded file. Entries
+// are handed out as shared pointers, so a GIF that's playing keeps its frames even if the cache drops them in the
+// meantime. Uploaded files can change under a playing GIF, though, so each file name also has a generation that
+// goes up whenever its file is replaced or deleted, which effects check to know their frames are out of date.
+
+class GIFFrameCache
+{
+  public:
+
+    struct Key
+    {
+        int    gifIndex;
+        String fileName;
+        CRGB   background;
+        bool   preClear;
+
+        bool operator==(const Key & other) const
+        {
+            return gifIndex == other.gifIndex && fileName == other.fileName && background == other.background && preClear == other.preClear;
+        }
+    };
+
+  private:
+
+    struct Entry
+    {
+        Key key;
+        std::shared_ptr<const GIFFrames> frames;
+    };
+
+    std::list<Entry> _entries;                  // Most recently used first
+    std::map<String, uint32_t> _fileGenerations;
+    size_t _bytes = 0;
+    size_t _reserved = 0;                       // Set aside for frames that are still being recorded
+    const size_t _budget;
+    std::mutex _mutex;
+
+    // Drops the least recently used entries until what we hold and what's set aside fit the budget. The caller
+    // holds the mutex.
+    void TrimToBudget()
+    {
+        while (_bytes + _reserved > _budget && !_entries.empty())
+        {
+            debugV("Dropping %zu bytes of cached GIF frames", _entries.back().frames->Bytes());
+            _bytes -= _entries.back().frames->Bytes();
+            _entries.pop_back();
+        }
+    }
+
+  public:
+
+    explicit GIFFrameCache(size_t budget) : _budget(budget)
+    {
+    }
+
+    static GIFFrameCache & Instance()
+    {
+        static GIFFrameCache cache(GIF_FRAME_CACHE_BYTES);
+        return cache;
+    }
+
+    size_t Budget() const
+    {
+        return _budget;
+    }
+
+    // Returns the frames for this key, or nullptr if we don't have them
+    std::shared_ptr<const GIFFrames> Find(const Key & key)
+    {
+        std::lock_guard<std::mutex> guard(_mutex);
+
+        for (auto it = _entries.begin(); it != _entries.end(); ++it)
+        {
+            if (it->key == key)
+            {
+                _entries.splice(_entries.begin(), _entries, it);
+                return it->frames;
+            }
+        }
+        return nullptr;
+    }
+
+    // Adds a complete set of frames, dropping the least recently used ones until we're back within budget
+    void Insert(const Key & key, std::shared_ptr<const GIFFrames> frames)
+    {
+        std::lock_guard<std::mutex> guard(_mutex);
+
+        if (frames->Bytes() > _budget)
+            return;
+
+        for (auto it = _entries.begin(); it != _entries.end(); ++it)
+        {
+            if (it->key == key)
+            {
+                _bytes -= it->frames->Bytes();
+                _entries.erase(it);
+                break;
+            }
+        }
+
+        _entries.push_front({ key, frames });
+        _bytes += frames->Bytes();
+
+        TrimToBudget();
+    }
+
+    // Sets aside room for frames that are about to be recorded, dropping entries to make it. Returns false if
+    // the recording wouldn't fit next to the ones already in progress.
+    bool Reserve(size_t bytes)
+    {
+        std::lock_guard<std::mutex> guard(_mutex);
+
+        if (_reserved + bytes > _budget)
+            return false;
+
+        _reserved += bytes;
+        TrimToBudget();
+        return true;
+    }
+
+    // Gives back room set aside by Reserve(), once the recording is inserted or abandoned
+    void Unreserve(size_t bytes)
+    {
+        std::lock_guard<std::mutex> guard(_mutex);
+
+        _reserved -= std::min(bytes, _reserved);
+    }
+
+    // Where an uploaded GIF's file is at; this changes whenever Forget() is called for it
+    uint32_t FileGeneration(const String & fileName)
+    {
+        std::lock_guard<std::mutex> guard(_mutex);
+
+        auto generation = _fileGenerations.find(fileName);
+        return generation == _fileGenerations.end() ? 0 : generation->second;
+    }
+
+    // Drops every entry for an uploaded GIF, for when the file is replaced or deleted
+    void Forget(const String & fileName)
+    {
+        std::lock_guard<std::mutex> guard(_mutex);
+
+        _fileGenerations[fileName]++;
+
+        for (auto it = _entries.begin(); it != _entries.end(); )
+        {
+            if (it->key.fileName == fileName)
+            {
+                _bytes -= it->frames->Bytes();
+                it = _entries.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+};
@@ -0,0 +1,295 @@
+//+--------------------------------------------------------------------------
+//
+// File:        gifindex.h
+//
+// NightDriverStrip - (c) 2018 Plummer's Software LLC.  All Rights Reserved.
+//
+// This file is part of the NightDriver software project.
+//
+//    NightDriver is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    NightDriver is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with Nightdriver.  It is normally found in copying.txt
+//    If not, see <https://www.gnu.org/licenses/>.
+//
+//
+// Description:
+//
+//    What we need to know about a GIF file before we show it: its size,
+//    where each frame starts and how long the frames last. We get that
+//    by walking the GIF's blocks without decoding any pixels, and keep
+//    the result next to the GIF so it only has to be done once.
+//
+//
+// History:     Oct-19-2026                     Created for NightDriverStrip
+//
+//---------------------------------------------------------------------------
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+#include "assetfiles.h"
+#include "globals.h"
+
+class GIFIndex
+{
+    // Layout of the sidecar file, which is followed by one uint32_t offset per frame
+    struct FileHeader
+    {
+        uint32_t magic;
+        uint32_t fileSize;
+        uint16_t width;
+        uint16_t height;
+        uint32_t totalDelay;
+        uint32_t frameCount;
+    };
+
+    static constexpr uint32_t kMagic = 0x31584447;        // "GDX1"
+    static constexpr size_t kHeaderSize = 13;             // Signature plus logical screen descriptor
+    static constexpr uint16_t kDefaultDelay = 10;         // What browsers use for frames that don't say, in 1/100 s
+
+    uint32_t _fileSize   = 0;
+    uint16_t _width      = 0;
+    uint16_t _height     = 0;
+    uint32_t _totalDelay = 0;                             // In 1/100 s, like the GIF itself
+    std::vector<uint32_t> _frameOffsets;
+
+    // Skips a run of data sub-blocks, each a length byte followed by that many bytes, up to the empty one
+    static bool SkipSubBlocks(BufferedFileReader & reader)
+    {
+        for (int length = reader.Read(); length != 0; length = reader.Read())
+            if (length < 0 || !reader.Skip(length))
+                return false;
+
+        return true;
+    }
+
+    static bool SkipColorTable(BufferedFileReader & reader, uint8_t flags)
+    {
+        return !(flags & 0x80) || reader.Skip(3 * (2 << (flags & 0x07)));
+    }
+
+  public:
+
+    uint16_t Width() const
+    {
+        return _width;
+    }
+
+    uint16_t Height() const
+    {
+        return _height;
+    }
+
+    size_t FrameCount() const
+    {
+        return _frameOffsets.size();
+    }
+
+    // Where the blocks that make up a frame start, its graphic control extension if it has one
+    uint32_t FrameOffset(size_t frame) const
+    {
+        return _frameOffsets[frame];
+    }
+
+    bool FitsMatrix() const
+    {
+        return _width > 0 && _height > 0 && _width <= MATRIX_WIDTH && _height <= MATRIX_HEIGHT;
+    }
+
+    // We play GIFs at a steady rate, so we take the average of the frame delays
+    uint8_t FramesPerSecond() const
+    {
+        if (_frameOffsets.empty())
+            return 0;
+
+        uint32_t averageDelay = std::max<uint32_t>(1, _totalDelay / _frameOffsets.size());
+        return std::clamp<uint32_t>(100 / averageDelay, 1, 60);
+    }
+
+    // ReadScreenSize
+    //
+    // Gets the size of the GIF from its first bytes, so an upload can be turned down before the rest arrives
+
+    static bool ReadScreenSize(const uint8_t * header, size_t length, uint16_t & width, uint16_t & height)
+    {
+        if (length < 10 || (memcmp(header, "GIF87a", 6) && memcmp(header, "GIF89a", 6)))
+            return false;
+
+        width  = header[6] | (header[7] << 8);
+        height = header[8] | (header[9] << 8);
+        return true;
+    }
+
+    // Build
+    //
+    // Walks the blocks of a whole GIF. Image data is skipped a sub-block at a time, so this reads little more
+    // than the length bytes and the headers.
+
+    bool Build(BufferedFileReader & reader)
+    {
+        uint8_t header[kHeaderSize];
+
+        _frameOffsets.clear();
+        _totalDelay = 0;
+        _fileSize = reader.Size();
+
+        if (!reader.Seek(0) || reader.Read(header, kHeaderSize) != kHeaderSize || !ReadScreenSize(header, kHeaderSize, _width, _height))
+            return false;
+
+        if (!SkipColorTable(reader, header[10]))
+            return false;
+
+        int32_t frameStart = -1;                            // Offset of a graphic control extension waiting for its image
+        uint16_t frameDelay = kDefaultDelay;
+
+        for (;;)
+        {
+            uint32_t blockStart = reader.Position();
+
+            switch (reader.Read())
+            {
+                case 0x21:                                  // Extension
+                {
+                    int label = reader.Read();
+                    if (label == 0xF9)
+                    {
+                        uint8_t control[5];                 // Block size, then flags, delay and transparent color
+                        if (reader.Read(control, sizeof(control)) != sizeof(control) || control[0] != 4 || !SkipSubBlocks(reader))
+                            return false;
+
+                        uint16_t delay = control[2] | (control[3] << 8);
+                        frameStart = blockStart;
+                        frameDelay = delay > 1 ? delay : kDefaultDelay;
+                    }
+                    else if (label < 0 || !SkipSubBlocks(reader))
+                    {
+                        return false;
+                    }
+                    break;
+                }
+
+                case 0x2C:                                  // Image descriptor
+                {
+                    uint8_t descriptor[9];
+                    if (reader.Read(descriptor, sizeof(descriptor)) != sizeof(descriptor))
+                        return false;
+
+                    if (!SkipColorTable(reader, descriptor[8]) || reader.Read() < 0 || !SkipSubBlocks(reader))
+                        return false;
+
+                    _frameOffsets.push_back(frameStart >= 0 ? frameStart : blockStart);
+                    _totalDelay += frameDelay;
+                    frameStart = -1;
+                    frameDelay = kDefaultDelay;
+                    break;
+                }
+
+                case 0x3B:                                  // Trailer
+                    return !_frameOffsets.empty();
+
+                default:
+                    return false;
+            }
+        }
+    }
+
+    // Load
+    //
+    // Reads a sidecar, as long as it was made for a GIF of the size we have now
+
+    bool Load(const String & path, size_t gifSize)
+    {
+        File file = SPIFFS.open(path, FILE_READ);
+        if (!file)
+            return false;
+
+        FileHeader header;
+        bool loaded = file.read(reinterpret_cast<uint8_t *>(&header), sizeof(header)) == sizeof(header)
+                   && header.magic == kMagic
+                   && header.fileSize == gifSize
+                   && header.frameCount > 0;
+
+        if (loaded)
+        {
+            _frameOffsets.resize(header.frameCount);
+            size_t offsetBytes = header.frameCount * sizeof(uint32_t);
+            loaded = file.read(reinterpret_cast<uint8_t *>(_frameOffsets.data()), offsetBytes) == offsetBytes;
+        }
+
+        file.close();
+
+        if (!loaded)
+        {
+            _frameOffsets.clear();
+            return false;
+        }
+
+        _fileSize   = header.fileSize;
+        _width      = header.width;
+        _height     = header.height;
+        _totalDelay = header.totalDelay;
+        return true;
+    }
+
+    bool Save(const String & path) const
+    {
+        File file = SPIFFS.open(path, FILE_WRITE);
+        if (!file)
+        {
+            debugW("Unable to open %s for writing", path.c_str());
+            return false;
+        }
+
+        FileHeader header = { kMagic, _fileSize, _width, _height, _totalDelay, (uint32_t) _frameOffsets.size() };
+        size_t offsetBytes = _frameOffsets.size() * sizeof(uint32_t);
+
+        bool saved = file.write(reinterpret_cast<const uint8_t *>(&header), sizeof(header)) == sizeof(header)
+                  && file.write(reinterpret_cast<const uint8_t *>(_frameOffsets.data()), offsetBytes) == offsetBytes;
+
+        file.close();
+
+        if (!saved)
+        {
+            debugW("Unable to write GIF index %s", path.c_str());
+            SPIFFS.remove(path);
+        }
+
+        return saved;
+    }
+
+    // ForAsset
+    //
+    // Loads the index of an uploaded GIF, building it again if the sidecar is missing or out of date. This has a
+    // reader of its own, so it can run while another GIF is streaming.
+
+    bool ForAsset(const String & name)
+    {
+        BufferedFileReader reader;
+        if (!reader.Open(Assets::Path(name)))
+            return false;
+
+        if (Load(Assets::IndexPath(name), reader.Size()))
+            return true;
+
+        debugI("Indexing GIF %s", name.c_str());
+
+        if (!Build(reader))
+        {
+            debugW("%s is not a GIF we can read", name.c_str());
+            return false;
+        }
+
+        Save(Assets::IndexPath(name));
+        return true;
+    }
+};
@@ -178,6 +178,7 @@
 #endif
 
 #define EFFECT_CROSS_FADE_TIME 1200.0    // How long for an effect to ramp brightness fader down and back during effect change
+#define EFFECT_PREPARE_LOOKAHEAD 3000    // How long before an effect change the next effect is prepared in the background
 
 // Thread priorities
 //
@@ -197,6 +198,7 @@
 #define DEBUG_PRIORITY          tskIDLE_PRIORITY+2
 #define JSONWRITER_PRIORITY     tskIDLE_PRIORITY+2
 #define COLORDATA_PRIORITY      tskIDLE_PRIORITY+2
+#define EFFECTPREPARE_PRIORITY  tskIDLE_PRIORITY+2
 
 // If you experiment and mess these up, my go-to solution is to put Drawing on Core 0, and everything else on Core 1.
 // My current core layout is as follows, and as of today it's solid as of (7/16/21).
@@ -222,6 +224,7 @@
 #define REMOTE_CORE             1
 #define JSONWRITER_CORE         0
 #define COLORDATA_CORE          1
+#define EFFECTPREPARE_CORE      0
 
 #define FASTLED_INTERNAL            1   // Suppresses the compilation banner from FastLED
 #define __STDC_FORMAT_MACROS
@@ -1118,6 +1121,48 @@ extern RemoteDebug Debug;           // Let everyone in the project know about it
 #define ENABLE_NTP              1   // Update the clock from NTP
 #endif
 
+#ifndef USE_LAZY_EFFECTS             // Only construct effects when they're about to be shown, to save memory
+    #if USE_HUB75
+        #define USE_LAZY_EFFECTS 1
+    #else
+        #define USE_LAZY_EFFECTS 0
+    #endif
+#endif
+
+#ifndef ENABLE_MEMORY_ACCOUNTING
+#define ENABLE_MEMORY_ACCOUNTING 1  // Count PSRAM helper allocations per effect, as reported by the /effects endpoint
+#endif
+
+#ifndef WARM_EFFECT_COUNT
+#define WARM_EFFECT_COUNT       4   // How many recently used effects stay loaded when USE_LAZY_EFFECTS is set
+#endif
+
+#ifndef STRIP_OUTPUT_GAMMA
+#define STRIP_OUTPUT_GAMMA      1.0 // Gamma applied by the strip output stage; 1.0 sends colors as effects drew them
+#endif
+
+#ifndef CHANNEL_POWER_LIMIT_MW
+#define CHANNEL_POWER_LIMIT_MW  0   // Most a single strip channel may draw, for channels with their own supply or wiring; 0 for no limit
+#endif
+
+#ifndef USE_XY_TABLE                // Look up XY() in a table built at startup instead of calling xy() for every pixel
+    #if !USE_HUB75 && (HEXAGON || MATRIX_HEIGHT > 1)
+        #define USE_XY_TABLE 1
+    #else
+        #define USE_XY_TABLE 0      // HUB75 is plain row-major math and single-row strips map x straight through
+    #endif
+#endif
+
+#ifndef XY_TABLE_WIDTH              // The range of x and y the XY() table covers; anything outside it falls back to xy()
+    #if HEXAGON
+        #define XY_TABLE_WIDTH  HEX_MAX_DIMENSION
+        #define XY_TABLE_HEIGHT HEX_MAX_DIMENSION
+    #else
+        #define XY_TABLE_WIDTH  MATRIX_WIDTH
+        #define XY_TABLE_HEIGHT MATRIX_HEIGHT
+    #endif
+#endif
+
 #ifndef NUM_LEDS
 #define NUM_LEDS (MATRIX_HEIGHT * MATRIX_WIDTH)
 #endif
@@ -1230,6 +1275,18 @@ extern RemoteDebug Debug;           // Let everyone in the project know about it
 #define TIME_BEFORE_LOCAL 5
 #endif
 
+#ifndef GIF_FRAME_CACHE_BYTES           // How much memory decoded animated GIF frames may take up
+  #ifdef USE_PSRAM
+    #define GIF_FRAME_CACHE_BYTES 1000000
+  #else
+    #define GIF_FRAME_CACHE_BYTES 0
+  #endif
+#endif
+
+#ifndef FILE_READ_AHEAD_BYTES           // Buffer size for files that are streamed from SPIFFS, like uploaded GIFs
+#define FILE_READ_AHEAD_BYTES 512
+#endif
+
 #ifndef ENABLE_REMOTE
 #define ENABLE_REMOTE 0
 #endif
@@ -0,0 +1,347 @@
+//+--------------------------------------------------------------------------
+//
+// File:        lazyeffect.h
+//
+// NightDriverStrip - (c) 2018 Plummer's Software LLC.  All Rights Reserved.
+//
+// This file is part of the NightDriver software project.
+//
+//    NightDriver is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    NightDriver is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with Nightdriver.  It is normally found in copying.txt
+//    If not, see <https://www.gnu.org/licenses/>.
+//
+//
+// Description:
+//
+//    Stand-in for an effect in the effect list that only constructs the
+//    actual effect when it's needed, so effects that aren't showing don't
+//    take up memory.
+//
+//
+// History:     Oct-19-2026                     Created for NightDriverStrip
+//
+//---------------------------------------------------------------------------
+
+#pragma once
+
+#include "ledstripeffect.h"
+#include "effectfactories.h"
+
+// Effects that do work in the background, like fetching data from the network, need to stay loaded
+
+inline bool CanLoadEffectOnDemand(int effectNumber)
+{
+    return effectNumber != EFFECT_MATRIX_SUBSCRIBERS && effectNumber != EFFECT_MATRIX_WEATHER;
+}
+
+// LazyEffect
+//
+// Holds an effect's JSON factory and its serialized settings in place of the effect itself. The effect is
+// constructed and initialized when it's prepared or started, or when its settings are accessed, and its
+// instance can be released again when it's no longer used. The EffectManager takes care of the latter,
+// keeping a number of recently used effects loaded.
+//
+// The effect instance and the serialized settings are swapped using atomic shared_ptr operations, as they're
+// used from the drawing, effect preparation, JSON writer and web server tasks. Anyone using the instance holds
+// a reference to it while doing so, which means a release never pulls it out from under them. Changing a
+// setting and releasing are also serialized with each other, so a release can't save the settings from just
+// before a change and then drop the instance that has it.
+
+class LazyEffect : public LEDStripEffect
+{
+    using SerializedSettings = std::basic_string<char, std::char_traits<char>, psram_allocator<char>>;
+
+    JSONEffectFactory _factory;
+    std::shared_ptr<const SerializedSettings> _ptrSettings;
+    std::shared_ptr<LEDStripEffect> _ptrEffect;
+    std::atomic_ulong _lastUsedTime = 0;
+    std::mutex _settingsMutex;                          // Held while settings are changed and while releasing
+    bool _settingSpecsCopied = false;                   // Whether _settingSpecs holds the effect's specs
+
+    void StoreSettings(const JsonObjectConst& jsonObject)
+    {
+        size_t length = measureJson(jsonObject);
+        auto settings = std::make_shared<SerializedSettings>(length, '\0');
+        serializeJson(jsonObject, settings->data(), length + 1);
+
+        std::atomic_store(&_ptrSettings, std::shared_ptr<const SerializedSettings>(settings));
+    }
+
+    // CreateEffect
+    //
+    // Constructs and initializes the effect from its serialized settings. Our own enabled and core effect
+    // state is leading, as it may have been changed while the effect was not loaded.
+
+    std::shared_ptr<LEDStripEffect> CreateEffect()
+    {
+        auto settings = std::atomic_load(&_ptrSettings);
+
+        AllocatedJsonDocument jsonDoc(settings->size() * 2 + JSON_BUFFER_BASE_SIZE);
+        if (deserializeJson(jsonDoc, settings->data(), settings->size()) != DeserializationError::Ok)
+        {
+            debugE("Could not deserialize settings for effect %s", _friendlyName.c_str());
+            return nullptr;
+        }
+
+        auto effect = _factory(jsonDoc.as<JsonObjectConst>());
+        if (!effect || !effect->Init(_GFX))
+        {
+            debugE("Could not create effect %s", _friendlyName.c_str());
+            return nullptr;
+        }
+
+        effect->SetEnabled(_enabled);
+        if (IsCoreEffect())
+            effect->MarkAsCoreEffect();
+
+        debugV("Loaded effect %s, free heap %u, free PSRAM %u", _friendlyName.c_str(), ESP.getFreeHeap(), ESP.getFreePsram());
+
+        return effect;
+    }
+
+  public:
+
+    LazyEffect(const JsonObjectConst& jsonObject, JSONEffectFactory factory)
+        : LEDStripEffect(jsonObject),
+          _factory(factory)
+    {
+        StoreSettings(jsonObject);
+    }
+
+    bool IsLoadedOnDemand() const override
+    {
+        return true;
+    }
+
+    bool IsLoaded() const
+    {
+        return std::atomic_load(&_ptrEffect) != nullptr;
+    }
+
+    unsigned long LastUsedTime() const
+    {
+        return _lastUsedTime;
+    }
+
+    // Acquire
+    //
+    // Returns the effect instance, loading it first if it isn't loaded yet. If two tasks load the effect at
+    // the same time, the instance of whichever gets there first is used by both.
+
+    std::shared_ptr<LEDStripEffect> Acquire()
+    {
+        _lastUsedTime = millis();
+
+        auto effect = std::atomic_load(&_ptrEffect);
+        if (effect)
+            return effect;
+
+        // Whoever loads us, what the effect allocates is ours
+        {
+            MemoryAccountScope memoryScope(GetMemoryAccount());
+            effect = CreateEffect();
+        }
+
+        if (!effect)
+            return nullptr;
+
+        effect->SetQualityLevel(QualityLevel());
+
+        std::shared_ptr<LEDStripEffect> loadedEffect;
+        if (!std::atomic_compare_exchange_strong(&_ptrEffect, &loadedEffect, effect))
+            return loadedEffect;
+
+        return effect;
+    }
+
+    // Release
+    //
+    // Lets go of the effect instance, after saving its settings so changes made while it was loaded are kept
+
+    void Release()
+    {
+        std::lock_guard<std::mutex> guard(_settingsMutex);
+
+        auto effect = std::atomic_exchange(&_ptrEffect, std::shared_ptr<LEDStripEffect>());
+        if (!effect)
+            return;
+
+        static size_t jsonBufferSize = JSON_BUFFER_BASE_SIZE;
+        std::unique_ptr<AllocatedJsonDocument> ptrJsonDoc;
+
+        if (SerializeWithBufferSize(ptrJsonDoc, jsonBufferSize, [&effect](JsonObject& jsonObject) { return effect->SerializeToJSON(jsonObject); }))
+            StoreSettings(ptrJsonDoc->as<JsonObjectConst>());
+        else
+            debugE("Could not save settings for effect %s, changes made while it was loaded are lost", _friendlyName.c_str());
+    }
+
+    void Prepare() override
+    {
+        auto effect = Acquire();
+        if (effect)
+            effect->Prepare();
+    }
+
+    void Start() override
+    {
+        auto effect = Acquire();
+        if (effect)
+            effect->Start();
+    }
+
+    void Draw() override
+    {
+        auto effect = Acquire();
+        if (effect)
+            effect->Draw();
+    }
+
+    void Stop() override
+    {
+        auto effect = std::atomic_load(&_ptrEffect);
+        if (effect)
+            effect->Stop();
+    }
+
+    // These are only really asked of the current effect, which is loaded. We answer for ourselves if we're not.
+
+    size_t DesiredFramesPerSecond() const override
+    {
+        auto effect = std::atomic_load(&_ptrEffect);
+        return effect ? effect->DesiredFramesPerSecond() : LEDStripEffect::DesiredFramesPerSecond();
+    }
+
+    std::optional<bool> RequiresDoubleBuffering() const override
+    {
+        auto effect = std::atomic_load(&_ptrEffect);
+        return effect ? effect->RequiresDoubleBuffering() : LEDStripEffect::RequiresDoubleBuffering();
+    }
+
+    bool TracksDirtyRegion() const override
+    {
+        auto effect = std::atomic_load(&_ptrEffect);
+        return effect ? effect->TracksDirtyRegion() : LEDStripEffect::TracksDirtyRegion();
+    }
+
+    bool ShouldShowTitle() const override
+    {
+        auto effect = std::atomic_load(&_ptrEffect);
+        return effect ? effect->ShouldShowTitle() : LEDStripEffect::ShouldShowTitle();
+    }
+
+    bool CanDisplayVUMeter() const override
+    {
+        auto effect = std::atomic_load(&_ptrEffect);
+        return effect ? effect->CanDisplayVUMeter() : LEDStripEffect::CanDisplayVUMeter();
+    }
+
+    size_t MaximumEffectTime() const override
+    {
+        auto effect = std::atomic_load(&_ptrEffect);
+        return effect ? effect->MaximumEffectTime() : LEDStripEffect::MaximumEffectTime();
+    }
+
+    bool SupportsQualityScaling() const override
+    {
+        auto effect = std::atomic_load(&_ptrEffect);
+        return effect ? effect->SupportsQualityScaling() : LEDStripEffect::SupportsQualityScaling();
+    }
+
+    void SetQualityLevel(uint8_t level) override
+    {
+        LEDStripEffect::SetQualityLevel(level);
+
+        auto effect = std::atomic_load(&_ptrEffect);
+        if (effect)
+            effect->SetQualityLevel(level);
+    }
+
+    void SetEnabled(bool enabled) override
+    {
+        LEDStripEffect::SetEnabled(enabled);
+
+        auto effect = std::atomic_load(&_ptrEffect);
+        if (effect)
+            effect->SetEnabled(enabled);
+    }
+
+    // Settings are read and written on the effect itself, so we load it to deal with them. The specs themselves
+    // are static members of the effect's classes, so we keep our own list of them, which outlives the instance.
+
+    const std::vector<std::reference_wrapper<SettingSpec>>& GetSettingSpecs() override
+    {
+        std::lock_guard<std::mutex> guard(_settingsMutex);
+
+        if (!_settingSpecsCopied)
+        {
+            auto effect = Acquire();
+            if (!effect)
+                return LEDStripEffect::GetSettingSpecs();
+
+            _settingSpecs = effect->GetSettingSpecs();
+            _settingSpecsCopied = true;
+        }
+
+        return _settingSpecs;
+    }
+
+    bool SerializeSettingsToJSON(JsonObject& jsonObject) override
+    {
+        auto effect = Acquire();
+        return effect ? effect->SerializeSettingsToJSON(jsonObject) : LEDStripEffect::SerializeSettingsToJSON(jsonObject);
+    }
+
+    bool SetSetting(const String& name, const String& value) override
+    {
+        std::lock_guard<std::mutex> guard(_settingsMutex);
+
+        auto effect = Acquire();
+        if (!effect)
+            return false;
+
+        bool settingSet = effect->SetSetting(name, value);
+
+        // Keep the properties we answer for ourselves in sync
+        _friendlyName = effect->FriendlyName();
+        _maximumEffectTime = effect->MaximumEffectTime();
+
+        return settingSet;
+    }
+
+    // SerializeToJSON
+    //
+    // If the effect is loaded, it serializes itself. Otherwise we write out its stored settings, with our
+    // enabled state, which may have changed in the meantime.
+
+    bool SerializeToJSON(JsonObject& jsonObject) override
+    {
+        auto effect = std::atomic_load(&_ptrEffect);
+        if (effect)
+            return effect->SerializeToJSON(jsonObject);
+
+        auto settings = std::atomic_load(&_ptrSettings);
+
+        AllocatedJsonDocument jsonDoc(settings->size() * 2 + JSON_BUFFER_BASE_SIZE);
+        if (deserializeJson(jsonDoc, settings->data(), settings->size()) != DeserializationError::Ok)
+        {
+            debugE("Could not deserialize settings for effect %s, saving base properties only", _friendlyName.c_str());
+            return LEDStripEffect::SerializeToJSON(jsonObject);
+        }
+
+        jsonDoc["es"] = _enabled ? 1 : 0;
+        if (IsCoreEffect())
+            jsonDoc[PTY_COREEFFECT] = 1;
+
+        return jsonObject.set(jsonDoc.as<JsonObjectConst>());
+    }
+};
@@ -46,7 +46,7 @@ class LEDBuffer
 
   private:
 
-    std::unique_ptr<CRGB []> _leds;
+    psram_unique_ptr<CRGB []> _leds;
     uint32_t                 _pixelCount;
     uint64_t                 _timeStampMicroseconds;
     uint64_t                 _timeStampSeconds;
@@ -59,7 +59,7 @@ class LEDBuffer
                  _timeStampMicroseconds(0),
                  _timeStampSeconds(0)
     {
-        _leds.reset(psram_allocator<CRGB>().allocate(NUM_LEDS));
+        _leds = make_unique_psram_array<CRGB>(NUM_LEDS);
     }
 
     ~LEDBuffer()
@@ -35,6 +35,7 @@
 #if USE_HUB75
 
 #include <SmartMatrix.h>
+#include "powermodel.h"
 
 //
 // Matrix Panel
@@ -51,6 +52,8 @@ protected:
     const float captionFadeInTime = 500;
     const float captionFadeOutTime = 1000;
 
+    std::array<ChannelSums, MATRIX_HEIGHT> _rowSums;                    // Per-row color sums for EstimatePowerDraw
+
 public:
     typedef RGB_TYPE(COLOR_DEPTH) SM_RGB;
     static const uint8_t kMatrixWidth = MATRIX_WIDTH;                                   // known working: 32, 64, 96, 128
@@ -103,25 +106,39 @@ public:
 
     // EstimatePowerDraw
     //
-    // Estimate the total power load for the board and matrix by walking the pixels and adding our previously measured
-    // power draw per pixel based on what color and brightness each pixel is
+    // Estimate the power load for the board and matrix at full brightness. The pixels are only summed per channel
+    // here; our previously measured per-pixel draw for each color is applied to those sums once. Sums are kept
+    // per row, and only the rows in the frame's dirty span are summed again.
 
-    int EstimatePowerDraw()
+    PowerEstimate EstimatePowerDraw()
     {
-        constexpr auto kBaseLoad       = 1500;          // Experimentally derived values
-        constexpr auto mwPerPixelRed   = 4.10f;
-        constexpr auto mwPerPixelGreen = 0.82f;
-        constexpr auto mwPerPixelBlue  = 1.75f;
-
-        float totalPower = kBaseLoad;
-        for (int i = 0; i < NUM_LEDS; i++)
+        if (IsFrameDirty())
         {
-            const auto pixel = leds[i];
-            totalPower += pixel.r * mwPerPixelRed   / 255.0f;
-            totalPower += pixel.g * mwPerPixelGreen / 255.0f;
-            totalPower += pixel.b * mwPerPixelBlue  / 255.0f;
+            const size_t lastRow = (DirtyEnd() - 1) / MATRIX_WIDTH;
+            for (size_t row = DirtyBegin() / MATRIX_WIDTH; row <= lastRow; row++)
+                _rowSums[row] = SumChannels(&leds[row * MATRIX_WIDTH], MATRIX_WIDTH);
         }
-        return (int) totalPower;
+
+        ChannelSums sums;
+        for (const auto& rowSums : _rowSums)
+            sums += rowSums;
+
+        return kMatrixPowerModel.Estimate(sums, NUM_LEDS);
+    }
+
+    static constexpr uint16_t PixelIndex(uint16_t x, uint16_t y)
+    {
+        return y * MATRIX_WIDTH + x;
+    }
+
+    static constexpr size_t FrameWidth()
+    {
+        return MATRIX_WIDTH;
+    }
+
+    static constexpr size_t FrameHeight()
+    {
+        return MATRIX_HEIGHT;
     }
 
     uint16_t xy(uint16_t x, uint16_t y) const override
@@ -148,6 +165,7 @@ public:
         // A mesmerizer panel has the same layout as in memory, so we can memcpy.
 
         memcpy(leds, pLEDs.get(), sizeof(CRGB) * GetLEDCount());
+        MarkAllDirty();
     }
 
     void Clear(CRGB color = CRGB::Black) override
@@ -155,20 +173,26 @@ public:
         // NB: We directly clear the backbuffer because otherwise effects would start with a snapshot of the effect
         //     before them on the next buffer swap.  So we clear the backbuffer and then the leds, which point to
         //     the current front buffer.  TLDR:  We clear both the front and back buffers to avoid flicker between effects.
+        //     When an effect layer is drawing, leds points to the layer's own buffer and the matrix buffers are left alone.
+
+        const bool drawingToMatrix = (leds == GetMatrixBackBuffer());
 
         if (color == CRGB::Black)
         {
-            memset((void *) backgroundLayer.backBuffer(), 0, sizeof(LEDMatrixGFX::SM_RGB) * _width * _height);
+            if (drawingToMatrix)
+                memset((void *) backgroundLayer.backBuffer(), 0, sizeof(LEDMatrixGFX::SM_RGB) * _width * _height);
             memset((void *) leds, 0, sizeof(CRGB) * _width * _height);
         }
         else
         {
             for (int i = 0; i < NUM_LEDS; i++)
             {
-                backgroundLayer.backBuffer()[i] = rgb24(color.r, color.g, color.b);
+                if (drawingToMatrix)
+                    backgroundLayer.backBuffer()[i] = rgb24(color.r, color.g, color.b);
                 leds[i] = color;
             }
         }
+        MarkAllDirty();
     }
 
     const String & GetCaption()
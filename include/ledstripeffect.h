@@ -35,8 +35,10 @@
 #include "types.h"
 #include "gfxbase.h"
 #include "ledmatrixgfx.h"
+#include "frameview.h"
 #include <memory>
 #include <list>
+#include <atomic>
 #include <stdlib.h>
 
 // This macro returns from the invoking function (which would usually be SetSetting())
@@ -65,6 +67,34 @@ class LEDStripEffect : public IJSONSerializable
     bool   _coreEffect = false;
     static std::vector<SettingSpec, psram_allocator<SettingSpec>> _baseSettingSpecs;
 
+    // Tracks whether Prepare() has run since the effect was last active; see EnsurePrepared()
+    enum class PrepareState : uint8_t
+    {
+        Unprepared,
+        Preparing,
+        Prepared
+    };
+
+    std::atomic<PrepareState> _prepareState = PrepareState::Unprepared;
+
+    // Memory allocated while this effect is initialized, prepared, started or drawn is booked here
+    MemoryAccount _memoryAccount;
+
+    // Detail hint set by the draw loop when frames run over budget; see SetQualityLevel()
+    uint8_t _qualityLevel = kMaxQualityLevel;
+
+    // Outcome of measuring whether we overwrite every pixel; see GetDoubleBufferPolicy()
+    enum class MeasuredCoverage : uint8_t
+    {
+        Unmeasured,
+        Partial,
+        Full
+    };
+
+    MeasuredCoverage _measuredCoverage = MeasuredCoverage::Unmeasured;
+    uint8_t _fullCoverageSamples = 0;
+    uint8_t _framesUntilCoverageSample = 0;
+
   protected:
 
     size_t _cLEDs = 0;
@@ -241,9 +271,55 @@ class LEDStripEffect : public IJSONSerializable
         return true;
     }
 
+    virtual void Prepare() {}                                       // Optional heavy setup that doesn't draw; may run on another task ahead of Start()
     virtual void Start() {}                                         // Optional method called when time to clean/init the effect
+    virtual void Stop() {}                                          // Optional; lets go of what Prepare() and Start() set up once we're done showing
     virtual void Draw() = 0;                                        // Your effect must implement these
 
+    // EnsurePrepared
+    //
+    // Runs Prepare() unless that already happened since the effect was last active. If the effect is being prepared
+    // on the effect preparation task right now, we wait for that to finish instead.
+
+    void EnsurePrepared()
+    {
+        auto expected = PrepareState::Unprepared;
+        if (_prepareState.compare_exchange_strong(expected, PrepareState::Preparing))
+        {
+            Prepare();
+            _prepareState.store(PrepareState::Prepared);
+            return;
+        }
+
+        while (_prepareState.load() == PrepareState::Preparing)
+            delay(1);
+    }
+
+    bool NeedsPreparation() const
+    {
+        return _prepareState.load() == PrepareState::Unprepared;
+    }
+
+    // Called when the effect stops being the active one, so it's prepared afresh before it next starts
+    void ResetPreparation()
+    {
+        _prepareState.store(PrepareState::Unprepared);
+    }
+
+    // AbandonPreparation
+    //
+    // For an effect that was prepared ahead of its start, but isn't going to be started after all. If it's still
+    // being prepared we wait for that to finish, and then undo it.
+
+    void AbandonPreparation()
+    {
+        while (_prepareState.load() == PrepareState::Preparing)
+            delay(1);
+
+        if (_prepareState.exchange(PrepareState::Unprepared) == PrepareState::Prepared)
+            Stop();
+    }
+
     std::shared_ptr<GFXBase> g(size_t channel = 0) const
     {
         return _GFX[channel];
@@ -265,6 +341,21 @@ class LEDStripEffect : public IJSONSerializable
       }
     #endif
 
+    // frameView returns a FrameView on the pixels of the given channel for this frame, typed for the device
+    // this project uses so its accesses aren't virtual
+
+    #if USE_HUB75
+      FrameView<LEDMatrixGFX> frameView(size_t channel = 0)
+      {
+        return FrameView<LEDMatrixGFX>(*mg(channel));
+      }
+    #else
+      FrameView<GFXBase> frameView(size_t channel = 0)
+      {
+        return FrameView<GFXBase>(*g(channel));
+      }
+    #endif
+
     virtual bool CanDisplayVUMeter() const
     {
         return true;
@@ -304,13 +395,124 @@ class LEDStripEffect : public IJSONSerializable
     //
     // If a matrix effect requires the state of the last buffer be preserved, then it requires double buffering.
     // If, on the other hand, it renders from scratch every time, starting witha black fill, etc, then it does not,
-    // and it can override this method and return false;
+    // and it can override this method and return false. Effects that don't say either way are measured; see below.
+
+    virtual std::optional<bool> RequiresDoubleBuffering() const
+    {
+        return std::nullopt;
+    }
+
+    // Double buffer policy
+    //
+    // Effects that leave RequiresDoubleBuffering() undeclared are measured. Now and then the effect manager draws
+    // a frame twice, over two different starting buffers, and a pixel only counts as written if both draws came
+    // out the same (see EffectManager::DrawEffect). If every sampled frame passes for every pixel, the previous
+    // frame isn't copied back on swap, and the answer is kept for as long as the effect object lives. Effects
+    // that animate from one draw to the next fail the check even if they do paint every pixel, which costs them
+    // only the copy they'd have had anyway; those can declare false to skip both.
+
+    enum class DoubleBufferPolicy : uint8_t
+    {
+        DeclaredNotRequired,                // RequiresDoubleBuffering() returns false
+        DeclaredRequired,                   // RequiresDoubleBuffering() returns true
+        Measuring,                          // Not enough samples yet, so we keep copying to be safe
+        MeasuredRequired,                   // A sampled frame left pixels alone
+        MeasuredNotRequired                 // Every sampled frame wrote every pixel
+    };
+
+    static constexpr uint8_t kCoverageSampleInterval = 4;          // Sample one frame out of this many
+    static constexpr uint8_t kCoverageSamplesNeeded  = 16;         // Full coverage this many times in a row settles it
+
+    DoubleBufferPolicy GetDoubleBufferPolicy() const
+    {
+        const auto declared = RequiresDoubleBuffering();
+        if (declared.has_value())
+            return *declared ? DoubleBufferPolicy::DeclaredRequired : DoubleBufferPolicy::DeclaredNotRequired;
+
+        switch (_measuredCoverage)
+        {
+            case MeasuredCoverage::Partial:
+                return DoubleBufferPolicy::MeasuredRequired;
+            case MeasuredCoverage::Full:
+                return DoubleBufferPolicy::MeasuredNotRequired;
+            default:
+                return DoubleBufferPolicy::Measuring;
+        }
+    }
+
+    bool NeedsBackBufferCopy() const
+    {
+        const auto policy = GetDoubleBufferPolicy();
+        return policy != DoubleBufferPolicy::DeclaredNotRequired && policy != DoubleBufferPolicy::MeasuredNotRequired;
+    }
 
-    virtual bool RequiresDoubleBuffering() const
+    // True once every kCoverageSampleInterval frames while we're still measuring
+    bool IsCoverageSampleDue()
     {
+        if (GetDoubleBufferPolicy() != DoubleBufferPolicy::Measuring)
+            return false;
+
+        if (_framesUntilCoverageSample > 0)
+        {
+            _framesUntilCoverageSample--;
+            return false;
+        }
+
+        _framesUntilCoverageSample = kCoverageSampleInterval - 1;
         return true;
     }
 
+    void RecordCoverageSample(bool coveredEveryPixel)
+    {
+        if (!coveredEveryPixel)
+            _measuredCoverage = MeasuredCoverage::Partial;
+        else if (++_fullCoverageSamples >= kCoverageSamplesNeeded)
+            _measuredCoverage = MeasuredCoverage::Full;
+    }
+
+    // TracksDirtyRegion
+    //
+    // An effect that returns true promises that everything it draws goes through the GFXBase primitives, or that
+    // it calls MarkDirty for whatever doesn't. The frame's consumers then only need to look at what changed, and
+    // an effect that draws nothing new in a frame costs next to nothing to output. All other effects have their
+    // whole frame marked dirty after each draw.
+
+    virtual bool TracksDirtyRegion() const
+    {
+        return false;
+    }
+
+    // Quality scaling
+    //
+    // Effects that can trade detail for speed (fewer particles, coarser noise, fewer blur passes and so on) return
+    // true from SupportsQualityScaling() and consult QualityLevel() while drawing. The draw loop lowers the level
+    // when frames keep overrunning the effect's frame budget and raises it again once there's headroom. Every effect
+    // starts out at kMaxQualityLevel, which is full quality.
+
+    static constexpr uint8_t kMaxQualityLevel = 4;
+
+    virtual bool SupportsQualityScaling() const
+    {
+        return false;
+    }
+
+    uint8_t QualityLevel() const
+    {
+        return _qualityLevel;
+    }
+
+    virtual void SetQualityLevel(uint8_t level)
+    {
+        _qualityLevel = std::min(level, kMaxQualityLevel);
+    }
+
+    // Scales a count (of particles, for instance) to the current quality level, but never below minimum
+
+    size_t QualityScaled(size_t count, size_t minimum = 1) const
+    {
+        return std::max(minimum, count * (_qualityLevel + 1) / (kMaxQualityLevel + 1));
+    }
+
     // RandomRainbowColor
     //
     // Returns a random color of the rainbow
@@ -538,6 +740,17 @@ class LEDStripEffect : public IJSONSerializable
         return _coreEffect;
     }
 
+    MemoryAccount & GetMemoryAccount()
+    {
+        return _memoryAccount;
+    }
+
+    // True for stand-ins that construct the actual effect only when it's needed; see LazyEffect
+    virtual bool IsLoadedOnDemand() const
+    {
+        return false;
+    }
+
     // Lazily loads the SettingsSpecs for this effect if they haven't been loaded yet, and
     // returns a vector with reference_wrappers to them.
     virtual const std::vector<std::reference_wrapper<SettingSpec>>& GetSettingSpecs()
@@ -32,6 +32,7 @@
 
 #pragma once
 #include "gfxbase.h"
+#include "powermodel.h"
 
 // LEDStripGFX
 //
@@ -86,11 +87,18 @@ protected:
             ADD_CHANNEL(7);
         #endif
 
-        #ifdef POWER_LIMIT_MW
-            set_max_power_in_milliwatts(POWER_LIMIT_MW);                // Set brightness limit
-        #endif
+        // We don't set a power limit on FastLED, as the output stage in PostProcessFrame already takes care of that
     }
 
+    // What we hand FastLED to show: the frame in leds after the output stage has applied gamma, brightness, the
+    // fader and the power limit. Keeping it separate leaves the effect's own frame as it was drawn.
+    std::unique_ptr<CRGB[]> _outputLeds;
+    ChannelSums _outputSums;                        // Per-color sums of _outputLeds, for the power estimate
+    bool _outputPowerLimited = false;               // _outputLeds was scaled down past the output table to fit CHANNEL_POWER_LIMIT_MW
+
+    void MapToOutput(size_t begin, size_t end, bool wholeFrame);
+    void LimitChannelPower(size_t count);
+
 public:
 
     LEDStripGFX(size_t w, size_t h) : GFXBase(w, h)
@@ -99,6 +107,8 @@ public:
         leds = static_cast<CRGB *>(calloc(w * h, sizeof(CRGB)));
         if(!leds)
             throw std::runtime_error("Unable to allocate LEDs in LEDStripGFX");
+
+        _outputLeds = std::make_unique<CRGB[]>(w * h);
     }
 
     ~LEDStripGFX() override
@@ -118,6 +128,7 @@ public:
         {
             debugW("Allocating LEDStripGFX for channel %d", i);
             devices.push_back(make_shared_psram<LEDStripGFX>(MATRIX_WIDTH, MATRIX_HEIGHT));
+            devices.back()->BuildXYTable();
         }
 
         AddLEDsToFastLED(devices);
@@ -157,6 +168,7 @@ class HexagonGFX : public LEDStripGFX
         {
             debugW("Allocating HexagonGFX for channel %d", i);
             devices.push_back(make_shared_psram<HexagonGFX>(NUM_LEDS));
+            devices.back()->BuildXYTable();
         }
 
         AddLEDsToFastLED(devices);
@@ -0,0 +1,155 @@
+//+--------------------------------------------------------------------------
+//
+// File:        memoryaccounting.h
+//
+// NightDriverStrip - (c) 2018 Plummer's Software LLC.  All Rights Reserved.
+//
+// This file is part of the NightDriver software project.
+//
+//    NightDriver is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    NightDriver is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with Nightdriver.  It is normally found in copying.txt
+//    If not, see <https://www.gnu.org/licenses/>.
+//
+//
+// Description:
+//
+//    Attributes memory allocated through PreferPSRAMAlloc (and thereby
+//    psram_allocator and the make_*_psram helpers) to whoever is active
+//    on the allocating task, which in practice is an effect, and takes
+//    it off again when the memory is freed.
+//
+//
+// History:     Oct-19-2026                     Created for NightDriverStrip
+//
+//---------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// MemoryAccount
+//
+// Keeps track of how many bytes its owner currently holds, and the most it has held at any one time. Every block
+// handed out by PreferPSRAMAlloc starts with a small header that says how big it is and which account it was booked
+// to, so the free can be booked back to the same account no matter which task does it. An account is a slot in a
+// fixed table, so booking is a thread local read and a couple of atomic operations.
+
+#define MAX_MEMORY_ACCOUNTS     512         // Slot 0 is "no account", for when the table is full
+
+class MemoryAccount
+{
+    uint16_t _id = 0;
+
+  public:
+
+    MemoryAccount(const MemoryAccount&) = delete;
+    MemoryAccount& operator=(const MemoryAccount&) = delete;
+
+    #if ENABLE_MEMORY_ACCOUNTING
+
+        // Implementation is in memoryaccounting.cpp
+        MemoryAccount();
+        ~MemoryAccount();
+
+        size_t CurrentBytes() const;
+        size_t PeakBytes() const;
+
+    #else
+
+        MemoryAccount() = default;
+
+        size_t CurrentBytes() const
+        {
+            return 0;
+        }
+
+        size_t PeakBytes() const
+        {
+            return 0;
+        }
+
+    #endif
+
+    uint16_t Id() const
+    {
+        return _id;
+    }
+};
+
+#if ENABLE_MEMORY_ACCOUNTING
+
+    // MemoryBlockHeader
+    //
+    // Sits in front of every block from PreferPSRAMAlloc. The generation tells a block booked to an account that has
+    // since gone away apart from one booked to whoever got its slot next.
+
+    struct alignas(std::max_align_t) MemoryBlockHeader
+    {
+        size_t   bytes;
+        uint16_t accountId;
+        uint16_t generation;
+    };
+
+    constexpr size_t kMemoryBlockHeaderSize = sizeof(MemoryBlockHeader);
+
+    // Implementation is in memoryaccounting.cpp
+    uint16_t SetActiveMemoryAccount(uint16_t accountId);
+
+    // Fills in the header at the start of block, books the allocation and returns the memory that follows the header
+    void * TrackAllocation(void * block, size_t bytes);
+
+    // Books the free of memory returned by TrackAllocation and returns the block it's part of
+    void * TrackFree(void * memory);
+
+    // MemoryAccountScope
+    //
+    // Books allocations made on the current task to the given account for as long as the scope lives
+
+    class MemoryAccountScope
+    {
+        uint16_t _previousAccountId;
+
+      public:
+
+        explicit MemoryAccountScope(MemoryAccount & account)
+          : _previousAccountId(SetActiveMemoryAccount(account.Id()))
+        {}
+
+        ~MemoryAccountScope()
+        {
+            SetActiveMemoryAccount(_previousAccountId);
+        }
+    };
+
+#else
+
+    constexpr size_t kMemoryBlockHeaderSize = 0;
+
+    inline void * TrackAllocation(void * block, size_t bytes)
+    {
+        return block;
+    }
+
+    inline void * TrackFree(void * memory)
+    {
+        return memory;
+    }
+
+    class MemoryAccountScope
+    {
+      public:
+        explicit MemoryAccountScope(MemoryAccount & account) {}
+    };
+
+#endif
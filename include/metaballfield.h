@@ -0,0 +1,170 @@
+//+--------------------------------------------------------------------------
+//
+// File:        metaballfield.h
+//
+// NightDriverStrip - (c) 2018 Plummer's Software LLC.  All Rights Reserved.
+//
+// This file is part of the NightDriver software project.
+//
+//    NightDriver is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    NightDriver is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with Nightdriver.  It is normally found in copying.txt
+//    If not, see <https://www.gnu.org/licenses/>.
+//
+//
+// Description:
+//
+//    The field of a set of metaballs, where each ball adds a glow of
+//    strength / sqrt(distance squared + 1) to every pixel. The squared
+//    distances are split into a column part and a row part once per
+//    frame, and the falloff comes from a table, so a pixel costs a few
+//    adds and lookups per ball.
+//
+//
+// History:     Oct-19-2026                     Created for NightDriverStrip
+//
+//---------------------------------------------------------------------------
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+#include "globals.h"
+#include "framekernels.h"
+#include "types.h"
+
+// ReciprocalSqrtLUT
+//
+// Gives strength / sqrt16(d + 1) for a squared distance d. Small distances, where the value changes quickly,
+// have an entry each and match the division exactly. Past that the value is small and changes slowly, so one
+// entry covers a run of distances and may be one off the division at the end of a run.
+
+class ReciprocalSqrtLUT
+{
+    static constexpr uint32_t kExactEntries = 4096;
+    static constexpr uint32_t kCoarseShift  = 4;
+
+    std::vector<uint8_t, psram_allocator<uint8_t>> _exact;
+    std::vector<uint8_t, psram_allocator<uint8_t>> _coarse;
+
+    static uint8_t Falloff(uint8_t strength, uint32_t squaredDistance)
+    {
+        return strength / sqrt16(std::min<uint32_t>(squaredDistance + 1, UINT16_MAX));
+    }
+
+  public:
+
+    ReciprocalSqrtLUT(uint8_t strength, uint32_t maxSquaredDistance)
+        : _exact(std::min(maxSquaredDistance + 1, kExactEntries)),
+          _coarse(maxSquaredDistance >= kExactEntries ? (maxSquaredDistance >> kCoarseShift) + 1 : 0)
+    {
+        for (uint32_t d = 0; d < _exact.size(); d++)
+            _exact[d] = Falloff(strength, d);
+
+        for (uint32_t i = kExactEntries >> kCoarseShift; i < _coarse.size(); i++)
+            _coarse[i] = Falloff(strength, i << kCoarseShift);
+    }
+
+    // The squared distance must be no more than the one the table was built for
+    uint8_t operator[](uint32_t squaredDistance) const
+    {
+        return squaredDistance < kExactEntries ? _exact[squaredDistance] : _coarse[squaredDistance >> kCoarseShift];
+    }
+};
+
+// MetaballField
+//
+// Samples the field on a grid of columns x rows, with step pixels between samples. Call SetBalls() once per frame
+// and then FillRow() for each row. Sums saturate at 255, like adding the balls up with qadd8 would.
+
+class MetaballField
+{
+    size_t _width;
+    size_t _height;
+    size_t _ballCount     = 0;
+    size_t _sampleColumns = 0;                  // Rounded up to a multiple of four, see FillRow()
+    size_t _sampleRows    = 0;
+    ReciprocalSqrtLUT _falloff;
+
+    std::vector<uint16_t> _columnDistances;     // Squared x distance from each column to each ball, a ball at a time
+    std::vector<uint16_t> _rowDistances;        // Same for the rows
+
+  public:
+
+    MetaballField(size_t width, size_t height, uint8_t strength)
+        : _width(width),
+          _height(height),
+          _falloff(strength, (width - 1) * (width - 1) + (height - 1) * (height - 1))
+    {
+    }
+
+    // The ball positions are in pixels and must be on the matrix. Samples are taken every step pixels, starting
+    // at 0, so a row has width / step samples, rounded up.
+    void SetBalls(const uint8_t * ballX, const uint8_t * ballY, size_t ballCount, unsigned step = 1)
+    {
+        const size_t columns = (_width + step - 1) / step;
+
+        _ballCount     = ballCount;
+        _sampleColumns = (columns + 3) & ~size_t(3);
+        _sampleRows    = (_height + step - 1) / step;
+
+        // Padding columns are left at distance 0, which is a valid table entry; what ends up there is ignored
+        _columnDistances.assign(ballCount * _sampleColumns, 0);
+        _rowDistances.resize(ballCount * _sampleRows);
+
+        for (size_t ball = 0; ball < ballCount; ball++)
+        {
+            for (size_t i = 0; i < columns; i++)
+            {
+                int dx = int(i * step) - ballX[ball];
+                _columnDistances[ball * _sampleColumns + i] = dx * dx;
+            }
+            for (size_t i = 0; i < _sampleRows; i++)
+            {
+                int dy = int(i * step) - ballY[ball];
+                _rowDistances[ball * _sampleRows + i] = dy * dy;
+            }
+        }
+    }
+
+    // FillRow
+    //
+    // Writes one row of samples to out, which needs room for the row rounded up to a multiple of four. The bytes
+    // past the end of the row are scratch. Four samples are summed at a time as the bytes of one word.
+    void FillRow(uint8_t * out, size_t row) const
+    {
+        std::fill_n(out, _sampleColumns, 0);
+
+        for (size_t ball = 0; ball < _ballCount; ball++)
+        {
+            const uint16_t * columnDistance = &_columnDistances[ball * _sampleColumns];
+            const uint32_t rowDistance = _rowDistances[ball * _sampleRows + row];
+
+            for (size_t x = 0; x < _sampleColumns; x += 4)
+            {
+                const uint8_t falloff[4] =
+                {
+                    _falloff[columnDistance[x]     + rowDistance],
+                    _falloff[columnDistance[x + 1] + rowDistance],
+                    _falloff[columnDistance[x + 2] + rowDistance],
+                    _falloff[columnDistance[x + 3] + rowDistance]
+                };
+
+                uint32_t sum, add;
+                memcpy(&sum, out + x, 4);
+                memcpy(&add, falloff, 4);
+                sum = AddWordSaturated(sum, add);
+                memcpy(out + x, &sum, 4);
+            }
+        }
+    }
+};
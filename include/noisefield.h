@@ -0,0 +1,226 @@
+//+--------------------------------------------------------------------------
+//
+// File:        noisefield.h
+//
+// NightDriverStrip - (c) 2018 Plummer's Software LLC.  All Rights Reserved.
+//
+// This file is part of the NightDriver software project.
+//
+//    NightDriver is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    NightDriver is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with Nightdriver.  It is normally found in copying.txt
+//    If not, see <https://www.gnu.org/licenses/>.
+//
+//
+// Description:
+//
+//    Fills a grid with FastLED's 16-bit gradient noise a row at a time.
+//    Along a row only x changes, so everything that depends on y and z,
+//    and the lattice hashes for x until it crosses into the next cell,
+//    is worked out once instead of for every pixel.
+//
+//
+// History:     Oct-19-2026                     Created for NightDriverStrip
+//
+//---------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "FastLED.h"
+
+// NoiseField
+//
+// Results are the top byte of inoise16() for each point. The evaluation follows FastLED's inoise16() step for
+// step, including its choice of fade curve, so a field filled here looks the same as one filled by calling
+// inoise16() for every pixel.
+
+class NoiseField
+{
+    // Ken Perlin's permutation, the same one FastLED uses
+    static constexpr uint8_t kPermutation[256] =
+    {
+        151,160,137, 91, 90, 15,131, 13,201, 95, 96, 53,194,233,  7,225,
+        140, 36,103, 30, 69,142,  8, 99, 37,240, 21, 10, 23,190,  6,148,
+        247,120,234, 75,  0, 26,197, 62, 94,252,219,203,117, 35, 11, 32,
+         57,177, 33, 88,237,149, 56, 87,174, 20,125,136,171,168, 68,175,
+         74,165, 71,134,139, 48, 27,166, 77,146,158,231, 83,111,229,122,
+         60,211,133,230,220,105, 92, 41, 55, 46,245, 40,244,102,143, 54,
+         65, 25, 63,161,  1,216, 80, 73,209, 76,132,187,208, 89, 18,169,
+        200,196,135,130,116,188,159, 86,164,100,109,198,173,186,  3, 64,
+         52,217,226,250,124,123,  5,202, 38,147,118,126,255, 82, 85,212,
+        207,206, 59,227, 47, 16, 58, 17,182,189, 28, 42,223,183,170,213,
+        119,248,152,  2, 44,154,163, 70,221,153,101,155,167, 43,172,  9,
+        129, 22, 39,253, 19, 98,108,110, 79,113,224,232,178,185,112,104,
+        218,246, 97,228,251, 34,242,193,238,210,144, 12,191,179,162,241,
+         81, 51,145,235,249, 14,239,107, 49,192,214, 31,181,199,106,157,
+        184, 84,204,176,115,121, 50, 45,127,  4,150,254,138,236,205, 93,
+        222,114, 67, 29, 24, 72,243,141,128,195, 78, 66,215, 61,156,180
+    };
+
+    // These are only a row each, so they stay in internal RAM, which is quicker to get at than PSRAM
+
+    std::vector<uint8_t> _upper;                                // Half resolution samples for the row above
+    std::vector<uint8_t> _lower;                                // ...and the row below
+    std::vector<uint8_t> _row;                                  // The full resolution row handed to the caller
+
+    static uint8_t P(unsigned index)
+    {
+        return kPermutation[index & 0xFF];
+    }
+
+    static uint16_t Ease(uint16_t fraction)
+    {
+        #if FASTLED_NOISE_FIXED == 0
+            return scale16(fraction, fraction);
+        #else
+            return ease16InOutQuad(fraction);
+        #endif
+    }
+
+    static int16_t Gradient(uint8_t hash, int16_t x, int16_t y, int16_t z)
+    {
+        hash &= 15;
+        int16_t u = hash < 8 ? x : y;
+        int16_t v = hash < 4 ? y : hash == 12 || hash == 14 ? x : z;
+        if (hash & 1)
+            u = -u;
+        if (hash & 2)
+            v = -v;
+        return avg15(u, v);
+    }
+
+    // Widens count samples to width pixels, filling every other pixel with the average of its neighbors
+    static void Upsample(uint8_t * pixels, size_t width, const uint8_t * samples, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            pixels[2 * i] = samples[i];
+            if (2 * i + 1 < width)
+                pixels[2 * i + 1] = i + 1 < count ? (samples[i] + samples[i + 1] + 1) >> 1 : samples[i];
+        }
+    }
+
+  public:
+
+    explicit NoiseField(size_t width)
+        : _upper((width + 1) / 2),
+          _lower((width + 1) / 2),
+          _row(width)
+    {
+    }
+
+    // FillRow
+    //
+    // Sets out[i] to the top byte of inoise16(x + i * stepX, y, z) for each of the count points. Steps wrap
+    // around just like the unsigned sums the callers would otherwise pass to inoise16().
+
+    static void FillRow(uint8_t * out, size_t count, uint32_t x, uint32_t stepX, uint32_t y, uint32_t z)
+    {
+        constexpr int16_t N = 0x8000;
+
+        // Everything that only depends on y and z
+        const uint8_t Y = (y >> 16) & 0xFF;
+        const uint8_t Z = (z >> 16) & 0xFF;
+        const int16_t yy = ((y & 0xFFFF) >> 1) & 0x7FFF;
+        const int16_t zz = ((z & 0xFFFF) >> 1) & 0x7FFF;
+        const uint16_t v = Ease(y & 0xFFFF);
+        const uint16_t w = Ease(z & 0xFFFF);
+
+        // Hashes of the eight corners of the current lattice cell, in the order inoise16() blends them
+        int cellX = -1;
+        uint8_t hAA = 0, hBA = 0, hAB = 0, hBB = 0, hAA1 = 0, hBA1 = 0, hAB1 = 0, hBB1 = 0;
+
+        for (size_t i = 0; i < count; i++, x += stepX)
+        {
+            const uint8_t X = (x >> 16) & 0xFF;
+            if (X != cellX)
+            {
+                cellX = X;
+
+                const uint8_t A  = P(X) + Y;
+                const uint8_t AA = P(A) + Z;
+                const uint8_t AB = P(A + 1) + Z;
+                const uint8_t B  = P(X + 1) + Y;
+                const uint8_t BA = P(B) + Z;
+                const uint8_t BB = P(B + 1) + Z;
+
+                hAA = P(AA);      hBA = P(BA);      hAB = P(AB);      hBB = P(BB);
+                hAA1 = P(AA + 1); hBA1 = P(BA + 1); hAB1 = P(AB + 1); hBB1 = P(BB + 1);
+            }
+
+            const int16_t xx = ((x & 0xFFFF) >> 1) & 0x7FFF;
+            const uint16_t u = Ease(x & 0xFFFF);
+
+            const int16_t X1 = lerp15by16(Gradient(hAA, xx, yy, zz), Gradient(hBA, xx - N, yy, zz), u);
+            const int16_t X2 = lerp15by16(Gradient(hAB, xx, yy - N, zz), Gradient(hBB, xx - N, yy - N, zz), u);
+            const int16_t X3 = lerp15by16(Gradient(hAA1, xx, yy, zz - N), Gradient(hBA1, xx - N, yy, zz - N), u);
+            const int16_t X4 = lerp15by16(Gradient(hAB1, xx, yy - N, zz - N), Gradient(hBB1, xx - N, yy - N, zz - N), u);
+
+            const int16_t Y1 = lerp15by16(X1, X2, v);
+            const int16_t Y2 = lerp15by16(X3, X4, v);
+            const int32_t raw = lerp15by16(Y1, Y2, w);
+
+            // Same scaling into the unsigned range as inoise16(), keeping only its top byte
+            const uint32_t scaled = (uint32_t)(raw + 19052L) * 440L;
+            out[i] = scaled >> 16;
+        }
+    }
+
+    // Fill
+    //
+    // Fills a width by height grid starting at (x, y), a row at a time, calling visit(rowIndex, rowPixels) for
+    // each row from the top. With halfResolution set only every other row and column is evaluated and the
+    // pixels in between are interpolated, for about a quarter of the work.
+
+    template <typename RowVisitor>
+    void Fill(size_t height, uint32_t x, uint32_t stepX, uint32_t y, uint32_t stepY, uint32_t z, bool halfResolution, RowVisitor visit)
+    {
+        const size_t width = _row.size();
+
+        if (!halfResolution)
+        {
+            for (size_t row = 0; row < height; row++, y += stepY)
+            {
+                FillRow(_row.data(), width, x, stepX, y, z);
+                visit(row, _row.data());
+            }
+            return;
+        }
+
+        const size_t samples = _upper.size();
+        FillRow(_upper.data(), samples, x, 2 * stepX, y, z);
+
+        for (size_t row = 0; row < height; row += 2)
+        {
+            Upsample(_row.data(), width, _upper.data(), samples);
+            visit(row, _row.data());
+
+            if (row + 1 >= height)
+                break;
+
+            if (row + 2 < height)
+            {
+                FillRow(_lower.data(), samples, x, 2 * stepX, y + (row + 2) * stepY, z);
+                for (size_t i = 0; i < samples; i++)
+                    _upper[i] = (_upper[i] + _lower[i] + 1) >> 1;
+            }
+
+            Upsample(_row.data(), width, _upper.data(), samples);
+            visit(row + 1, _row.data());
+
+            std::swap(_upper, _lower);
+        }
+    }
+};
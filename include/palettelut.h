@@ -0,0 +1,94 @@
+//+--------------------------------------------------------------------------
+//
+// File:        palettelut.h
+//
+// NightDriverStrip - (c) 2018 Plummer's Software LLC.  All Rights Reserved.
+//
+// This file is part of the NightDriver software project.
+//
+//    NightDriver is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    NightDriver is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with Nightdriver.  It is normally found in copying.txt
+//    If not, see <https://www.gnu.org/licenses/>.
+//
+//
+// Description:
+//
+//    All 256 colors of a 16-entry palette, expanded once so that per
+//    pixel lookups don't have to interpolate between palette entries.
+//
+//
+// History:     Oct-19-2026                     Created for NightDriverStrip
+//
+//---------------------------------------------------------------------------
+
+#pragma once
+
+#include <array>
+#include <cstring>
+#include "FastLED.h"
+
+// PaletteLUT
+//
+// Call Update() with the palette and blend type you're drawing with (once per frame is plenty); it only does
+// the expansion when they differ from last time. Color() then gives the same result as ColorFromPalette() with
+// that palette and blend type, including its rounding when a brightness below 255 is asked for.
+
+class PaletteLUT
+{
+    std::array<CRGB, 256> _colors;
+    CRGBPalette16 _palette;
+    TBlendType _blendType = LINEARBLEND;
+    bool _built = false;
+
+  public:
+
+    // Returns true if the table had to be rebuilt
+    bool Update(const CRGBPalette16& palette, TBlendType blendType = LINEARBLEND)
+    {
+        if (_built && blendType == _blendType && !memcmp(palette.entries, _palette.entries, sizeof(_palette.entries)))
+            return false;
+
+        _palette = palette;
+        _blendType = blendType;
+        for (int i = 0; i < 256; i++)
+            _colors[i] = ColorFromPalette(_palette, i, 255, _blendType);
+        _built = true;
+
+        return true;
+    }
+
+    CRGB Color(uint8_t index, uint8_t brightness = 255) const
+    {
+        CRGB color = _colors[index];
+
+        if (brightness == 255)
+            return color;
+
+        if (brightness == 0)
+            return CRGB::Black;
+
+        // This is how ColorFromPalette applies brightness, rounding and all
+        const uint8_t scale = brightness + 1;
+        for (int channel = 0; channel < 3; channel++)
+        {
+            if (color.raw[channel])
+            {
+                color.raw[channel] = scale8(color.raw[channel], scale);
+                #if !(FASTLED_SCALE8_FIXED == 1)
+                    color.raw[channel]++;
+                #endif
+            }
+        }
+        return color;
+    }
+};
@@ -0,0 +1,142 @@
+//+--------------------------------------------------------------------------
+//
+// File:        polarmap.h
+//
+// NightDriverStrip - (c) 2018 Plummer's Software LLC.  All Rights Reserved.
+//
+// This file is part of the NightDriver software project.
+//
+//    NightDriver is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    NightDriver is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with Nightdriver.  It is normally found in copying.txt
+//    If not, see <https://www.gnu.org/licenses/>.
+//
+//
+// Description:
+//
+//    The angle and distance of every pixel on the matrix as seen from a
+//    center point, for the radial effects. Maps are shared: every effect
+//    that asks for the same center and radius scale gets the same copy,
+//    which is built on first use and freed when the last user lets go.
+//
+//
+// History:     Oct-19-2026                     Created for NightDriverStrip
+//
+//---------------------------------------------------------------------------
+
+#pragma once
+
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "globals.h"
+#include "types.h"
+
+// PolarCoord
+//
+// Both parts are 8-bit fixed point. The angle is in 1/256ths of a full turn, with 0 pointing along +x and 64
+// along +y. The radius is the distance from the center in pixels times the map's radius scale, truncated.
+
+struct PolarCoord
+{
+    uint8_t angle;
+    uint8_t radius;
+};
+
+// PolarMap
+//
+// Coordinates are stored a row at a time, so walking x in the inner loop reads the map (and, with the usual
+// XY() layout, writes the LEDs) in order. Use Get() rather than constructing one of these yourself.
+
+class PolarMap
+{
+    int _width;
+    int _height;
+    int _centerX;
+    int _centerY;
+    uint8_t _radiusScale;
+
+    std::vector<PolarCoord, psram_allocator<PolarCoord>> _coords;
+
+  public:
+
+    PolarMap(int width, int height, int centerX, int centerY, uint8_t radiusScale)
+        : _width(width),
+          _height(height),
+          _centerX(centerX),
+          _centerY(centerY),
+          _radiusScale(radiusScale),
+          _coords(width * height)
+    {
+        for (int y = 0; y < height; y++)
+        {
+            for (int x = 0; x < width; x++)
+            {
+                int dx = x - centerX;
+                int dy = y - centerY;
+
+                // Angles below the x axis come out negative and wrap around to the top half of the byte range
+                _coords[y * width + x].angle = (uint8_t)(int)(128 * (atan2(dy, dx) / PI));
+                _coords[y * width + x].radius = hypot(dx, dy) * radiusScale;
+            }
+        }
+    }
+
+    const PolarCoord & At(int x, int y) const
+    {
+        return _coords[y * _width + x];
+    }
+
+    const PolarCoord * Row(int y) const
+    {
+        return &_coords[y * _width];
+    }
+
+    bool Matches(int width, int height, int centerX, int centerY, uint8_t radiusScale) const
+    {
+        return width == _width && height == _height && centerX == _centerX && centerY == _centerY && radiusScale == _radiusScale;
+    }
+
+    // Get
+    //
+    // Returns the shared map for this center and radius scale, building it if nobody is holding one right now.
+    // Safe to call from Prepare(), which may be running on another task.
+
+    static std::shared_ptr<const PolarMap> Get(int centerX, int centerY, uint8_t radiusScale = 1,
+                                               int width = MATRIX_WIDTH, int height = MATRIX_HEIGHT)
+    {
+        static std::mutex mapsMutex;
+        static std::vector<std::weak_ptr<const PolarMap>> maps;
+
+        std::lock_guard<std::mutex> guard(mapsMutex);
+
+        for (auto it = maps.begin(); it != maps.end(); )
+        {
+            auto map = it->lock();
+            if (!map)
+            {
+                it = maps.erase(it);
+                continue;
+            }
+
+            if (map->Matches(width, height, centerX, centerY, radiusScale))
+                return map;
+
+            ++it;
+        }
+
+        std::shared_ptr<const PolarMap> map = make_shared_psram<PolarMap>(width, height, centerX, centerY, radiusScale);
+        maps.push_back(map);
+        return map;
+    }
+};
@@ -0,0 +1,161 @@
+//+--------------------------------------------------------------------------
+//
+// File:        powermodel.h
+//
+// NightDriverStrip - (c) 2018 Plummer's Software LLC.  All Rights Reserved.
+//
+// This file is part of the NightDriver software project.
+//
+//    NightDriver is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    NightDriver is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with Nightdriver.  It is normally found in copying.txt
+//    If not, see <https://www.gnu.org/licenses/>.
+//
+//
+// Description:
+//
+//    Integer power estimation shared by the matrix and strip outputs. A
+//    frame is reduced to three sums - one per color channel - and the
+//    milliwatt coefficients are applied to those once, rather than to
+//    every pixel.
+//
+//
+// History:     Oct-19-2026                     Created for NightDriverStrip
+//
+//---------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "pixeltypes.h"
+
+// ChannelSums
+//
+// The sum of each color channel over a frame. Even a 64K pixel frame at full white stays well within 32 bits.
+
+struct ChannelSums
+{
+    uint32_t red   = 0;
+    uint32_t green = 0;
+    uint32_t blue  = 0;
+
+    void Add(const CRGB & pixel)
+    {
+        red   += pixel.r;
+        green += pixel.g;
+        blue  += pixel.b;
+    }
+
+    ChannelSums & operator+=(const ChannelSums & other)
+    {
+        red   += other.red;
+        green += other.green;
+        blue  += other.blue;
+        return *this;
+    }
+
+    ChannelSums & operator-=(const ChannelSums & other)
+    {
+        red   -= other.red;
+        green -= other.green;
+        blue  -= other.blue;
+        return *this;
+    }
+};
+
+inline ChannelSums SumChannels(const CRGB * pixels, size_t count)
+{
+    ChannelSums sums;
+    for (size_t i = 0; i < count; i++)
+        sums.Add(pixels[i]);
+    return sums;
+}
+
+// PowerEstimate
+//
+// Milliwatts drawn by each color channel, plus the part of the load that doesn't depend on what's displayed
+
+struct PowerEstimate
+{
+    uint32_t red_mW   = 0;
+    uint32_t green_mW = 0;
+    uint32_t blue_mW  = 0;
+    uint32_t fixed_mW = 0;
+
+    uint32_t Variable() const
+    {
+        return red_mW + green_mW + blue_mW;
+    }
+
+    uint32_t Total() const
+    {
+        return fixed_mW + Variable();
+    }
+
+    // The estimate for the same frame shown at the given brightness
+    PowerEstimate Scaled(uint8_t brightness) const
+    {
+        PowerEstimate scaled = *this;
+        scaled.red_mW   = red_mW   * brightness / 255;
+        scaled.green_mW = green_mW * brightness / 255;
+        scaled.blue_mW  = blue_mW  * brightness / 255;
+        return scaled;
+    }
+
+    // LimitedBrightness
+    //
+    // The brightness, up to target, at which this frame's whole load scaled by brightness stays within limit_mW.
+    // That's how both outputs and FastLED have always limited power. Strictly only the color channels dim, but
+    // taking the fixed load off the budget first would leave the dimmest power limits with nothing to show.
+
+    uint8_t LimitedBrightness(uint8_t target, uint32_t limit_mW) const
+    {
+        const uint64_t requested = (uint64_t)Total() * target / 255;
+        if (requested <= limit_mW)
+            return target;
+
+        return (uint8_t)(target * (uint64_t)limit_mW / requested);
+    }
+};
+
+// PowerModel
+//
+// Coefficients are microwatts for one pixel with that channel at 255, so the matrix's fractional milliwatt
+// figures can stay in integer math.
+
+struct PowerModel
+{
+    uint32_t base_mW;                                                      // Controller and anything else always on
+    uint32_t darkPixel_uW;                                                 // Each pixel's driver, even when off
+    uint32_t red_uW;
+    uint32_t green_uW;
+    uint32_t blue_uW;
+
+    PowerEstimate Estimate(const ChannelSums & sums, size_t pixelCount) const
+    {
+        constexpr uint64_t kScale = 255 * 1000;                            // 255 per channel at full, uW -> mW
+
+        PowerEstimate estimate;
+        estimate.red_mW   = (uint64_t)sums.red   * red_uW   / kScale;
+        estimate.green_mW = (uint64_t)sums.green * green_uW / kScale;
+        estimate.blue_mW  = (uint64_t)sums.blue  * blue_uW  / kScale;
+        estimate.fixed_mW = base_mW + (uint64_t)pixelCount * darkPixel_uW / 1000;
+        return estimate;
+    }
+};
+
+// Measured on a 64x32 HUB75 panel
+constexpr PowerModel kMatrixPowerModel { 1500, 0, 4100, 820, 1750 };
+
+// FastLED's figures for WS2812B at 5V: 16, 11 and 15 mA per channel, 1 mA per dark pixel and 25 mA for the MCU
+constexpr PowerModel kStripPowerModel { 25 * 5, 1 * 5 * 1000, 16 * 5 * 1000, 11 * 5 * 1000, 15 * 5 * 1000 };
@@ -99,8 +99,8 @@ private:
     int                         _numLeds;
     int                         _server_fd;
     struct sockaddr_in          _address;
-    std::unique_ptr<uint8_t []> _pBuffer;
-    std::unique_ptr<uint8_t []> _abOutputBuffer;
+    psram_unique_ptr<uint8_t []> _pBuffer;
+    psram_unique_ptr<uint8_t []> _abOutputBuffer;
 
 public:
 
@@ -112,7 +112,7 @@ public:
         _server_fd(-1),
         _cbReceived(0)
     {
-        _abOutputBuffer.reset( psram_allocator<uint8_t>().allocate(MAXIMUM_PACKET_SIZE+1) );        // +1 for uzlib one byte overreach bug
+        _abOutputBuffer = make_unique_psram_array<uint8_t>(MAXIMUM_PACKET_SIZE+1);        // +1 for uzlib one byte overreach bug
         memset(&_address, 0, sizeof(_address));
     }
 
@@ -128,7 +128,7 @@ public:
 
     bool begin()
     {
-        _pBuffer.reset( psram_allocator<uint8_t>().allocate(MAXIMUM_PACKET_SIZE) );
+        _pBuffer = make_unique_psram_array<uint8_t>(MAXIMUM_PACKET_SIZE);
         _cbReceived = 0;
 
         // Creating socket file descriptor
@@ -471,9 +471,9 @@ public:
 
     ~SoundAnalyzer()
     {
-        free(_vReal);
-        free(_vImaginary);
-        free(_vPeaks);
+        PreferPSRAMFree(_vReal);
+        PreferPSRAMFree(_vImaginary);
+        PreferPSRAMFree(_vPeaks);
     }
 
     // BeatEnhance
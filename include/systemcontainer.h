@@ -73,6 +73,11 @@
   private: \
     std::unique_ptr<::__VA_ARGS__> SC_MEMBER(name) = nullptr;
 
+// Declares the member variable for a property that's created with make_unique_psram
+#define SC_DECLARE_PSRAM(name, ...) \
+  private: \
+    psram_unique_ptr<::__VA_ARGS__> SC_MEMBER(name) = nullptr;
+
 // Creates a Setup method for a property (with indicated type and name) that invokes a parameterless constructor
 #define SC_SIMPLE_SETUP_FOR(name, ...) \
   public: \
@@ -124,8 +129,8 @@ class SystemContainer
 {
   private:
     // Helper method that checks if a pointer is initialized. Throws a runtime error if not.
-    template<typename Tp>
-    inline void CheckPointer(const std::unique_ptr<Tp>& pointer, const String& name) const
+    template<typename Tp, typename Dp>
+    inline void CheckPointer(const std::unique_ptr<Tp, Dp>& pointer, const String& name) const
     {
         if (!pointer)
         {
@@ -143,7 +148,7 @@ class SystemContainer
     // -------------------------------------------------------------
     // BufferManagers
 
-    SC_DECLARE(BufferManagers, std::vector<LEDBufferManager, psram_allocator<LEDBufferManager>>)
+    SC_DECLARE_PSRAM(BufferManagers, std::vector<LEDBufferManager, psram_allocator<LEDBufferManager>>)
 
     public: std::vector<LEDBufferManager, psram_allocator<LEDBufferManager>>& SetupBufferManagers()
     {
@@ -197,7 +202,7 @@ class SystemContainer
     // -------------------------------------------------------------
     // TaskManager
 
-    SC_DECLARE(TaskManager, NightDriverTaskManager)
+    SC_DECLARE_PSRAM(TaskManager, NightDriverTaskManager)
 
     // Creates, begins and returns the TaskManager
     public: ::NightDriverTaskManager& SetupTaskManager()
@@ -216,8 +221,8 @@ class SystemContainer
     // -------------------------------------------------------------
     // Config objects: JSONWriter, DeviceConfig
 
-    SC_DECLARE(DeviceConfig, DeviceConfig)
-    SC_DECLARE(JSONWriter, JSONWriter)
+    SC_DECLARE_PSRAM(DeviceConfig, DeviceConfig)
+    SC_DECLARE_PSRAM(JSONWriter, JSONWriter)
 
     // Creates and returns the config objects. Requires TaskManager to have already been setup.
     public: void SetupConfig()
@@ -276,7 +281,7 @@ class SystemContainer
     // Display
 
     #if USE_SCREEN
-        SC_DECLARE(Display, Screen)
+        SC_DECLARE_PSRAM(Display, Screen)
 
         // Creates and returns the display. The exact screen type is a template argument.
         public: template<typename Ts, typename... Args>
@@ -291,4 +296,4 @@ class SystemContainer
     #endif
 };
 
-extern DRAM_ATTR std::unique_ptr<SystemContainer> g_ptrSystem;
+extern DRAM_ATTR psram_unique_ptr<SystemContainer> g_ptrSystem;
@@ -58,6 +58,8 @@
 #define NET_STACK_SIZE     8192
 #define DEBUG_STACK_SIZE   8192                 // Needs a lot of stack for output if UpdateClockFromWeb is called from debugger
 #define REMOTE_STACK_SIZE  4096
+#define PREPARE_STACK_SIZE 8192                 // Loads effects (JSON, Init) and indexes uploaded GIFs
+#define PREPARE_STACK_MARGIN 1024               // Complain when a prepare leaves less stack than this unused
 
 class IdleTask
 {
@@ -214,6 +216,7 @@ void IRAM_ATTR SocketServerTaskEntry(void *);
 void IRAM_ATTR RemoteLoopEntry(void *);
 void IRAM_ATTR JSONWriterTaskEntry(void *);
 void IRAM_ATTR ColorDataTaskEntry(void *);
+void IRAM_ATTR EffectPrepareTaskEntry(void *);
 
 #define DELETE_TASK(handle) if (handle != nullptr) vTaskDelete(handle)
 
@@ -246,6 +249,7 @@ private:
     TaskHandle_t _taskSerial        = nullptr;
     TaskHandle_t _taskColorData     = nullptr;
     TaskHandle_t _taskJSONWriter    = nullptr;
+    TaskHandle_t _taskEffectPrepare = nullptr;
 
     std::vector<TaskHandle_t> _vEffectTasks;
 
@@ -278,6 +282,7 @@ public:
         DELETE_TASK(_taskSocket);
         DELETE_TASK(_taskNetwork);
         DELETE_TASK(_taskJSONWriter);
+        DELETE_TASK(_taskEffectPrepare);
         DELETE_TASK(_taskDebug);
     }
 
@@ -367,6 +372,22 @@ public:
         CheckHeap();
     }
 
+    void StartEffectPrepareThread()
+    {
+        Serial.print( str_sprintf(">> Launching Effect Prepare Thread.  Mem: %u, LargestBlk: %u, PSRAM Free: %u/%u, ", ESP.getFreeHeap(),ESP.getMaxAllocHeap(), ESP.getFreePsram(), ESP.getPsramSize()) );
+        xTaskCreatePinnedToCore(EffectPrepareTaskEntry, "Effect Prepare Loop", PREPARE_STACK_SIZE, nullptr, EFFECTPREPARE_PRIORITY, &_taskEffectPrepare, EFFECTPREPARE_CORE);
+        CheckHeap();
+    }
+
+    void NotifyEffectPrepareThread()
+    {
+        if (_taskEffectPrepare == nullptr)
+            return;
+
+        // Wake up the preparation task; it will pick up whichever effect was queued last
+        xTaskNotifyGive(_taskEffectPrepare);
+    }
+
     void NotifyJSONWriterThread()
     {
         if (_taskJSONWriter == nullptr)
@@ -35,6 +35,7 @@
 #include <sys/time.h>
 #include <optional>
 #include <WString.h>
+#include "memoryaccounting.h"
 
 #ifndef MICROS_PER_SECOND
     #define MICROS_PER_SECOND 1000000
@@ -234,19 +235,34 @@ struct SettingSpec
 
 // PreferPSRAMAlloc
 //
-// Will return PSRAM if it's available, regular ram otherwise
+// Will return PSRAM if it's available, regular ram otherwise. The allocation is counted against the active
+// memory account, if there is one; see memoryaccounting.h. Memory from here must be given back with PreferPSRAMFree.
 
 inline void * PreferPSRAMAlloc(size_t s)
 {
+    void * p;
+
     if (psramInit())
     {
         debugV("PSRAM Array Request for %u bytes\n", s);
-        return ps_malloc(s);
+        p = ps_malloc(s + kMemoryBlockHeaderSize);
     }
     else
     {
-        return malloc(s);
+        p = malloc(s + kMemoryBlockHeaderSize);
     }
+
+    return p ? TrackAllocation(p, s) : nullptr;
+}
+
+// PreferPSRAMFree
+//
+// Frees memory from PreferPSRAMAlloc, and takes it off the account it was booked to
+
+inline void PreferPSRAMFree(void * p)
+{
+    if (p)
+        free(TrackFree(p));
 }
 
 // psram_allocator
@@ -292,7 +308,7 @@ public:
 
     void deallocate(pointer p, size_type n)
     {
-        free(p);
+        PreferPSRAMFree(p);
     }
 
     template< class U, class... Args >
@@ -307,12 +323,20 @@ public:
     }
 };
 
-// Typically we do not need a deleter because the regular one can handle PSRAM deallocations just fine,
-// but for completeness, here it is.
+// psram_deleter
+//
+// Destroys and frees what make_unique_psram hands out. Memory from psram_allocator carries a header that the
+// regular delete knows nothing about, so a unique_ptr to it needs this deleter.  A pointer to a base class can
+// take over the deleter, as long as that base sits at the start of the object (which single inheritance gives us).
 
 template<typename T>
 struct psram_deleter
 {
+    psram_deleter() = default;
+
+    template<typename U>
+    psram_deleter(const psram_deleter<U>&) {}
+
     void operator()(T* ptr)
     {
         psram_allocator<T> allocator;
@@ -321,28 +345,40 @@ struct psram_deleter
     }
 };
 
+// The array version only frees, as make_unique_psram_array doesn't construct the elements either
+
+template<typename T>
+struct psram_deleter<T[]>
+{
+    void operator()(T* ptr)
+    {
+        psram_allocator<T>().deallocate(ptr, 0);
+    }
+};
+
+template<typename T>
+using psram_unique_ptr = std::unique_ptr<T, psram_deleter<T>>;
+
 // make_unique_psram
 //
-// Like std::make_unique, but returns PSRAM instead of base RAM.  We cheat a little here by not providing
-// a deleter, because we know that PSRAM can be freed with the regular free() call and does not require
-// special handling.
+// Like std::make_unique, but returns PSRAM instead of base RAM
 
 template<typename T, typename... Args>
-std::unique_ptr<T> make_unique_psram(Args&&... args)
+psram_unique_ptr<T> make_unique_psram(Args&&... args)
 {
     psram_allocator<T> allocator;
     T* ptr = allocator.allocate(1);
     allocator.construct(ptr, std::forward<Args>(args)...);
-    return std::unique_ptr<T>(ptr);
+    return psram_unique_ptr<T>(ptr);
 }
 
 template<typename T>
-std::unique_ptr<T[]> make_unique_psram_array(size_t size)
+psram_unique_ptr<T[]> make_unique_psram_array(size_t size)
 {
     psram_allocator<T> allocator;
     T* ptr = allocator.allocate(size);
     // No need to call construct since arrays don't have constructors
-    return std::unique_ptr<T[]>(ptr);
+    return psram_unique_ptr<T[]>(ptr);
 }
 
 // make_shared_psram
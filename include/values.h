@@ -33,6 +33,7 @@
 #include <esp_attr.h>
 #include "globals.h"
 #include "types.h"
+#include "powermodel.h"
 
 // Struct with global values that are not persisted as settings - those reside in DeviceConfig
 struct Values
@@ -41,6 +42,7 @@ struct Values
     volatile double FreeDrawTime = 0.0;
     float Brite;
     uint32_t Watts;
+    PowerEstimate PowerDraw;                                                // Last frame's estimated draw, per color channel
     uint32_t FPS = 0;                                                       // Our global framerate
     bool UpdateStarted = false;                                             // Has an OTA update started?
     uint8_t Fader = 255;
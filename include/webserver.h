@@ -160,6 +160,9 @@ class CWebServer
     static bool CheckAndGetSettingsEffect(AsyncWebServerRequest * pRequest, std::shared_ptr<LEDStripEffect> & effect, bool post = false);
     static void SendEffectSettingsResponse(AsyncWebServerRequest * pRequest, std::shared_ptr<LEDStripEffect> & effect);
     static bool ApplyEffectSettings(AsyncWebServerRequest * pRequest, std::shared_ptr<LEDStripEffect> & effect);
+    static void FailAssetUpload(AsyncWebServerRequest * pRequest, const String & fileName, const String & message);
+    static void QueueAssetChange(const String & name, bool remove);
+    static void StorePendingAssets();
 
     // Endpoint member functions
 
@@ -180,6 +183,10 @@ class CWebServer
     static void DeleteEffect(AsyncWebServerRequest * pRequest);
     static void NextEffect(AsyncWebServerRequest * pRequest);
     static void PreviousEffect(AsyncWebServerRequest * pRequest);
+    static void GetAssetList(AsyncWebServerRequest * pRequest);
+    static void UploadAsset(AsyncWebServerRequest * pRequest, const String & fileName, size_t index, uint8_t * data, size_t length, bool final);
+    static void FinishAssetUpload(AsyncWebServerRequest * pRequest);
+    static void DeleteAsset(AsyncWebServerRequest * pRequest);
 
     // Not static because it uses member _staticStats
     void GetStatistics(AsyncWebServerRequest * pRequest);
@@ -192,6 +192,71 @@ int CalcDelayUntilNextFrame(double frameStartTime, uint16_t localPixelsDrawn, ui
 #endif
 }
 
+// AdjustEffectQuality
+//
+// Lowers the quality level of the current effect when its frames keep taking longer than its frame budget, and
+// raises it again once frames have been finishing well within budget for a while. The frame counts provide the
+// hysteresis that keeps us from flipping between two levels on alternating frames. Effects that don't support
+// quality scaling are left alone.
+
+void AdjustEffectQuality(double frameStartTime, uint16_t localPixelsDrawn)
+{
+    constexpr auto kOverBudgetFactor  = 1.05;   // Frame time over this fraction of the budget counts as a miss
+    constexpr auto kHeadroomFactor    = 0.70;   // Frame time under this fraction of the budget counts as headroom
+    constexpr auto kFramesToLower     = 10;     // Consecutive misses before we drop a level
+    constexpr auto kFramesToRaise     = 90;     // Consecutive frames with headroom before we go up a level
+
+    static const LEDStripEffect * pLastEffect = nullptr;
+    static int slowFrames = 0;
+    static int fastFrames = 0;
+
+    if (localPixelsDrawn == 0 || !g_ptrSystem->HasEffectManager())
+        return;
+
+    auto& effect = g_ptrSystem->EffectManager().GetCurrentEffect();
+
+    // Every effect gets a fresh start at full quality when it becomes the current one
+
+    if (&effect != pLastEffect)
+    {
+        pLastEffect = &effect;
+        slowFrames = fastFrames = 0;
+        effect.SetQualityLevel(LEDStripEffect::kMaxQualityLevel);
+    }
+
+    if (!effect.SupportsQualityScaling())
+        return;
+
+    const double frameBudget = 1.0 / effect.DesiredFramesPerSecond();
+    const double frameTime = g_Values.AppTime.CurrentTime() - frameStartTime;
+    const auto level = effect.QualityLevel();
+
+    if (frameTime > frameBudget * kOverBudgetFactor)
+    {
+        fastFrames = 0;
+        if (++slowFrames >= kFramesToLower && level > 0)
+        {
+            effect.SetQualityLevel(level - 1);
+            slowFrames = 0;
+            debugI("Frames of %s over budget, lowering quality to %d", effect.FriendlyName().c_str(), level - 1);
+        }
+    }
+    else if (frameTime < frameBudget * kHeadroomFactor)
+    {
+        slowFrames = 0;
+        if (++fastFrames >= kFramesToRaise && level < LEDStripEffect::kMaxQualityLevel)
+        {
+            effect.SetQualityLevel(level + 1);
+            fastFrames = 0;
+            debugI("Frames of %s within budget, raising quality to %d", effect.FriendlyName().c_str(), level + 1);
+        }
+    }
+    else
+    {
+        slowFrames = fastFrames = 0;
+    }
+}
+
 // ShowOnboardLED
 //
 // If the board has an onboard LED, this will update it to show some activity from the draw
@@ -291,11 +356,23 @@ void IRAM_ATTR DrawLoopTaskEntry(void *)
             ShowOnboardRGBLED();
 
             g_Values.FPS = FastLED.getFPS();
-            g_ptrSystem->EffectManager().SetNewFrameAvailable(true);
+
+            // The color data server only needs to send frames that have something new in them
+
+            if (graphics->IsFrameDirty())
+                g_ptrSystem->EffectManager().SetNewFrameAvailable(true);
         }
 
         graphics->PostProcessFrame(wifiPixelsDrawn, localPixelsDrawn);
 
+        // Whatever is drawn from here on counts toward the next frame's dirty span
+
+        if (wifiPixelsDrawn + localPixelsDrawn > 0)
+            for (auto& device : g_ptrSystem->Devices())
+                device->ClearDirty();
+
+        AdjustEffectQuality(frameStartTime, localPixelsDrawn);
+
         // Delay at least 2ms and not more than 1s until next frame is due
 
         constexpr auto minimumDelay = 5;
@@ -34,10 +34,11 @@
 #include "systemcontainer.h"
 
 #include "effects/strip/misceffects.h"
+#include "lazyeffect.h"
 
 // Variables we need further down
 
-extern DRAM_ATTR std::unique_ptr<EffectFactories> g_ptrEffectFactories;
+extern DRAM_ATTR psram_unique_ptr<EffectFactories> g_ptrEffectFactories;
 extern std::map<int, JSONEffectFactory> g_JsonStarryNightEffectFactories;
 DRAM_ATTR size_t g_EffectsManagerJSONBufferSize = 0;
 static DRAM_ATTR size_t l_EffectsManagerJSONWriterIndex = std::numeric_limits<size_t>::max();
@@ -105,6 +106,8 @@ void InitEffectsManager()
     if (false == g_ptrSystem->EffectManager().Init())
         throw std::runtime_error("Could not initialize effect manager");
 
+    debugI("Effects initialized. Free heap: %u, free PSRAM: %u, lazy effects: %d", ESP.getFreeHeap(), ESP.getFreePsram(), USE_LAZY_EFFECTS);
+
     // We won't need the default factories anymore, so swipe them from memory
     g_ptrEffectFactories->ClearDefaultFactories();
 }
@@ -161,7 +164,14 @@ void EffectManager::LoadJSONAndMissingEffects(const JsonArrayConst& effectsArray
         if (factoryEntry == jsonFactories.end())
             continue;
 
-        auto pEffect = factoryEntry->second(effectObject);
+        #if USE_LAZY_EFFECTS
+            auto pEffect = CanLoadEffectOnDemand(effectNumber)
+                ? make_shared_psram<LazyEffect>(effectObject, factoryEntry->second)
+                : factoryEntry->second(effectObject);
+        #else
+            auto pEffect = factoryEntry->second(effectObject);
+        #endif
+
         if (pEffect)
         {
             if (effectObject[PTY_COREEFFECT].as<int>())
@@ -232,6 +242,349 @@ std::shared_ptr<LEDStripEffect> EffectManager::CopyEffect(size_t index)
     return copiedEffect;
 }
 
+void EffectManager::LoadJSONLayers(const JsonArrayConst& layersArray)
+{
+    auto& jsonFactories = g_ptrEffectFactories->GetJSONFactories();
+
+    for (auto layerObject : layersArray)
+    {
+        auto effectObject = layerObject[PTY_EFFECT].as<JsonObjectConst>();
+        if (effectObject.isNull())
+            continue;
+
+        auto factoryEntry = jsonFactories.find(effectObject[PTY_EFFECTNR].as<int>());
+        if (factoryEntry == jsonFactories.end())
+        {
+            debugW("Skipping effect layer with unknown effect number %d", effectObject[PTY_EFFECTNR].as<int>());
+            continue;
+        }
+
+        auto pEffect = factoryEntry->second(effectObject);
+        if (!pEffect)
+            continue;
+
+        int blendMode = layerObject[PTY_BLEND] | to_value(LayerBlendMode::Alpha);
+        blendMode = std::clamp(blendMode, to_value(LayerBlendMode::Add), to_value(LayerBlendMode::Max));
+
+        _vLayers.emplace_back(pEffect, static_cast<LayerBlendMode>(blendMode), layerObject[PTY_OPACITY] | (uint8_t)255);
+    }
+}
+
+// DrawEffect
+//
+// Draws the main effect. On the matrix, for effects that don't declare whether they need the back buffer copy
+// and that we're still measuring, a sample frame is drawn twice: first over the previous frame with every bit
+// inverted, then over the previous frame itself. A pixel only counts as written if both draws left the same
+// value in it. That rules out anything that fades, blurs, blends or adds onto the old frame, but also anything
+// random and anything that moves on between the two draws, so most animated effects read as partial and keep
+// their copy even if they do paint every pixel. The second draw is over the real previous frame, so that's the
+// frame we show, but it's a step further on: while measuring, the effect runs one extra step every
+// kCoverageSampleInterval frames, for at most kCoverageSamplesNeeded samples.
+
+void EffectManager::DrawEffect(LEDStripEffect& effect)
+{
+    #if USE_HUB75
+        auto& gfx = *_gfx[0];
+
+        if (!_tempEffect && effect.IsCoverageSampleDue())
+        {
+            const size_t count = gfx.GetLEDCount();
+            _coverageScratch.resize(count);
+            _coverageSample.resize(count);
+            memcpy((void *) _coverageScratch.data(), gfx.leds, sizeof(CRGB) * count);
+
+            for (size_t i = 0; i < count; i++)
+                gfx.leds[i] = -_coverageScratch[i];
+
+            effect.Draw();
+            memcpy((void *) _coverageSample.data(), gfx.leds, sizeof(CRGB) * count);
+            memcpy((void *) gfx.leds, _coverageScratch.data(), sizeof(CRGB) * count);
+
+            effect.Draw();
+
+            size_t unwritten = 0;
+            for (size_t i = 0; i < count; i++)
+                if (gfx.leds[i] != _coverageSample[i])
+                    unwritten++;
+
+            effect.RecordCoverageSample(unwritten == 0);
+
+            const auto policy = effect.GetDoubleBufferPolicy();
+            if (policy != LEDStripEffect::DoubleBufferPolicy::Measuring)
+            {
+                debugI("%s %s the back buffer copy", effect.FriendlyName().c_str(),
+                       policy == LEDStripEffect::DoubleBufferPolicy::MeasuredNotRequired ? "doesn't need" : "needs");
+                _coverageScratch = decltype(_coverageScratch)();
+                _coverageSample = decltype(_coverageSample)();
+            }
+            return;
+        }
+    #endif
+
+    effect.Draw();
+}
+
+// DrawLayers
+//
+// Draws each effect layer into its own buffer(s) by temporarily pointing the devices' leds at them, so the
+// effects themselves don't need to know they're a layer. A layer is only redrawn when its own frame interval
+// has passed; in between, the frame it drew last is blended again. Effects that don't clear their buffer
+// between frames keep doing so, since each layer owns its buffers for as long as it exists.
+
+void EffectManager::DrawLayers()
+{
+    CRGB * frameLeds[NUM_CHANNELS];
+    assert(_gfx.size() <= NUM_CHANNELS);
+
+    auto now = millis();
+
+    for (auto& layer : _vLayers)
+    {
+        if (layer.Buffers.empty())
+        {
+            for (auto& device : _gfx)
+            {
+                auto buffer = make_unique_psram_array<CRGB>(device->GetLEDCount());
+                memset((void *) buffer.get(), 0, sizeof(CRGB) * device->GetLEDCount());
+                layer.Buffers.push_back(std::move(buffer));
+            }
+        }
+
+        auto fps = layer.Effect->DesiredFramesPerSecond();
+        if (layer.Started && fps > 0 && now - layer.LastDrawTime < 1000 / fps)
+            continue;
+
+        for (size_t i = 0; i < _gfx.size(); i++)
+        {
+            frameLeds[i] = _gfx[i]->leds;
+            _gfx[i]->leds = layer.Buffers[i].get();
+        }
+
+        MemoryAccountScope memoryScope(layer.Effect->GetMemoryAccount());
+
+        if (!layer.Started)
+        {
+            layer.Effect->EnsurePrepared();
+            layer.Effect->Start();
+            layer.Started = true;
+        }
+
+        layer.Effect->Draw();
+        layer.LastDrawTime = now;
+
+        for (size_t i = 0; i < _gfx.size(); i++)
+            _gfx[i]->leds = frameLeds[i];
+    }
+
+    BlendLayers();
+}
+
+// BlendLayerPixel
+//
+// Combines one layer pixel with the frame pixel underneath it. A black layer pixel leaves the frame pixel
+// unchanged in every blend mode, so we bail out early for those; most layers are mostly black.
+
+static inline CRGB BlendLayerPixel(const CRGB& frame, const CRGB& layer, LayerBlendMode blendMode, uint8_t opacity)
+{
+    if (!layer)
+        return frame;
+
+    switch (blendMode)
+    {
+        case LayerBlendMode::Add:
+        {
+            CRGB added = layer;
+            added.nscale8(opacity);
+            return frame + added;
+        }
+
+        case LayerBlendMode::Screen:
+        {
+            CRGB screened(255 - scale8(255 - frame.r, 255 - layer.r),
+                          255 - scale8(255 - frame.g, 255 - layer.g),
+                          255 - scale8(255 - frame.b, 255 - layer.b));
+            return blend(frame, screened, opacity);
+        }
+
+        case LayerBlendMode::Max:
+        {
+            CRGB brightest(std::max(frame.r, layer.r), std::max(frame.g, layer.g), std::max(frame.b, layer.b));
+            return blend(frame, brightest, opacity);
+        }
+
+        case LayerBlendMode::Alpha:
+        default:
+            return blend(frame, layer, opacity);
+    }
+}
+
+// BlendLayers
+//
+// Blends all layers onto the frame in a single pass over each channel's pixels, applying the layers in
+// the order they were configured.
+
+void EffectManager::BlendLayers()
+{
+    for (size_t channel = 0; channel < _gfx.size(); channel++)
+    {
+        CRGB * pFrame = _gfx[channel]->leds;
+        const size_t count = _gfx[channel]->GetLEDCount();
+
+        for (size_t i = 0; i < count; i++)
+        {
+            CRGB pixel = pFrame[i];
+
+            for (auto& layer : _vLayers)
+                pixel = BlendLayerPixel(pixel, layer.Buffers[channel][i], layer.BlendMode, layer.Opacity);
+
+            pFrame[i] = pixel;
+        }
+    }
+}
+
+// PrepareNextEffectIfDue
+//
+// Once the current effect is about to expire, we queue the next one for preparation on the effect preparation
+//   task, which runs on the other core. That way, the heavy lifting some effects do before they can start
+//   doesn't stall the draw loop at the moment we switch.
+
+void EffectManager::PrepareNextEffectIfDue()
+{
+    if (_tempEffect || EffectCount() < 2)
+        return;
+
+    if (IsIntervalEternal() && !GetCurrentEffect().HasMaximumEffectTime())
+        return;
+
+    if (GetTimeRemainingForCurrentEffect() > EFFECT_PREPARE_LOOKAHEAD)
+        return;
+
+    auto& nextEffect = _vEffects[GetNextEffectIndex()];
+
+    if (nextEffect == _vEffects[_iCurrentEffect] || !nextEffect->NeedsPreparation())
+        return;
+
+    if (_queuedEffect == nextEffect)
+        return;
+
+    AbandonQueuedEffect(nextEffect);
+    _queuedEffect = nextEffect;
+
+    std::atomic_store(&_effectToPrepare, nextEffect);
+    g_ptrSystem->TaskManager().NotifyEffectPrepareThread();
+}
+
+// AbandonQueuedEffect
+//
+// Called when the effect we queued for preparation turns out not to be the next one to start, for instance because
+//   another effect was picked in the meantime. If it was prepared already, it lets go of what that set up, and
+//   it'll be prepared afresh when its turn does come.
+
+void EffectManager::AbandonQueuedEffect(const std::shared_ptr<LEDStripEffect>& effectToKeep)
+{
+    if (!_queuedEffect || _queuedEffect == effectToKeep)
+        return;
+
+    // If the preparation task hasn't picked it up yet, it doesn't have to
+    auto expected = _queuedEffect;
+    std::atomic_compare_exchange_strong(&_effectToPrepare, &expected, std::shared_ptr<LEDStripEffect>());
+
+    debugV("Abandoning preparation of %s", _queuedEffect->FriendlyName().c_str());
+    _queuedEffect->AbandonPreparation();
+
+    // An effect that's loaded on demand was most likely only loaded to be prepared
+    #if USE_LAZY_EFFECTS
+        if (_queuedEffect->IsLoadedOnDemand() && _queuedEffect != _startedEffect)
+            static_cast<LazyEffect *>(_queuedEffect.get())->Release();
+    #endif
+
+    _queuedEffect.reset();
+}
+
+// EffectPrepareTaskEntry
+//
+// Prepares effects ahead of their start whenever the effect manager asks us to
+
+void IRAM_ATTR EffectPrepareTaskEntry(void *)
+{
+    for(;;)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        if (g_ptrSystem->HasEffectManager())
+            g_ptrSystem->EffectManager().PrepareQueuedEffect();
+    }
+}
+
+#if USE_LAZY_EFFECTS
+
+// LoadOnDemand
+//
+// Swaps a freshly constructed effect for a stand-in that holds only its settings and constructs it again when needed.
+// If we can't, we keep the effect as it is.
+
+std::shared_ptr<LEDStripEffect> EffectManager::LoadOnDemand(const std::shared_ptr<LEDStripEffect>& effect)
+{
+    if (!CanLoadEffectOnDemand(effect->EffectNumber()))
+        return effect;
+
+    auto& jsonFactories = g_ptrEffectFactories->GetJSONFactories();
+    auto factoryEntry = jsonFactories.find(effect->EffectNumber());
+
+    if (factoryEntry == jsonFactories.end())
+        return effect;
+
+    static size_t jsonBufferSize = JSON_BUFFER_BASE_SIZE;
+    std::unique_ptr<AllocatedJsonDocument> ptrJsonDoc;
+
+    if (!SerializeWithBufferSize(ptrJsonDoc, jsonBufferSize, [&effect](JsonObject& jsonObject) { return effect->SerializeToJSON(jsonObject); }))
+        return effect;
+
+    auto lazyEffect = make_shared_psram<LazyEffect>(ptrJsonDoc->as<JsonObjectConst>(), factoryEntry->second);
+    if (effect->IsCoreEffect())
+        lazyEffect->MarkAsCoreEffect();
+
+    return lazyEffect;
+}
+
+// ReleaseUnusedEffects
+//
+// Releases the instances of on-demand effects that haven't been used recently, keeping the _warmEffectCount most
+// recently used ones loaded. The current effect and the one being prepared to follow it are never released; we
+// recognize them by them being prepared.
+
+void EffectManager::ReleaseUnusedEffects()
+{
+    std::vector<LazyEffect *> loadedEffects;
+
+    for (auto& effect : _vEffects)
+    {
+        if (!effect->IsLoadedOnDemand() || !effect->NeedsPreparation())
+            continue;
+
+        auto pLazyEffect = static_cast<LazyEffect *>(effect.get());
+        if (pLazyEffect->IsLoaded())
+            loadedEffects.push_back(pLazyEffect);
+    }
+
+    if (loadedEffects.size() <= _warmEffectCount)
+        return;
+
+    std::sort(loadedEffects.begin(), loadedEffects.end(), [](const LazyEffect* a, const LazyEffect* b)
+        {
+            return a->LastUsedTime() > b->LastUsedTime();
+        }
+    );
+
+    for (size_t i = _warmEffectCount; i < loadedEffects.size(); i++)
+        loadedEffects[i]->Release();
+
+    debugI("Released %zu unused effect(s). Free heap: %u, free PSRAM: %u",
+           loadedEffects.size() - _warmEffectCount, ESP.getFreeHeap(), ESP.getFreePsram());
+}
+
+#endif
+
 //
 // Helper functions related to JSON persistence
 //
@@ -317,6 +670,7 @@ bool EffectManager::Init()
     for (int i = 0; i < _vEffects.size(); i++)
     {
         debugV("About to init effect %s", _vEffects[i]->FriendlyName().c_str());
+        MemoryAccountScope memoryScope(_vEffects[i]->GetMemoryAccount());
         if (false == _vEffects[i]->Init(_gfx))
         {
             debugW("Could not initialize effect: %s\n", _vEffects[i]->FriendlyName().c_str());
@@ -326,6 +680,22 @@ bool EffectManager::Init()
     }
     debugV("First Effect: %s", GetCurrentEffectName().c_str());
 
+    // A layer that fails to initialize is dropped, as the effects underneath can do fine without it
+    for (auto layer = _vLayers.begin(); layer != _vLayers.end(); )
+    {
+        MemoryAccountScope memoryScope(layer->Effect->GetMemoryAccount());
+        if (layer->Effect->Init(_gfx))
+        {
+            debugV("Loaded Effect Layer: %s", layer->Effect->FriendlyName().c_str());
+            layer++;
+        }
+        else
+        {
+            debugW("Could not initialize effect layer: %s", layer->Effect->FriendlyName().c_str());
+            layer = _vLayers.erase(layer);
+        }
+    }
+
     if (g_ptrSystem->DeviceConfig().ApplyGlobalColors())
         ApplyGlobalPaletteColors();
 
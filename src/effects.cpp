@@ -119,6 +119,10 @@
     std::vector<SettingSpec, psram_allocator<SettingSpec>> PatternSubscribers::mySettingSpecs = {};
 #endif
 
+#if USE_HUB75
+    std::vector<SettingSpec, psram_allocator<SettingSpec>> PatternAnimatedGIF::mySettingSpecs = {};
+#endif
+
 // Effect factories for the StarryNightEffect - one per star type
 std::map<int, JSONEffectFactory> g_JsonStarryNightEffectFactories =
 {
@@ -141,7 +145,7 @@ std::map<int, JSONEffectFactory> g_JsonStarryNightEffectFactories =
 };
 
 // Default and JSON factory functions + decoration for effects
-DRAM_ATTR std::unique_ptr<EffectFactories> g_ptrEffectFactories = nullptr;
+DRAM_ATTR psram_unique_ptr<EffectFactories> g_ptrEffectFactories = nullptr;
 
 // This function sets up the effect factories for the effects for whatever project is being built. The ADD_EFFECT macro variations
 //   are provided and used for convenience.
@@ -37,55 +37,51 @@
     // The following functions are specializations of noise-related member function
     // templates declared in gfxbase.h.
 
-    template<>
-    void GFXBase::FillGetNoise<NoiseApproach::One>()
-    {
-        for (uint16_t i = 0; i < _width; i++)
-        {
-            uint32_t ioffset = _ptrNoise->noise_scale_x * (i - ((_height + 1) / 2));
-
-            for (uint16_t j = 0; j < _height; j++)
-            {
-                uint32_t joffset = _ptrNoise->noise_scale_y * (j - ((_height + 1) / 2));
+    // The noise is worked out a row at a time by NoiseField, which gives the same values as calling inoise16()
+    // for every pixel. Each new value is blended into the old one at that spot, with the old one weighted by
+    // noisesmoothing.
 
-                uint16_t data = inoise16(_ptrNoise->noise_x + ioffset, _ptrNoise->noise_y + joffset, _ptrNoise->noise_z) >> 8;
+    void GFXBase::FillNoise(int centerX, int centerY, uint8_t freshWeight, bool halfResolution)
+    {
+        Noise & noise = *_ptrNoise;
+        const uint8_t oldWeight = noise.noisesmoothing;
+
+        _noiseField->Fill(_height,
+                          noise.noise_x - noise.noise_scale_x * centerX, noise.noise_scale_x,
+                          noise.noise_y - noise.noise_scale_y * centerY, noise.noise_scale_y,
+                          noise.noise_z,
+                          halfResolution,
+                          [&](size_t y, const uint8_t * fresh)
+                          {
+                              uint8_t * values = noise.noise[y];
+                              for (size_t x = 0; x < _width; x++)
+                                  values[x] = scale8(values[x], oldWeight) + scale8(fresh[x], freshWeight);
+                          });
+    }
 
-                uint8_t olddata = _ptrNoise->noise[i][j];
-                uint8_t newdata = scale8(olddata, _ptrNoise->noisesmoothing) + scale8(data, 256 - _ptrNoise->noisesmoothing);
-                data = newdata;
+    // The two approaches differ in where they center the noise and in how much of the fresh noise they blend in
 
-                _ptrNoise->noise[i][j] = data;
-            }
-        }
+    template<>
+    void GFXBase::FillGetNoise<NoiseApproach::One>(bool halfResolution)
+    {
+        FillNoise((_height + 1) / 2, (_height + 1) / 2, 256 - _ptrNoise->noisesmoothing, halfResolution);
     }
 
     template<>
-    void GFXBase::FillGetNoise<NoiseApproach::Two>()
+    void GFXBase::FillGetNoise<NoiseApproach::Two>(bool halfResolution)
     {
-        for (uint8_t i = 0; i < WIDTH; i++)
-        {
-            int32_t ioffset = _ptrNoise->noise_scale_x * (i - CENTER_X_MINOR);
-            for (uint8_t j = 0; j < HEIGHT; j++)
-            {
-                int32_t joffset = _ptrNoise->noise_scale_y * (j - CENTER_Y_MINOR);
-                int8_t data = inoise16(_ptrNoise->noise_x + ioffset, _ptrNoise->noise_y + joffset, _ptrNoise->noise_z) >> 8;
-                int8_t olddata = _ptrNoise->noise[i][j];
-                int8_t newdata = scale8(olddata, _ptrNoise->noisesmoothing) + scale8(data, 255 - _ptrNoise->noisesmoothing);
-                data = newdata;
-                _ptrNoise->noise[i][j] = data;
-            }
-        }
+        FillNoise(CENTER_X_MINOR, CENTER_Y_MINOR, 255 - _ptrNoise->noisesmoothing, halfResolution);
     }
 
     template<>
     void GFXBase::MoveFractionalNoiseX<NoiseApproach::One>(uint8_t amt, uint8_t shift)
     {
-        std::unique_ptr<CRGB[]> ledsTemp = make_unique_psram_array<CRGB>(NUM_LEDS);
+        auto ledsTemp = make_unique_psram_array<CRGB>(NUM_LEDS);
 
         // move delta pixelwise
         for (int y = 0; y < _height; y++)
         {
-            uint16_t amount = _ptrNoise->noise[0][y] * amt;
+            uint16_t amount = _ptrNoise->noise[y][0] * amt;
             uint8_t delta = _width - 1 - (amount / 256);
 
             // Process up to the end less the dekta
@@ -103,7 +99,7 @@
 
         for (uint16_t y = 0; y < _height; y++)
         {
-            uint16_t amount = _ptrNoise->noise[0][y] * amt;
+            uint16_t amount = _ptrNoise->noise[y][0] * amt;
             uint8_t delta = _height - 1 - (amount / 256);
             uint8_t fractions = amount - (delta * 256);
 
@@ -133,7 +129,7 @@
     {
         for (uint8_t y = 0; y < HEIGHT; y++)
         {
-            int16_t amount =((int16_t)_ptrNoise->noise[0][y] - 128) * 2 * amt + shift * 256;
+            int16_t amount =((int16_t)_ptrNoise->noise[y][0] - 128) * 2 * amt + shift * 256;
             int8_t delta = abs(amount) >> 8;
             int8_t fraction = abs(amount) & 255;
             for (uint8_t x = 0; x < WIDTH; x++)
@@ -163,12 +159,12 @@
     template<>
     void GFXBase::MoveFractionalNoiseY<NoiseApproach::One>(uint8_t amt, uint8_t shift)
     {
-        std::unique_ptr<CRGB[]> ledsTemp = make_unique_psram_array<CRGB>(NUM_LEDS);
+        auto ledsTemp = make_unique_psram_array<CRGB>(NUM_LEDS);
 
         // move delta pixelwise
         for (int x = 0; x < _width; x++)
         {
-            uint16_t amount = _ptrNoise->noise[x][0] * amt;
+            uint16_t amount = _ptrNoise->noise[0][x] * amt;
             uint8_t delta = _height - 1 - (amount / 256);
 
             for (int y = 0; y < _height - delta; y++)
@@ -187,7 +183,7 @@
 
         for (uint16_t x = 0; x < _width; x++)
         {
-            uint16_t amount = _ptrNoise->noise[x][0] * amt;
+            uint16_t amount = _ptrNoise->noise[0][x] * amt;
             uint8_t delta = _height - 1 - (amount / 256);
             uint8_t fractions = amount - (delta * 256);
 
@@ -217,7 +213,7 @@
     {
         for (uint8_t x = 0; x < WIDTH; x++)
         {
-            int16_t amount = ((int16_t)_ptrNoise->noise[x][0] - 128) * 2 * amt + shift * 256;
+            int16_t amount = ((int16_t)_ptrNoise->noise[0][x] - 128) * 2 * amt + shift * 256;
             int8_t delta = abs(amount) >> 8;
             int8_t fraction = abs(amount) & 255;
             for (uint8_t y = 0; y < HEIGHT; y++)
@@ -255,9 +251,10 @@ GFXBase::GFXBase(int w, int h) : Adafruit_GFX(w, h),
 {
     #if USE_NOISE
         debugV("Allocating boids and noise");
-        _boids.reset(psram_allocator<Boid>().allocate(_width));
+        _boids = make_unique_psram_array<Boid>(_width);
         _ptrNoise = std::make_unique<Noise>();          // Avoid specific PSRAM allocation since highly random access
-        assert(_ptrNoise && _boids);
+        _noiseField = std::make_unique<NoiseField>(_width);
+        assert(_ptrNoise && _noiseField && _boids);
         debugV("Setting up noise");
         NoiseVariablesSetup();
         debugV("Filling noise");
@@ -279,5 +276,9 @@ uint16_t XY(uint8_t x, uint8_t y)
 {
     static auto& g = *(g_ptrSystem->EffectManager().g());
 
-    return g.xy(x, y);
+    #if USE_XY_TABLE
+        return g.xyLookup(x, y);
+    #else
+        return g.xy(x, y);
+    #endif
 }
@@ -71,6 +71,95 @@ void LEDMatrixGFX::StartMatrix()
     matrix.setBrightness(255);
 }
 
+// RenderCaption
+//
+// Draws the caption, with its shadow, into the title layer. Both of the layer's buffers end up holding it, so
+// it stays put from then on and we only need to do this again when the caption text changes.
+
+static constexpr size_t kCaptionCharWidth  = 6;
+static constexpr size_t kCaptionCharHeight = 10;
+static constexpr int    kCaptionY          = MATRIX_HEIGHT - 2 - kCaptionCharHeight;
+
+static String l_renderedCaption;
+static bool   l_captionRendered = false;
+
+static void RenderCaption(const String & caption)
+{
+    const rgb24 chromaKeyColor = rgb24(255, 0, 255);
+    const rgb24 shadowColor = rgb24(0, 0, 0);
+    const rgb24 titleColor = rgb24(255, 255, 255);
+
+    auto& titleLayer = LEDMatrixGFX::titleLayer;
+
+    titleLayer.setChromaKeyColor(chromaKeyColor);
+    titleLayer.setFont(font6x10);
+    titleLayer.fillScreen(chromaKeyColor);
+
+    const int y = kCaptionY;
+    const int w = caption.length() * kCaptionCharWidth;
+    const int x = (MATRIX_WIDTH / 2) - (w / 2) + 1;
+
+    auto szCaption = caption.c_str();
+    titleLayer.drawString(x - 1, y, shadowColor, szCaption);
+    titleLayer.drawString(x + 1, y, shadowColor, szCaption);
+    titleLayer.drawString(x, y - 1, shadowColor, szCaption);
+    titleLayer.drawString(x, y + 1, shadowColor, szCaption);
+    titleLayer.drawString(x, y, titleColor, szCaption);
+
+    titleLayer.swapBuffers(true);
+
+    l_renderedCaption = caption;
+    l_captionRendered = true;
+}
+
+#if SHOW_FPS_ON_MATRIX
+
+// DrawFPSOverlay
+//
+// The FPS text only changes when the frame rate does, so we only draw it then and keep a copy of the pixels
+// it covers. It's drawn over an opaque background, so on the other frames copying those rows back in gives
+// exactly the same result.
+
+static void DrawFPSOverlay(LEDMatrixGFX & matrixGFX)
+{
+    constexpr int kCharWidth  = 6;
+    constexpr int kCharHeight = 11;
+
+    static uint32_t renderedFPS = UINT32_MAX;
+    static int spriteX = 0, spriteY = 0, spriteWidth = 0;
+    static std::vector<CRGB> sprite;
+
+    if (g_Values.FPS != renderedFPS)
+    {
+        auto output = str_sprintf("FPS: %u", (unsigned) g_Values.FPS);
+
+        // 3 is half char width at current font size, 5 is half the height
+        spriteX = MATRIX_WIDTH / 2 - (3 * output.length());
+        spriteY = MATRIX_HEIGHT / 2 - 5;
+
+        LEDMatrixGFX::backgroundLayer.setFont(gohufont11);
+        LEDMatrixGFX::backgroundLayer.drawString(spriteX, spriteY, rgb24(255, 255, 255), rgb24(0, 0, 0), output.c_str());
+
+        spriteX = std::max(spriteX, 0);
+        spriteWidth = std::min<int>(output.length() * kCharWidth, MATRIX_WIDTH - spriteX);
+        sprite.resize(spriteWidth * kCharHeight);
+
+        for (int row = 0; row < kCharHeight; row++)
+            memcpy(&sprite[row * spriteWidth], &matrixGFX.leds[LEDMatrixGFX::PixelIndex(spriteX, spriteY + row)], sizeof(CRGB) * spriteWidth);
+
+        renderedFPS = g_Values.FPS;
+    }
+    else
+    {
+        for (int row = 0; row < kCharHeight; row++)
+            memcpy(&matrixGFX.leds[LEDMatrixGFX::PixelIndex(spriteX, spriteY + row)], &sprite[row * spriteWidth], sizeof(CRGB) * spriteWidth);
+    }
+
+    matrixGFX.MarkDirty(LEDMatrixGFX::PixelIndex(spriteX, spriteY), LEDMatrixGFX::PixelIndex(spriteX + spriteWidth, spriteY + kCharHeight - 1));
+}
+
+#endif
+
 void LEDMatrixGFX::PrepareFrame()
 {
     // We treat the internal matrix buffer as our own little playground to draw in, but that assumes they're
@@ -80,61 +169,35 @@ void LEDMatrixGFX::PrepareFrame()
 
     EVERY_N_MILLIS(MILLIS_PER_FRAME)
     {
-
-        #if SHOW_FPS_ON_MATRIX
-            backgroundLayer.setFont(gohufont11);
-            // 3 is half char width at curret font size, 5 is half the height.
-            string output = "FPS: " + std::to_string(g_Values.FPS);
-            backgroundLayer.drawString(MATRIX_WIDTH / 2 - (3 * output.length()), MATRIX_HEIGHT / 2 - 5, rgb24(255, 255, 255), rgb24(0, 0, 0), output.c_str());
-        #endif
-
-        auto graphics = g_ptrSystem->EffectManager().g();
-
         matrix.setCalcRefreshRateDivider(MATRIX_CALC_DIVIDER);
         matrix.setRefreshRate(MATRIX_REFRESH_RATE);
 
         auto pMatrix = std::static_pointer_cast<LEDMatrixGFX>(g_ptrSystem->EffectManager().GetBaseGraphics());
         pMatrix->setLeds(GetMatrixBackBuffer());
 
+        #if SHOW_FPS_ON_MATRIX
+            DrawFPSOverlay(*pMatrix);
+        #endif
+
         // We set ourselves to the lower of the fader value or the brightness value,
         // so that we can fade between effects without having to change the brightness
         // setting.
 
         if (g_ptrSystem->EffectManager().GetCurrentEffect().ShouldShowTitle() && pMatrix->GetCaptionTransparency() > 0.00)
         {
-            titleLayer.setFont(font3x5);
             uint8_t brite = (uint8_t)(pMatrix->GetCaptionTransparency() * 255.0);
             debugV("Caption: %d", brite);
 
-            rgb24 chromaKeyColor = rgb24(255, 0, 255);
-            rgb24 shadowColor = rgb24(0, 0, 0);
-            rgb24 titleColor = rgb24(255, 255, 255);
+            // The caption is only drawn when it changes; after that, fading it is just a matter of layer brightness
 
-            titleLayer.setChromaKeyColor(chromaKeyColor);
-            titleLayer.setFont(font6x10);
-            titleLayer.fillScreen(chromaKeyColor);
-
-            const size_t kCharWidth = 6;
-            const size_t kCharHeight = 10;
-
-            const auto caption = pMatrix->GetCaption();
-
-            int y = MATRIX_HEIGHT - 2 - kCharHeight;
-            int w = caption.length() * kCharWidth;
-            int x = (MATRIX_WIDTH / 2) - (w / 2) + 1;
-
-            auto szCaption = caption.c_str();
-            titleLayer.drawString(x - 1, y, shadowColor, szCaption);
-            titleLayer.drawString(x + 1, y, shadowColor, szCaption);
-            titleLayer.drawString(x, y - 1, shadowColor, szCaption);
-            titleLayer.drawString(x, y + 1, shadowColor, szCaption);
-            titleLayer.drawString(x, y, titleColor, szCaption);
+            const auto& caption = pMatrix->GetCaption();
+            if (!l_captionRendered || caption != l_renderedCaption)
+                RenderCaption(caption);
 
             // We enable the chromakey overlay just for the strip of screen where it appears.  This support is only
             // present in the private fork of SmartMatrix that is linked to the mesermizer project.
 
-            titleLayer.swapBuffers(false);
-            titleLayer.enableChromaKey(true, y, y + kCharHeight);
+            titleLayer.enableChromaKey(true, kCaptionY, kCaptionY + kCaptionCharHeight);
             titleLayer.setBrightness(brite); // 255 would obscure it entirely
         }
         else
@@ -158,13 +221,13 @@ void LEDMatrixGFX::PostProcessFrame(uint16_t localPixelsDrawn, uint16_t wifiPixe
     auto pMatrix = std::static_pointer_cast<LEDMatrixGFX>(g_ptrSystem->EffectManager().g());
 
     constexpr auto kCaptionPower = 500;                                                 // A guess as the power the caption will consume
-    g_Values.MatrixPowerMilliwatts = pMatrix->EstimatePowerDraw();                             // What our drawn pixels will consume
+    auto powerDraw = pMatrix->EstimatePowerDraw();                                      // What our drawn pixels will consume
 
     if (pMatrix->GetCaptionTransparency() > 0)
-        g_Values.MatrixPowerMilliwatts += kCaptionPower;
+        powerDraw.fixed_mW += kCaptionPower;
 
-    const double kMaxPower = g_ptrSystem->DeviceConfig().GetPowerLimit();
-    uint8_t scaledBrightness = std::clamp(kMaxPower / g_Values.MatrixPowerMilliwatts, 0.0, 1.0) * 255;
+    g_Values.MatrixPowerMilliwatts = powerDraw.Total();
+    uint8_t scaledBrightness = powerDraw.LimitedBrightness(255, g_ptrSystem->DeviceConfig().GetPowerLimit());
 
     // If the target brightness is lower than current, we drop to it immediately, but if its higher, we ramp the brightness back in
     // somewhat slowly to avoid flicker.  We do this by using a weighted average of the current and former brightness.  To avoid
@@ -184,8 +247,13 @@ void LEDMatrixGFX::PostProcessFrame(uint16_t localPixelsDrawn, uint16_t wifiPixe
 
     debugV("MW: %d, Setting Scaled Brightness to: %d", g_Values.MatrixPowerMilliwatts, targetBrightness);
     pMatrix->SetBrightness(targetBrightness);
+    g_Values.PowerDraw = powerDraw.Scaled(targetBrightness);
+    g_Values.Watts = g_Values.PowerDraw.Total() / 1000;
+
+    // If nothing was drawn since the last swap, the front buffer already shows this frame
 
-    MatrixSwapBuffers(g_ptrSystem->EffectManager().GetCurrentEffect().RequiresDoubleBuffering() || pMatrix->GetCaptionTransparency() > 0.0, false);
+    if (pMatrix->IsFrameDirty())
+        MatrixSwapBuffers(g_ptrSystem->EffectManager().GetCurrentEffect().NeedsBackBufferCopy() || pMatrix->GetCaptionTransparency() > 0.0, false);
 
     FastLED.countFPS();
 }
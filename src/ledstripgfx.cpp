@@ -30,8 +30,85 @@
 
 #include "globals.h"
 #include "ledstripgfx.h"
+#include "powermodel.h"
 #include "systemcontainer.h"
 
+// The output stage
+//
+// Every value of every color channel goes out through one 256-entry table that combines gamma, the user's
+// brightness and the fader, so the frame is transformed in a single pass on its way to the output buffer. The
+// table is only rebuilt when the combined brightness changes. The same pass sums the output per color channel
+// for the power estimate. A channel that would draw more than CHANNEL_POWER_LIMIT_MW on its own is then scaled
+// down by itself, and the limit for the whole load is applied by FastLED as it clocks the pixels out. While the
+// table stays the same, only the dirty span of each channel's frame has to go through it again.
+
+static uint8_t  l_outputLUT[256];
+static int      l_outputLUTBrightness = -1;
+static uint16_t l_outputPixelCount = 0;
+
+// Returns true if the table changed, in which case all output has to be redone
+static bool UpdateOutputLUT(uint8_t brightness)
+{
+    if (brightness == l_outputLUTBrightness)
+        return false;
+
+    constexpr double kGamma = STRIP_OUTPUT_GAMMA;
+
+    for (int i = 0; i < 256; i++)
+    {
+        uint8_t value = kGamma == 1.0 ? i : (uint8_t)(255.0 * pow(i / 255.0, kGamma) + 0.5);
+        l_outputLUT[i] = scale8_video(value, brightness);          // Video scaling keeps dim pixels lit, as fadeLightBy did
+    }
+    l_outputLUTBrightness = brightness;
+    return true;
+}
+
+// MapToOutput
+//
+// Runs part of the frame through the output table and keeps the sums of the output up to date. Unless we're
+// redoing the whole frame, what was there before comes off the sums first.
+
+void LEDStripGFX::MapToOutput(size_t begin, size_t end, bool wholeFrame)
+{
+    CRGB * output = _outputLeds.get();
+
+    if (wholeFrame)
+        _outputSums = ChannelSums();
+    else
+        _outputSums -= SumChannels(&output[begin], end - begin);
+
+    for (size_t i = begin; i < end; i++)
+    {
+        output[i] = CRGB(l_outputLUT[leds[i].r], l_outputLUT[leds[i].g], l_outputLUT[leds[i].b]);
+        _outputSums.Add(output[i]);
+    }
+}
+
+// LimitChannelPower
+//
+// Scales this channel's output down if it would draw more than CHANNEL_POWER_LIMIT_MW by itself. The controller
+// is shared by all channels, so it doesn't count toward any one of them. Scaled output no longer matches what the
+// output table makes of the frame, so the next frame maps this channel afresh.
+
+void LEDStripGFX::LimitChannelPower(size_t count)
+{
+    _outputPowerLimited = false;
+
+    auto estimate = kStripPowerModel.Estimate(_outputSums, count);
+    estimate.fixed_mW -= kStripPowerModel.base_mW;
+
+    const uint8_t scale = estimate.LimitedBrightness(255, CHANNEL_POWER_LIMIT_MW);
+    if (scale == 255)
+        return;
+
+    CRGB * output = _outputLeds.get();
+    for (size_t i = 0; i < count; i++)
+        output[i].nscale8_video(scale);
+
+    _outputSums = SumChannels(output, count);
+    _outputPowerLimited = true;
+}
+
 void LEDStripGFX::PostProcessFrame(uint16_t wifiPixelsDrawn, uint16_t localPixelsDrawn)
 {
     auto pixelsDrawn = wifiPixelsDrawn > 0 ? wifiPixelsDrawn : localPixelsDrawn;
@@ -53,14 +130,60 @@ void LEDStripGFX::PostProcessFrame(uint16_t wifiPixelsDrawn, uint16_t localPixel
 
     auto& effectManager = g_ptrSystem->EffectManager();
 
+    const uint8_t targetBrightness = scale8_video(g_ptrSystem->DeviceConfig().GetBrightness(), g_Values.Fader);
+    const bool wholeFrame = UpdateOutputLUT(targetBrightness) || pixelsDrawn != l_outputPixelCount;
+    l_outputPixelCount = pixelsDrawn;
+
+    bool outputChanged = wholeFrame;
+    ChannelSums sums;
     for (int i = 0; i < NUM_CHANNELS; i++) 
     {
-        FastLED[i].setLeds(effectManager.g(i)->leds, pixelsDrawn);
-        fadeLightBy(FastLED[i].leds(), FastLED[i].size(), 255 - g_ptrSystem->DeviceConfig().GetBrightness());
+        auto& device = static_cast<LEDStripGFX&>(*effectManager.g(i));
+
+        if (wholeFrame || device._outputPowerLimited)
+        {
+            device.MapToOutput(0, pixelsDrawn, true);
+            outputChanged = true;
+        }
+        else if (device.IsFrameDirty() && device.DirtyBegin() < pixelsDrawn)
+        {
+            device.MapToOutput(device.DirtyBegin(), std::min<size_t>(device.DirtyEnd(), pixelsDrawn), false);
+            outputChanged = true;
+        }
+
+        #if CHANNEL_POWER_LIMIT_MW
+            device.LimitChannelPower(pixelsDrawn);
+        #endif
+
+        sums += device._outputSums;
     }
-    FastLED.show(g_Values.Fader); //Shows the pixels
+
+    // If no channel changed and neither did the table, the strips already show this frame
+
+    if (!outputChanged)
+    {
+        FastLED.countFPS();
+        return;
+    }
+
+    for (int i = 0; i < NUM_CHANNELS; i++)
+        FastLED[i].setLeds(static_cast<LEDStripGFX&>(*effectManager.g(i))._outputLeds.get(), pixelsDrawn);
+
+    // The sums are of the output, so the estimate already includes gamma and brightness; what's left to scale
+    // by is only the power limit.
+
+    const auto powerDraw = kStripPowerModel.Estimate(sums, pixelsDrawn * NUM_CHANNELS);
+    const uint8_t powerScale = powerDraw.LimitedBrightness(255, g_ptrSystem->DeviceConfig().GetPowerLimit());
+
+    FastLED.show(powerScale); //Shows the pixels
+
+    // Point FastLED back at the effects' frames, as some effects draw through FastLED[] directly
+
+    for (int i = 0; i < NUM_CHANNELS; i++)
+        FastLED[i].setLeds(effectManager.g(i)->leds, pixelsDrawn);
 
     g_Values.FPS = FastLED.getFPS();
-    g_Values.Brite = 100.0 * calculate_max_brightness_for_power_mW(g_ptrSystem->DeviceConfig().GetBrightness(), POWER_LIMIT_MW) / 255;
-    g_Values.Watts = calculate_unscaled_power_mW(effectManager.g()->leds, pixelsDrawn) / 1000; // 1000 for mw->W
+    g_Values.Brite = 100.0 * scale8(targetBrightness, powerScale) / 255;
+    g_Values.PowerDraw = powerDraw.Scaled(powerScale);
+    g_Values.Watts = g_Values.PowerDraw.Total() / 1000; // 1000 for mw->W
 }
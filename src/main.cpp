@@ -164,6 +164,7 @@
 #include "soundanalyzer.h"
 #include "values.h"
 #include "improvserial.h"                       // ImprovSerial impl for setting WiFi credentials over the serial port
+#include "assetfiles.h"
 #include <TJpg_Decoder.h>
 
 #if defined(TOGGLE_BUTTON_1) || defined(TOGGLE_BUTTON_2)
@@ -176,7 +177,7 @@ void IRAM_ATTR ScreenUpdateLoopEntry(void *);
 // Global Variables
 //
 
-DRAM_ATTR std::unique_ptr<SystemContainer> g_ptrSystem;
+DRAM_ATTR psram_unique_ptr<SystemContainer> g_ptrSystem;
 DRAM_ATTR Values g_Values;
 DRAM_ATTR SoundAnalyzer g_Analyzer;
 DRAM_ATTR RemoteDebug Debug;                                                        // Instance of our telnet debug server
@@ -282,6 +283,8 @@ void setup()
     // Intialialize SPIFFS for file access to non-volatile storage
     if (!SPIFFS.begin(true))
         Serial.println("WARNING: SPIFFs could not be initialized!");
+    else
+        Assets::RemoveAbandonedUploads();
 
     // Enabling PSRAM allows us to use the extra 4MB of RAM on the ESP32-WROVER chip, but it caused
     // problems with the S3 rebooting when WiFi connected, so for now, I've limited the default
@@ -499,6 +502,7 @@ void setup()
     // Start things that do not depend on the network
 
     taskManager.StartDrawThread();
+    taskManager.StartEffectPrepareThread();
     taskManager.StartScreenThread();
     taskManager.StartAudioThread();
     taskManager.StartRemoteThread();
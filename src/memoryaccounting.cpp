@@ -0,0 +1,127 @@
+//+--------------------------------------------------------------------------
+//
+// File:        memoryaccounting.cpp
+//
+// NightDriverStrip - (c) 2018 Plummer's Software LLC.  All Rights Reserved.
+//
+// This file is part of the NightDriver software project.
+//
+//    NightDriver is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    NightDriver is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with Nightdriver.  It is normally found in copying.txt
+//    If not, see <https://www.gnu.org/licenses/>.
+//
+// Description:
+//
+//    Bookkeeping behind MemoryAccount and MemoryAccountScope
+//
+// History:     Oct-19-2026                     Created for NightDriverStrip
+//
+//---------------------------------------------------------------------------
+
+#include "globals.h"
+
+#if ENABLE_MEMORY_ACCOUNTING
+
+#include <mutex>
+
+// Bytes held per account now and at most. Slots are handed out when accounts are created, which is rare enough that
+// a mutex around that is fine; booking an allocation or a free only touches the slot itself.
+
+static std::atomic<size_t> l_currentBytes[MAX_MEMORY_ACCOUNTS];
+static std::atomic<size_t> l_peakBytes[MAX_MEMORY_ACCOUNTS];
+static std::atomic<uint16_t> l_generation[MAX_MEMORY_ACCOUNTS];
+static bool l_slotInUse[MAX_MEMORY_ACCOUNTS] = { true };
+static std::mutex l_slotMutex;
+
+// The account that allocations on the current task are booked to, 0 for none
+static thread_local uint16_t t_activeAccountId = 0;
+
+MemoryAccount::MemoryAccount()
+{
+    std::lock_guard<std::mutex> guard(l_slotMutex);
+
+    for (uint16_t id = 1; id < MAX_MEMORY_ACCOUNTS; id++)
+    {
+        if (!l_slotInUse[id])
+        {
+            l_slotInUse[id] = true;
+            l_generation[id]++;
+            l_currentBytes[id] = 0;
+            l_peakBytes[id] = 0;
+            _id = id;
+            return;
+        }
+    }
+
+    debugW("Out of memory accounts, allocations for this one won't be counted");
+}
+
+MemoryAccount::~MemoryAccount()
+{
+    if (_id == 0)
+        return;
+
+    std::lock_guard<std::mutex> guard(l_slotMutex);
+    l_slotInUse[_id] = false;
+}
+
+size_t MemoryAccount::CurrentBytes() const
+{
+    return _id ? l_currentBytes[_id].load() : 0;
+}
+
+size_t MemoryAccount::PeakBytes() const
+{
+    return _id ? l_peakBytes[_id].load() : 0;
+}
+
+uint16_t SetActiveMemoryAccount(uint16_t accountId)
+{
+    uint16_t previousAccountId = t_activeAccountId;
+    t_activeAccountId = accountId;
+    return previousAccountId;
+}
+
+void * TrackAllocation(void * block, size_t bytes)
+{
+    auto header = static_cast<MemoryBlockHeader *>(block);
+    uint16_t id = t_activeAccountId;
+
+    header->bytes = bytes;
+    header->accountId = id;
+    header->generation = l_generation[id].load(std::memory_order_relaxed);
+
+    if (id)
+    {
+        size_t current = l_currentBytes[id].fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        size_t peak = l_peakBytes[id].load(std::memory_order_relaxed);
+
+        while (current > peak && !l_peakBytes[id].compare_exchange_weak(peak, current, std::memory_order_relaxed))
+            ;
+    }
+
+    return header + 1;
+}
+
+void * TrackFree(void * memory)
+{
+    auto header = static_cast<MemoryBlockHeader *>(memory) - 1;
+    uint16_t id = header->accountId;
+
+    if (id && header->generation == l_generation[id].load(std::memory_order_relaxed))
+        l_currentBytes[id].fetch_sub(header->bytes, std::memory_order_relaxed);
+
+    return header;
+}
+
+#endif
@@ -33,6 +33,9 @@
 #include "systemcontainer.h"
 #include "soundanalyzer.h"
 #include "improvserial.h"
+#include "assetfiles.h"
+#include "gifindex.h"
+#include "gifframecache.h"
 
 // Static member initializers
 
@@ -47,6 +50,19 @@ const std::map<String, CWebServer::ValueValidator> CWebServer::settingValidators
 std::vector<SettingSpec, psram_allocator<SettingSpec>> CWebServer::mySettingSpecs = {};
 std::vector<std::reference_wrapper<SettingSpec>> CWebServer::deviceSettingSpecs{};
 
+// Uploaded assets that are waiting to be put in place, or assets waiting to be deleted. Indexing and moving files
+// around is too slow for the web server's task, so the JSON writer task does that for us.
+
+struct PendingAsset
+{
+    String name;
+    bool   remove;
+};
+
+static std::mutex l_pendingAssetsMutex;
+static std::vector<PendingAsset> l_pendingAssets;
+static size_t l_AssetWriterIndex = std::numeric_limits<size_t>::max();
+
 // Member function template specializations
 
 // Push param that represents a bool. Values considered true are text "true" and any whole number not equal to 0
@@ -170,6 +186,13 @@ void CWebServer::begin()
 
     _server.on("/reset",                 HTTP_POST, Reset);
 
+    if (l_AssetWriterIndex == std::numeric_limits<size_t>::max())
+        l_AssetWriterIndex = g_ptrSystem->JSONWriter().RegisterWriter(StorePendingAssets);
+
+    _server.on("/assets",                HTTP_GET,  GetAssetList);
+    _server.on("/assets",                HTTP_POST, FinishAssetUpload, UploadAsset);
+    _server.on("/deleteAsset",           HTTP_POST, DeleteAsset);
+
     // Embedded file requests
 
     ServeEmbeddedFile("/", html_file);
@@ -229,6 +252,8 @@ void CWebServer::GetEffectListText(AsyncWebServerRequest * pRequest)
         j["millisecondsRemaining"] = effectManager.GetTimeRemainingForCurrentEffect();
         j["eternalInterval"]       = effectManager.IsIntervalEternal();
         j["effectInterval"]        = effectManager.GetInterval();
+        j["largestFreeBlock"]      = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        j["largestFreePsramBlock"] = heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM);
 
         for (auto effect : effectManager.EffectsList())
         {
@@ -238,6 +263,16 @@ void CWebServer::GetEffectListText(AsyncWebServerRequest * pRequest)
             effectDoc["enabled"] = effect->IsEnabled();
             effectDoc["core"]    = effect->IsCoreEffect();
 
+            #if USE_HUB75
+                static const char * const doubleBufferPolicies[] = { "declaredOff", "declaredOn", "measuring", "measuredOn", "measuredOff" };
+                effectDoc["doubleBuffer"] = doubleBufferPolicies[to_value(effect->GetDoubleBufferPolicy())];
+            #endif
+
+            #if ENABLE_MEMORY_ACCOUNTING
+                effectDoc["memCurrent"] = effect->GetMemoryAccount().CurrentBytes();
+                effectDoc["memPeak"]    = effect->GetMemoryAccount().PeakBytes();
+            #endif
+
             if (!j["Effects"].add(effectDoc))
             {
                 bufferOverflow = true;
@@ -291,6 +326,14 @@ void CWebServer::GetStatistics(AsyncWebServerRequest * pRequest)
     j["CPU_USED_CORE0"]        = taskManager.GetCPUUsagePercent(0);
     j["CPU_USED_CORE1"]        = taskManager.GetCPUUsagePercent(1);
 
+    const auto& powerDraw = g_Values.PowerDraw;
+
+    j["POWER_MW"]              = powerDraw.Total();
+    j["POWER_MW_RED"]          = powerDraw.red_mW;
+    j["POWER_MW_GREEN"]        = powerDraw.green_mW;
+    j["POWER_MW_BLUE"]         = powerDraw.blue_mW;
+    j["POWER_MW_FIXED"]        = powerDraw.fixed_mW;
+
     AddCORSHeaderAndSendResponse(pRequest, response);
 }
 
@@ -727,4 +770,253 @@ void CWebServer::Reset(AsyncWebServerRequest * pRequest)
         debugW("Resetting device at API request!");
         throw new std::runtime_error("Resetting device at API request");
     }
+}
+
+// Turns an asset upload down. Chunks keep arriving after that, so we leave the message where UploadAsset() and
+//   FinishAssetUpload() will see it; the request frees it when it's done.
+void CWebServer::FailAssetUpload(AsyncWebServerRequest * pRequest, const String & fileName, const String & message)
+{
+    debugW("Asset upload of %s failed: %s", fileName.c_str(), message.c_str());
+
+    if (pRequest->_tempFile)
+    {
+        pRequest->_tempFile.close();
+        SPIFFS.remove(Assets::UploadPath(fileName));
+    }
+
+    if (!pRequest->_tempObject)
+        pRequest->_tempObject = strdup(message.c_str());
+}
+
+void CWebServer::GetAssetList(AsyncWebServerRequest * pRequest)
+{
+    static size_t jsonBufferSize = JSON_BUFFER_BASE_SIZE;
+    bool bufferOverflow;
+    debugV("GetAssetList");
+
+    do
+    {
+        bufferOverflow = false;
+        auto response = std::make_unique<AsyncJsonResponse>(false, jsonBufferSize);
+        auto& j = response->getRoot();
+
+        j["freeBytes"]     = SPIFFS.totalBytes() - SPIFFS.usedBytes();
+        j["maxNameLength"] = MAX_ASSET_NAME_LENGTH;
+        j["matrixWidth"]   = MATRIX_WIDTH;
+        j["matrixHeight"]  = MATRIX_HEIGHT;
+        j.createNestedArray("assets");
+
+        File directory = SPIFFS.open(ASSET_DIRECTORY);
+        for (File file = directory.openNextFile(); file && !bufferOverflow; file = directory.openNextFile())
+        {
+            String name = Assets::NameFromPath(file.name());
+            size_t size = file.size();
+            file.close();
+
+            if (!Assets::IsValidName(name))
+                continue;
+
+            StaticJsonDocument<256> assetDoc;
+
+            assetDoc["name"] = name;
+            assetDoc["size"] = size;
+
+            GIFIndex gifIndex;
+            if (Assets::IsGIF(name) && gifIndex.Load(Assets::IndexPath(name), size))
+            {
+                assetDoc["width"]  = gifIndex.Width();
+                assetDoc["height"] = gifIndex.Height();
+                assetDoc["frames"] = gifIndex.FrameCount();
+                assetDoc["fps"]    = gifIndex.FramesPerSecond();
+            }
+
+            if (!j["assets"].add(assetDoc))
+            {
+                bufferOverflow = true;
+                jsonBufferSize += JSON_BUFFER_INCREMENT;
+                debugV("JSON response buffer overflow! Increased buffer to %zu bytes", jsonBufferSize);
+            }
+        }
+        directory.close();
+
+        if (!bufferOverflow)
+            AddCORSHeaderAndSendResponse(pRequest, response.release());
+
+    } while (bufferOverflow);
+}
+
+// Hands an asset change to the JSON writer task, which calls StorePendingAssets() for it
+void CWebServer::QueueAssetChange(const String & name, bool remove)
+{
+    {
+        std::lock_guard<std::mutex> guard(l_pendingAssetsMutex);
+        l_pendingAssets.push_back({ name, remove });
+    }
+
+    g_ptrSystem->JSONWriter().FlagWriter(l_AssetWriterIndex);
+}
+
+// Puts uploaded assets in place and deletes the ones we were asked to. GIFs are indexed before they replace
+//   anything; one we can't read is dropped and the asset it was meant to replace stays. Files are only swapped
+//   while no effect is reading from them, and effects showing the old file notice it's changed through the cache.
+void CWebServer::StorePendingAssets()
+{
+    for (;;)
+    {
+        PendingAsset asset;
+        {
+            std::lock_guard<std::mutex> guard(l_pendingAssetsMutex);
+            if (l_pendingAssets.empty())
+                return;
+
+            asset = l_pendingAssets.front();
+            l_pendingAssets.erase(l_pendingAssets.begin());
+        }
+
+        const String & name = asset.name;
+        GIFIndex gifIndex;
+
+        if (!asset.remove && Assets::IsGIF(name))
+        {
+            BufferedFileReader reader;
+            bool indexed = reader.Open(Assets::UploadPath(name)) && gifIndex.Build(reader) && gifIndex.FitsMatrix();
+            reader.Close();
+
+            if (!indexed)
+            {
+                debugW("Uploaded GIF %s could not be read, discarding it", name.c_str());
+                SPIFFS.remove(Assets::UploadPath(name));
+                continue;
+            }
+
+            debugI("Indexed GIF %s: %dx%d, %zu frames", name.c_str(), gifIndex.Width(), gifIndex.Height(), gifIndex.FrameCount());
+        }
+
+        std::lock_guard<std::mutex> guard(Assets::FileMutex());
+
+        SPIFFS.remove(Assets::Path(name));
+        SPIFFS.remove(Assets::IndexPath(name));
+
+        if (!asset.remove)
+        {
+            if (!SPIFFS.rename(Assets::UploadPath(name), Assets::Path(name)))
+            {
+                debugE("Unable to store asset file %s", name.c_str());
+                SPIFFS.remove(Assets::UploadPath(name));
+            }
+            else if (Assets::IsGIF(name) && !gifIndex.Save(Assets::IndexPath(name)))
+            {
+                debugW("Unable to write index for GIF %s, it will be indexed when it's shown", name.c_str());
+            }
+        }
+
+        // Frames we decoded from the old file are no good anymore
+        GIFFrameCache::Instance().Forget(name);
+    }
+}
+
+// Receives an uploaded asset a chunk at a time. It's written under a temporary name and only takes the place of
+//   any asset by the same name once all of it has arrived, which StorePendingAssets() takes care of. GIFs must fit
+//   on the matrix, which we can tell from the first chunk. An upload that's cut short is removed right away.
+void CWebServer::UploadAsset(AsyncWebServerRequest * pRequest, const String & fileName, size_t index, uint8_t * data, size_t length, bool final)
+{
+    // Once we've turned the upload down, we ignore the rest of it
+    if (pRequest->_tempObject)
+        return;
+
+    if (index == 0)
+    {
+        debugI("Receiving asset %s", fileName.c_str());
+
+        if (!Assets::IsValidName(fileName))
+        {
+            FailAssetUpload(pRequest, fileName, str_sprintf("Asset names can be up to %d letters, digits, '.', '_' or '-'", (int) MAX_ASSET_NAME_LENGTH));
+            return;
+        }
+
+        if (pRequest->contentLength() > SPIFFS.totalBytes() - SPIFFS.usedBytes())
+        {
+            FailAssetUpload(pRequest, fileName, "Not enough free space for asset");
+            return;
+        }
+
+        if (Assets::IsGIF(fileName))
+        {
+            uint16_t width, height;
+            if (!GIFIndex::ReadScreenSize(data, length, width, height))
+            {
+                FailAssetUpload(pRequest, fileName, "Asset is not a GIF");
+                return;
+            }
+
+            if (width > MATRIX_WIDTH || height > MATRIX_HEIGHT)
+            {
+                FailAssetUpload(pRequest, fileName, str_sprintf("GIF is %dx%d, which is larger than the %dx%d matrix", width, height, MATRIX_WIDTH, MATRIX_HEIGHT));
+                return;
+            }
+        }
+
+        pRequest->_tempFile = SPIFFS.open(Assets::UploadPath(fileName), FILE_WRITE);
+        if (!pRequest->_tempFile)
+        {
+            FailAssetUpload(pRequest, fileName, "Unable to create asset file");
+            return;
+        }
+
+        // The file is still open if the client goes away before sending all of it
+        pRequest->onDisconnect([pRequest, fileName]()
+        {
+            if (pRequest->_tempFile)
+            {
+                debugW("Asset upload of %s was cut short", fileName.c_str());
+                pRequest->_tempFile.close();
+                SPIFFS.remove(Assets::UploadPath(fileName));
+            }
+        });
+    }
+
+    if (length > 0 && pRequest->_tempFile.write(data, length) != length)
+    {
+        FailAssetUpload(pRequest, fileName, "Unable to write asset file");
+        return;
+    }
+
+    if (!final)
+        return;
+
+    pRequest->_tempFile.close();
+    QueueAssetChange(fileName, false);
+}
+
+void CWebServer::FinishAssetUpload(AsyncWebServerRequest * pRequest)
+{
+    if (pRequest->_tempObject)
+    {
+        AddCORSHeaderAndSendBadRequest(pRequest, static_cast<const char *>(pRequest->_tempObject));
+        return;
+    }
+
+    AddCORSHeaderAndSendOKResponse(pRequest);
+}
+
+void CWebServer::DeleteAsset(AsyncWebServerRequest * pRequest)
+{
+    debugV("DeleteAsset");
+
+    if (!pRequest->hasParam("name", true, false))
+    {
+        AddCORSHeaderAndSendOKResponse(pRequest);
+        return;
+    }
+
+    String name = pRequest->getParam("name", true, false)->value();
+    if (!Assets::IsValidName(name) || !SPIFFS.exists(Assets::Path(name)))
+    {
+        AddCORSHeaderAndSendBadRequest(pRequest, "No such asset");
+        return;
+    }
+
+    QueueAssetChange(name, true);
+
+    AddCORSHeaderAndSendOKResponse(pRequest);
 }
\ No newline at end of file
@@ -0,0 +1,78 @@
+//+--------------------------------------------------------------------------
+//
+// File:        pixeltypes.h
+//
+// NightDriverStrip - (c) 2018 Plummer's Software LLC.  All Rights Reserved.
+//
+// This file is part of the NightDriver software project.
+//
+//    NightDriver is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    NightDriver is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with Nightdriver.  It is normally found in copying.txt
+//    If not, see <https://www.gnu.org/licenses/>.
+//
+//
+// Description:
+//
+//    Stands in for FastLED's pixeltypes.h when the frame kernels are built
+//    on the host. CRGB's scaling and adding are FastLED's own definitions
+//    (with FASTLED_SCALE8_FIXED, its default), written out per channel, so
+//    they serve as the scalar reference the kernels are tested against.
+//
+//
+// History:     Oct-19-2026                     Created for NightDriverStrip
+//
+//---------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstdint>
+
+struct CRGB
+{
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+
+    CRGB & nscale8(uint8_t scale)
+    {
+        const unsigned factor = scale + 1;
+        r = (r * factor) >> 8;
+        g = (g * factor) >> 8;
+        b = (b * factor) >> 8;
+        return *this;
+    }
+
+    CRGB & nscale8_video(uint8_t scale)
+    {
+        const uint8_t nonZeroScale = scale != 0 ? 1 : 0;
+        r = r == 0 ? 0 : ((r * scale) >> 8) + nonZeroScale;
+        g = g == 0 ? 0 : ((g * scale) >> 8) + nonZeroScale;
+        b = b == 0 ? 0 : ((b * scale) >> 8) + nonZeroScale;
+        return *this;
+    }
+
+    CRGB & operator+=(const CRGB & other)
+    {
+        r = r + other.r > 255 ? 255 : r + other.r;
+        g = g + other.g > 255 ? 255 : g + other.g;
+        b = b + other.b > 255 ? 255 : b + other.b;
+        return *this;
+    }
+
+    bool operator==(const CRGB & other) const
+    {
+        return r == other.r && g == other.g && b == other.b;
+    }
+};
+
+static_assert(sizeof(CRGB) == 3, "The kernels treat a run of pixels as a run of bytes");
@@ -0,0 +1,203 @@
+//+--------------------------------------------------------------------------
+//
+// File:        test_framekernels.cpp
+//
+// NightDriverStrip - (c) 2018 Plummer's Software LLC.  All Rights Reserved.
+//
+// This file is part of the NightDriver software project.
+//
+//    NightDriver is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    NightDriver is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with Nightdriver.  It is normally found in copying.txt
+//    If not, see <https://www.gnu.org/licenses/>.
+//
+//
+// Description:
+//
+//    Host test for framekernels.h. Every kernel is run over buffers of
+//    every length up to a few words, at every byte alignment and with every
+//    scale, and has to match the per-pixel CRGB reference bit for bit. The
+//    word helpers are also checked against the byte ones for every pair of
+//    byte values. Then both are timed over a full 128x64 frame.
+//
+//    Build and run with:  make -C test/framekernels run
+//
+//
+// History:     Oct-19-2026                     Created for NightDriverStrip
+//
+//---------------------------------------------------------------------------
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+#include "framekernels.h"
+
+static int l_failures = 0;
+
+static void Check(bool passed, const char * what, size_t count, size_t offset, int scale)
+{
+    if (passed)
+        return;
+
+    if (l_failures++ < 10)
+        printf("FAIL: %s, %zu pixels at offset %zu, scale %d\n", what, count, offset, scale);
+}
+
+static void Randomize(uint8_t * bytes, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+        bytes[i] = rand() & 0xFF;
+}
+
+// Random pixels at the given byte offset into a buffer, so we get every alignment
+struct PixelRun
+{
+    std::vector<uint8_t> storage;
+    CRGB * pixels;
+
+    PixelRun(size_t count, size_t offset) : storage(count * sizeof(CRGB) + offset + 4)
+    {
+        Randomize(storage.data(), storage.size());
+        pixels = reinterpret_cast<CRGB *>(storage.data() + offset);
+    }
+};
+
+static bool Same(const CRGB * a, const CRGB * b, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+        if (!(a[i] == b[i]))
+            return false;
+    return true;
+}
+
+static void TestWordHelpers()
+{
+    for (unsigned a = 0; a < 256; a++)
+    {
+        for (unsigned b = 0; b < 256; b++)
+        {
+            const uint32_t wordA = a | (b << 8) | (a << 16) | (b << 24);
+            const uint32_t wordB = b | (a << 8) | (255 - b) << 16 | (255 - a) << 24;
+
+            uint32_t expected = 0;
+            for (int shift = 0; shift < 32; shift += 8)
+                expected |= AddByteSaturated(wordA >> shift, wordB >> shift) << shift;
+            Check(AddWordSaturated(wordA, wordB) == expected, "AddWordSaturated", 1, 0, -1);
+
+            expected = 0;
+            uint32_t expectedVideo = 0;
+            for (int shift = 0; shift < 32; shift += 8)
+            {
+                expected      |= ScaleByte(wordA >> shift, b) << shift;
+                expectedVideo |= ScaleByteVideo(wordA >> shift, b) << shift;
+            }
+            Check(ScaleWord(wordA, b) == expected, "ScaleWord", 1, 0, b);
+            Check(ScaleWordVideo(wordA, b) == expectedVideo, "ScaleWordVideo", 1, 0, b);
+        }
+    }
+}
+
+static void TestKernels()
+{
+    for (size_t count = 0; count <= 24; count++)
+    {
+        for (size_t offset = 0; offset < 4; offset++)
+        {
+            for (int scale = 0; scale < 256; scale++)
+            {
+                PixelRun run(count, offset), source(count, (offset + scale) & 3);
+                std::vector<CRGB> expected(run.pixels, run.pixels + count);
+
+                for (auto & pixel : expected)
+                    pixel.nscale8(scale);
+                ScalePixels(run.pixels, count, scale);
+                Check(Same(run.pixels, expected.data(), count), "ScalePixels", count, offset, scale);
+
+                for (auto & pixel : expected)
+                    pixel.nscale8_video(scale);
+                ScalePixelsVideo(run.pixels, count, scale);
+                Check(Same(run.pixels, expected.data(), count), "ScalePixelsVideo", count, offset, scale);
+
+                for (size_t i = 0; i < count; i++)
+                    expected[i] += source.pixels[i];
+                AddPixels(run.pixels, source.pixels, count);
+                Check(Same(run.pixels, expected.data(), count), "AddPixels", count, offset, scale);
+
+                for (size_t i = 0; i < count; i++)
+                    (expected[i] += source.pixels[i]).nscale8(scale);
+                AddAndScalePixels(run.pixels, source.pixels, count, scale);
+                Check(Same(run.pixels, expected.data(), count), "AddAndScalePixels", count, offset, scale);
+            }
+        }
+    }
+}
+
+// Nanoseconds per pixel for running op over a 128x64 frame, best of a few rounds
+static double Time(const std::function<void(CRGB *, const CRGB *, size_t)> & op)
+{
+    constexpr size_t kPixels = 128 * 64;
+    constexpr int kFrames = 200;
+
+    PixelRun frame(kPixels, 0), source(kPixels, 0);
+    double best = 1e9;
+
+    for (int round = 0; round < 5; round++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < kFrames; i++)
+            op(frame.pixels, source.pixels, kPixels);
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count() / (kFrames * kPixels));
+    }
+    return best;
+}
+
+static void Benchmark()
+{
+    printf("ns/pixel over a 128x64 frame      per pixel   kernel\n");
+
+    printf("nscale8           / ScalePixels       %6.2f   %6.2f\n",
+           Time([](CRGB * p, const CRGB *, size_t n) { for (size_t i = 0; i < n; i++) p[i].nscale8(200); }),
+           Time([](CRGB * p, const CRGB *, size_t n) { ScalePixels(p, n, 200); }));
+
+    printf("nscale8_video     / ScalePixelsVideo  %6.2f   %6.2f\n",
+           Time([](CRGB * p, const CRGB *, size_t n) { for (size_t i = 0; i < n; i++) p[i].nscale8_video(200); }),
+           Time([](CRGB * p, const CRGB *, size_t n) { ScalePixelsVideo(p, n, 200); }));
+
+    printf("+=                / AddPixels         %6.2f   %6.2f\n",
+           Time([](CRGB * p, const CRGB * s, size_t n) { for (size_t i = 0; i < n; i++) p[i] += s[i]; }),
+           Time([](CRGB * p, const CRGB * s, size_t n) { AddPixels(p, s, n); }));
+
+    printf("+= and nscale8    / AddAndScalePixels %6.2f   %6.2f\n",
+           Time([](CRGB * p, const CRGB * s, size_t n) { for (size_t i = 0; i < n; i++) (p[i] += s[i]).nscale8(200); }),
+           Time([](CRGB * p, const CRGB * s, size_t n) { AddAndScalePixels(p, s, n, 200); }));
+}
+
+int main()
+{
+    srand(1);
+
+    TestWordHelpers();
+    TestKernels();
+
+    if (l_failures)
+    {
+        printf("%d checks failed\n", l_failures);
+        return 1;
+    }
+
+    printf("All frame kernels match the per-pixel reference\n");
+    Benchmark();
+    return 0;
+}
@@ -0,0 +1,69 @@
+//+--------------------------------------------------------------------------
+//
+// File:        FastLED.h
+//
+// NightDriverStrip - (c) 2018 Plummer's Software LLC.  All Rights Reserved.
+//
+// This file is part of the NightDriver software project.
+//
+//    NightDriver is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    NightDriver is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with Nightdriver.  It is normally found in copying.txt
+//    If not, see <https://www.gnu.org/licenses/>.
+//
+//
+// Description:
+//
+//    Stands in for FastLED.h when NoiseField is built on the host. Only
+//    the lib8tion helpers the noise code uses are here, written as FastLED
+//    defines them (with FASTLED_SCALE8_FIXED, its default).
+//
+//
+// History:     Oct-19-2026                     Created for NightDriverStrip
+//
+//---------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstdint>
+
+#define FASTLED_NOISE_FIXED 1
+
+inline uint16_t scale16(uint16_t i, uint16_t scale)
+{
+    return ((uint32_t)i * (1 + (uint32_t)scale)) >> 16;
+}
+
+inline int16_t avg15(int16_t i, int16_t j)
+{
+    return (i >> 1) + (j >> 1) + (i & j & 1);
+}
+
+inline int16_t lerp15by16(int16_t a, int16_t b, uint16_t frac)
+{
+    if (b > a)
+        return a + scale16(b - a, frac);
+    else
+        return a - scale16(a - b, frac);
+}
+
+inline uint16_t ease16InOutQuad(uint16_t i)
+{
+    uint16_t j = i;
+    if (j & 0x8000)
+        j = 65535 - j;
+    uint16_t jj = scale16(j, j);
+    uint16_t jj2 = jj << 1;
+    if (i & 0x8000)
+        jj2 = 65535 - jj2;
+    return jj2;
+}
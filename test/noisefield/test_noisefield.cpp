@@ -0,0 +1,268 @@
+//+--------------------------------------------------------------------------
+//
+// File:        test_noisefield.cpp
+//
+// NightDriverStrip - (c) 2018 Plummer's Software LLC.  All Rights Reserved.
+//
+// This file is part of the NightDriver software project.
+//
+//    NightDriver is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    NightDriver is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with Nightdriver.  It is normally found in copying.txt
+//    If not, see <https://www.gnu.org/licenses/>.
+//
+//
+// Description:
+//
+//    Host test for noisefield.h. FillRow is checked against a straight
+//    port of FastLED's inoise16() for random starting points and steps,
+//    and Fill against the same reference for a few grid sizes, at full
+//    resolution and, for the points it actually evaluates, at half. Then
+//    all three are timed over a full 128x64 frame.
+//
+//    Build and run with:  make -C test/noisefield run
+//
+//
+// History:     Oct-19-2026                     Created for NightDriverStrip
+//
+//---------------------------------------------------------------------------
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include "noisefield.h"
+
+static int l_failures = 0;
+
+static void Check(bool passed, const char * what, uint32_t x, uint32_t y, uint32_t z)
+{
+    if (passed)
+        return;
+
+    if (l_failures++ < 10)
+        printf("FAIL: %s at (%08x, %08x, %08x)\n", what, x, y, z);
+}
+
+// The reference: FastLED's inoise16(), with its own copy of the permutation
+
+static const uint8_t l_permutation[256] =
+{
+    151,160,137, 91, 90, 15,131, 13,201, 95, 96, 53,194,233,  7,225,
+    140, 36,103, 30, 69,142,  8, 99, 37,240, 21, 10, 23,190,  6,148,
+    247,120,234, 75,  0, 26,197, 62, 94,252,219,203,117, 35, 11, 32,
+     57,177, 33, 88,237,149, 56, 87,174, 20,125,136,171,168, 68,175,
+     74,165, 71,134,139, 48, 27,166, 77,146,158,231, 83,111,229,122,
+     60,211,133,230,220,105, 92, 41, 55, 46,245, 40,244,102,143, 54,
+     65, 25, 63,161,  1,216, 80, 73,209, 76,132,187,208, 89, 18,169,
+    200,196,135,130,116,188,159, 86,164,100,109,198,173,186,  3, 64,
+     52,217,226,250,124,123,  5,202, 38,147,118,126,255, 82, 85,212,
+    207,206, 59,227, 47, 16, 58, 17,182,189, 28, 42,223,183,170,213,
+    119,248,152,  2, 44,154,163, 70,221,153,101,155,167, 43,172,  9,
+    129, 22, 39,253, 19, 98,108,110, 79,113,224,232,178,185,112,104,
+    218,246, 97,228,251, 34,242,193,238,210,144, 12,191,179,162,241,
+     81, 51,145,235,249, 14,239,107, 49,192,214, 31,181,199,106,157,
+    184, 84,204,176,115,121, 50, 45,127,  4,150,254,138,236,205, 93,
+    222,114, 67, 29, 24, 72,243,141,128,195, 78, 66,215, 61,156,180
+};
+
+#define P(x) l_permutation[(x) & 0xFF]
+
+static int16_t grad16(uint8_t hash, int16_t x, int16_t y, int16_t z)
+{
+    hash = hash & 15;
+    int16_t u = hash < 8 ? x : y;
+    int16_t v = hash < 4 ? y : hash == 12 || hash == 14 ? x : z;
+    if (hash & 1) u = -u;
+    if (hash & 2) v = -v;
+    return avg15(u, v);
+}
+
+static int16_t inoise16_raw(uint32_t x, uint32_t y, uint32_t z)
+{
+    uint8_t X = (x >> 16) & 0xFF;
+    uint8_t Y = (y >> 16) & 0xFF;
+    uint8_t Z = (z >> 16) & 0xFF;
+
+    uint8_t A  = P(X) + Y;
+    uint8_t AA = P(A) + Z;
+    uint8_t AB = P(A + 1) + Z;
+    uint8_t B  = P(X + 1) + Y;
+    uint8_t BA = P(B) + Z;
+    uint8_t BB = P(B + 1) + Z;
+
+    uint16_t u = x & 0xFFFF;
+    uint16_t v = y & 0xFFFF;
+    uint16_t w = z & 0xFFFF;
+
+    int16_t xx = (u >> 1) & 0x7FFF;
+    int16_t yy = (v >> 1) & 0x7FFF;
+    int16_t zz = (w >> 1) & 0x7FFF;
+    uint16_t N = 0x8000L;
+
+    u = ease16InOutQuad(u);
+    v = ease16InOutQuad(v);
+    w = ease16InOutQuad(w);
+
+    int16_t X1 = lerp15by16(grad16(P(AA), xx, yy, zz), grad16(P(BA), xx - N, yy, zz), u);
+    int16_t X2 = lerp15by16(grad16(P(AB), xx, yy - N, zz), grad16(P(BB), xx - N, yy - N, zz), u);
+    int16_t X3 = lerp15by16(grad16(P(AA + 1), xx, yy, zz - N), grad16(P(BA + 1), xx - N, yy, zz - N), u);
+    int16_t X4 = lerp15by16(grad16(P(AB + 1), xx, yy - N, zz - N), grad16(P(BB + 1), xx - N, yy - N, zz - N), u);
+
+    int16_t Y1 = lerp15by16(X1, X2, v);
+    int16_t Y2 = lerp15by16(X3, X4, v);
+
+    return lerp15by16(Y1, Y2, w);
+}
+
+static uint16_t inoise16(uint32_t x, uint32_t y, uint32_t z)
+{
+    int32_t ans = inoise16_raw(x, y, z);
+    ans = ans + 19052L;
+    uint32_t pan = ans;
+    pan *= 440L;
+    return pan >> 8;
+}
+
+static uint8_t Reference(uint32_t x, uint32_t y, uint32_t z)
+{
+    return inoise16(x, y, z) >> 8;
+}
+
+static uint32_t RandomWord()
+{
+    return (uint32_t)rand() << 16 ^ (uint32_t)rand();
+}
+
+static void TestFillRow()
+{
+    uint8_t row[256];
+
+    for (int round = 0; round < 20000; round++)
+    {
+        const uint32_t x = RandomWord(), y = RandomWord(), z = RandomWord();
+
+        // Mostly steps smaller than a lattice cell, as the effects use, but some that skip cells or go backwards
+        uint32_t stepX = rand() % 8192;
+        if (round % 4 == 0)
+            stepX = RandomWord();
+        else if (round % 4 == 1)
+            stepX = -stepX;
+
+        const size_t count = 1 + rand() % 256;
+        NoiseField::FillRow(row, count, x, stepX, y, z);
+
+        for (size_t i = 0; i < count; i++)
+            Check(row[i] == Reference(x + i * stepX, y, z), "FillRow", x + i * stepX, y, z);
+    }
+}
+
+static void TestFill()
+{
+    for (size_t width : { 1, 63, 64 })
+    {
+        for (size_t height : { 1, 31, 32 })
+        {
+            const uint32_t x = RandomWord(), y = RandomWord(), z = RandomWord();
+            const uint32_t stepX = rand() % 8192, stepY = rand() % 8192;
+            NoiseField field(width);
+            size_t rows = 0;
+
+            field.Fill(height, x, stepX, y, stepY, z, false, [&](size_t row, const uint8_t * pixels)
+            {
+                rows++;
+                for (size_t i = 0; i < width; i++)
+                    Check(pixels[i] == Reference(x + i * stepX, y + row * stepY, z), "Fill", x + i * stepX, y + row * stepY, z);
+            });
+            Check(rows == height, "Fill row count", x, y, z);
+
+            // At half resolution only the even rows and columns are evaluated; the rest are interpolated
+            rows = 0;
+            field.Fill(height, x, stepX, y, stepY, z, true, [&](size_t row, const uint8_t * pixels)
+            {
+                rows++;
+                for (size_t i = 0; i < width && row % 2 == 0; i += 2)
+                    Check(pixels[i] == Reference(x + i * stepX, y + row * stepY, z), "Fill at half resolution", x + i * stepX, y + row * stepY, z);
+            });
+            Check(rows == height, "Fill at half resolution row count", x, y, z);
+        }
+    }
+}
+
+// Nanoseconds per pixel for filling a 128x64 frame with fill, best of a few rounds
+static double Time(const std::function<void(uint8_t *, uint32_t)> & fill)
+{
+    constexpr size_t kPixels = 128 * 64;
+    constexpr int kFrames = 100;
+
+    static uint8_t frame[kPixels];
+    double best = 1e9;
+
+    for (int round = 0; round < 5; round++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < kFrames; i++)
+            fill(frame, i * 1000);
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count() / (kFrames * kPixels));
+    }
+    return best;
+}
+
+static void Benchmark()
+{
+    constexpr uint32_t kStep = 3000;
+    NoiseField field(128);
+
+    printf("ns/pixel over a 128x64 frame\n");
+
+    printf("inoise16 per pixel        %6.2f\n", Time([](uint8_t * frame, uint32_t z)
+    {
+        for (uint32_t y = 0; y < 64; y++)
+            for (uint32_t x = 0; x < 128; x++)
+                frame[y * 128 + x] = inoise16(x * kStep, y * kStep, z) >> 8;
+    }));
+
+    printf("NoiseField full           %6.2f\n", Time([&](uint8_t * frame, uint32_t z)
+    {
+        field.Fill(64, 0, kStep, 0, kStep, z, false, [&](size_t row, const uint8_t * pixels)
+        {
+            std::copy(pixels, pixels + 128, frame + row * 128);
+        });
+    }));
+
+    printf("NoiseField half           %6.2f\n", Time([&](uint8_t * frame, uint32_t z)
+    {
+        field.Fill(64, 0, kStep, 0, kStep, z, true, [&](size_t row, const uint8_t * pixels)
+        {
+            std::copy(pixels, pixels + 128, frame + row * 128);
+        });
+    }));
+}
+
+int main()
+{
+    srand(1);
+
+    TestFillRow();
+    TestFill();
+
+    if (l_failures)
+    {
+        printf("%d checks failed\n", l_failures);
+        return 1;
+    }
+
+    printf("NoiseField matches inoise16()\n");
+    Benchmark();
+    return 0;
+}